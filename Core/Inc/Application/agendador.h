@@ -0,0 +1,126 @@
+// Core/Inc/Application/agendador.h
+
+#ifndef AGENDADOR_H
+#define AGENDADOR_H
+
+#include "main.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define AGENDADOR_MAX_TAREFAS   16
+#define AGENDADOR_MAX_TICKS     4      // Ganchos de 1 ms (Agendador_Registrar_Tick)
+#define AGENDADOR_ID_INVALIDO   0xFF
+
+// Sono sem tick: o TIM14  esticado at o prximo prazo (ARR de 16 bits, 1 us)
+#define AGENDADOR_SONO_MIN_MS   2      // Abaixo disso basta o tick de 1 ms
+#define AGENDADOR_SONO_MAX_MS   50
+
+typedef enum {
+    AGENDADOR_PRIO_ALTA,     // Aquisio e atuadores
+    AGENDADOR_PRIO_MEDIA,    // Comunicao (CLI, DWIN)
+    AGENDADOR_PRIO_BAIXA     // Display, relgio, EEPROM
+} Agendador_Prioridade_t;
+
+typedef void (*Agendador_Funcao_t)(void);
+typedef bool (*Agendador_Pronto_t)(void);
+
+typedef struct {
+    const char* nome;
+    Agendador_Prioridade_t prioridade;
+    uint32_t periodo_ms;        // 0: tarefa por evento
+    uint32_t prazo_us;          // Liberao -> fim
+    uint32_t execucoes;
+    uint32_t perdas_prazo;
+    uint32_t ultimo_us;         // Durao da ltima execuo
+    uint32_t pior_us;           // Maior durao
+    uint32_t medio_us;
+    uint32_t latencia_max_us;   // Maior atraso entre a liberao e o incio
+} Agendador_Stats_Tarefa_t;
+
+typedef struct {
+    uint32_t janela_ms;         // Tempo desde o ltimo Agendador_Zerar_Stats()
+    uint32_t ocioso_ms;         // Dormindo no __WFI()
+    uint32_t passagens;         // Chamadas de Agendador_Executar()
+    uint32_t dormidas;
+    uint32_t sonos_sem_tick;    // Dormidas com o TIM14 esticado at o prximo prazo
+    uint32_t maior_sono_ms;     // Maior perodo sem tick programado
+    uint32_t despertares_prazo; // Sono sem tick encerrado pelo TIM14 (no prazo)
+    uint32_t despertares_irq;   // Sono sem tick encerrado antes por outra interrupo
+    uint32_t latencia_despertar_max_us;   // Update do TIM14 -> CPU de volta ao lao
+    uint32_t latencia_despertar_media_us;
+} Agendador_Stats_t;
+
+/**
+ * @brief Zera a tabela de tarefas e as estatsticas.
+ */
+void Agendador_Init(void);
+
+/**
+ * @brief Registra uma tarefa peridica.
+ * A liberao seguinte  a anterior + periodo (sem deriva). Prazo implcito:
+ * terminar antes da prxima liberao.
+ * @return Id da tarefa ou AGENDADOR_ID_INVALIDO (tabela cheia).
+ */
+uint8_t Agendador_Registrar_Periodica(const char* nome, Agendador_Funcao_t funcao,
+                                      uint32_t periodo_ms, Agendador_Prioridade_t prioridade);
+
+/**
+ * @brief Registra uma tarefa peridica que s roda enquanto 'ativa' (consulta
+ * barata, sem efeitos) retorna true. Dormente, no conta como prazo para o
+ * sono sem tick; ao ativar,  liberada na mesma passagem e retoma o perodo.
+ */
+uint8_t Agendador_Registrar_Periodica_Condicional(const char* nome, Agendador_Funcao_t funcao,
+                                                  Agendador_Pronto_t ativa, uint32_t periodo_ms,
+                                                  Agendador_Prioridade_t prioridade);
+
+/**
+ * @brief Registra uma tarefa disparada por evento.
+ * Roda quando 'pronto' (consulta barata, sem efeitos) retorna true ou depois
+ * de um Agendador_Sinalizar(). 'pronto' pode ser NULL.
+ * @param prazo_ms Tempo mximo entre a deteco do evento e o fim da tarefa.
+ */
+uint8_t Agendador_Registrar_Evento(const char* nome, Agendador_Funcao_t funcao, Agendador_Pronto_t pronto,
+                                   uint32_t prazo_ms, Agendador_Prioridade_t prioridade);
+
+/**
+ * @brief Marca uma tarefa por evento como pronta. Pode ser chamada em ISR.
+ */
+void Agendador_Sinalizar(uint8_t id);
+
+/**
+ * @brief Registra uma funo chamada a cada ms (contexto de ISR, ou do lao
+ * com as IRQs mascaradas ao acordar de um sono sem tick). Curta e sem espera.
+ */
+bool Agendador_Registrar_Tick(Agendador_Funcao_t funcao);
+
+/**
+ * @brief (Superloop) Roda uma vez cada tarefa vencida, da maior para a menor
+ * prioridade. Sem nenhuma vencida, dorme no __WFI() at a prxima interrupo
+ * ou o prximo prazo. Na primeira chamada o TIM14 vira a base do HAL_GetTick()
+ * e o SysTick deixa de interromper.
+ */
+void Agendador_Executar(void);
+
+/**
+ * @brief Contador de 1 MHz: incio do perodo do TIM14 + CNT. D a volta em
+ * ~71 min; usar s diferenas.
+ */
+uint32_t Agendador_Micros(void);
+
+/**
+ * @brief Chamar no update do TIM14: avana a base de tempo, o uwTick e os
+ * ganchos de 1 ms (vrios de uma vez depois de um sono sem tick).
+ */
+void Agendador_TIM14_Update(void);
+
+uint8_t Agendador_Get_Num_Tarefas(void);
+
+/**
+ * @brief Estatsticas da tarefa na posio 'indice' da ordem de execuo
+ * (0 = primeira da maior prioridade).
+ */
+bool Agendador_Get_Stats_Tarefa(uint8_t indice, Agendador_Stats_Tarefa_t* stats);
+void Agendador_Get_Stats(Agendador_Stats_t* stats);
+void Agendador_Zerar_Stats(void);
+
+#endif // AGENDADOR_H
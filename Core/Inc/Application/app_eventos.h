@@ -1,6 +1,7 @@
 #ifndef APP_EVENTOS_H
 #define APP_EVENTOS_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 // Enumeração de todos os tipos de eventos possíveis no sistema
@@ -18,6 +19,7 @@ typedef enum {
     EV_SERVOS_SEQUENCE_STEP_CHANGED,
     EV_SERVOS_SEQUENCE_FINISHED,
     EV_SYSTEM_TICK_1S,
+    EV_NUM_TIPOS            // Sentinela (não é evento)
 } Tipo_Evento_t;
 
 // --- Estruturas de Dados (Payloads) para os Eventos ---
@@ -32,6 +34,14 @@ typedef enum {
     SERVO_STEP_FINISHED 
 } ServoStep_t;
 
+// Payload de EV_SERVOS_SEQUENCE_STEP_CHANGED / EV_SERVOS_SEQUENCE_FINISHED
+typedef struct {
+    uint8_t indice;             // Passo que começou (no fim: passos executados)
+    uint8_t total;              // Passos da sequência carregada
+    ServoStep_t passo;          // Servo do passo (SERVO_STEP_FINISHED no fim)
+    uint8_t limites_esgotados;  // Esperas por condição encerradas pelo limite de tempo
+} ServoSeqPayload_t;
+
 // Estrutura principal de um evento
 typedef struct {
     Tipo_Evento_t type;
@@ -41,4 +51,82 @@ typedef struct {
 // Definição do tipo de função para os "handlers" de eventos
 typedef void (*Funcao_Handler_Evento_t)(Evento_t event);
 
+//================================================================================
+// Barramento de Eventos (app_eventos.c)
+//================================================================================
+
+#define EVENTOS_TAM_FILA_ISR        8    // Potência de 2
+#define EVENTOS_TAM_FILA            16   // Potência de 2
+#define EVENTOS_PAYLOAD_MAX         12   // Maior payload (ServoSeqPayload_t)
+#define EVENTOS_MAX_ASSINANTES      16
+#define EVENTOS_MAX_POR_DESPACHO    8    // Limita a duração de uma passagem
+#define EVENTOS_PRIORIDADE_ISR      3    // Única prioridade NVIC que publica (a das IRQs da aplicação)
+
+typedef struct {
+    uint8_t  profundidade;      // Eventos na fila agora
+    uint8_t  profundidade_max;  // Maior ocupação desde o último Eventos_Zerar_Stats()
+    uint8_t  capacidade;
+    uint32_t publicados;
+    uint32_t descartados;       // Fila cheia
+} Eventos_Stats_Fila_t;
+
+typedef struct {
+    Eventos_Stats_Fila_t isr;        // Publicados em interrupção
+    Eventos_Stats_Fila_t principal;  // Publicados no superloop
+    uint32_t despachados;
+    uint32_t sem_assinante;
+    uint32_t fora_de_prioridade;     // Recusados: ISR fora de EVENTOS_PRIORIDADE_ISR
+    uint32_t latencia_ultima_us;     // Publicação -> início do despacho
+    uint32_t latencia_max_us;
+    uint32_t latencia_media_us;
+} Eventos_Stats_t;
+
+/**
+ * @brief Esvazia as filas e a tabela de assinantes.
+ */
+void Eventos_Init(void);
+
+/**
+ * @brief Registra 'handler' para os eventos do 'tipo'. Os handlers rodam no
+ * superloop (Eventos_Despachar), na ordem de registro.
+ * @return false se a tabela estiver cheia.
+ */
+bool Eventos_Assinar(Tipo_Evento_t tipo, Funcao_Handler_Evento_t handler);
+
+/**
+ * @brief Copia o payload (tamanho fixo por tipo) para a fila e retorna.
+ * Pode ser chamada em ISR: cada contexto tem sua fila sem trava (um produtor
+ * e um consumidor). Na fila de ISR o produtor único vem da regra: só publicam
+ * ISRs de prioridade EVENTOS_PRIORIDADE_ISR, que não se interrompem entre si.
+ * O SysTick (TICK_INT_PRIORITY = 0) preempta essas ISRs e não pode publicar;
+ * uma publicação de outra prioridade é recusada e contada.
+ * @return false se a fila estiver cheia ou a ISR estiver fora da prioridade.
+ */
+bool Eventos_Publicar(Tipo_Evento_t tipo, const void* payload);
+
+/**
+ * @brief Mesma coisa, na assinatura de Funcao_Handler_Evento_t (encaminha
+ * os eventos de módulos que aceitam um handler único, como o servo_controle).
+ */
+void Eventos_Publicar_Evento(Evento_t evento);
+
+/**
+ * @brief (Superloop) Entrega até EVENTOS_MAX_POR_DESPACHO eventos aos
+ * assinantes; a fila de ISR primeiro. O payload só vale durante o handler.
+ */
+void Eventos_Despachar(void);
+
+/**
+ * @brief true se há evento esperando (consulta da tarefa do agendador).
+ */
+bool Eventos_Pendente(void);
+
+/**
+ * @brief Gera EV_SYSTEM_TICK_1S. Chamar no update do TIM14 (1 ms).
+ */
+void Eventos_Tick_1ms(void);
+
+void Eventos_Get_Stats(Eventos_Stats_t* stats);
+void Eventos_Zerar_Stats(void);
+
 #endif // APP_EVENTOS_H
@@ -19,7 +19,8 @@
 #include "eeprom_driver.h"
 #include "ads1232_driver.h"
 #include "pwm_servo_driver.h"
-#include "pcb_frequency.h"
+#include "medicao_frequencia.h"
+#include "calculo_umidade.h"
 #include "temp_sensor.h"
 #include "gerenciador_configuracoes.h"
 #include "servo_controle.h"
@@ -32,14 +33,25 @@
  */
 typedef struct {
     float    grams_display;     // Valor final em gramas (usado pela UI)
-    float    raw_counts_median; // Contagem bruta (resultado da mediana de 3)
+    int32_t  peso_mg;           // Valor final em mg (sada do caminho inteiro)
+    int32_t  raw_counts_median; // Contagem bruta aps a mediana deslizante
+    int32_t  filtered_counts;   // Sada da cadeia de filtros configurvel
+    uint32_t step_count;        // Degraus detectados (histrico do filtro descartado)
     bool     is_stable;         // Flag de estabilidade (lgica simplificada)
+    bool     tara_em_andamento; // Tara no-bloqueante ainda coletando amostras
+    bool     previsao_convergiu;    // Ajuste do assentamento dentro do limite de incerteza
+    int32_t  peso_previsto_mg;      // Peso final previsto enquanto o prato ainda oscila
+    int32_t  previsao_incerteza_mg; // Limite () da previso; INT32_MAX sem ajuste
+    uint32_t sample_seq;        // Sequncia da ltima amostra do ADS1232 processada
+    uint32_t sample_tick;       // Tick (ms) da ltima amostra processada
 } App_ScaleData_t;
 
 
 typedef struct {
-    uint32_t pulsos;
+    uint32_t frequencia_hz;     // ltima medio do pcb_frequency (arredondada)
+    uint32_t frequencia_chz;    // A mesma em centsimos de Hz (resoluo do modo recproco)
     float escala_a;
+    int32_t escala_a_x10000;    // Escala A em unidades de 0.0001 (caminho inteiro)
 } FreqData_t;
 
 
@@ -59,6 +71,10 @@ void App_Manager_Handle_New_Password(const char* new_password);
 
 void App_Manager_GetScaleData(App_ScaleData_t* data); 
 void App_Manager_GetFreqData(FreqData_t* data);
+void App_Manager_GetUmidade(Umid_Resultado_t* resultado);
 float App_Manager_GetTemperature(void);
+void App_Manager_Aplicar_Filtro_Balanca(void);
+void App_Manager_Iniciar_Captura(uint32_t num_amostras);
+void App_Manager_Parar_Captura(void);
 
 #endif // APP_MANAGER_H
\ No newline at end of file
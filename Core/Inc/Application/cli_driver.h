@@ -17,11 +17,21 @@ void CLI_Init(UART_HandleTypeDef* debug_huart);
  */
 void CLI_Process(void);
 
+/**
+ * @brief true quando h uma linha completa esperando CLI_Process() (consulta do agendador).
+ */
+bool CLI_Comando_Pendente(void);
+
 /**
  * @brief "Bomba" de TX do CLI. Chamada pelo super-loop para enviar dados do FIFO via DMA.
  */
 void CLI_TX_Pump(void);
 
+/**
+ * @brief true se h bytes no FIFO e o DMA est livre (o CLI_TX_Pump() tem o que fazer).
+ */
+bool CLI_TX_Pendente(void);
+
 /**
  * @brief Funo de transmisso de baixo nvel para retarget.c (printf).
  * Adiciona um caractere ao FIFO de transmisso (atmico).
@@ -3,30 +3,86 @@
 
 #include "main.h"
 #include <stdint.h>
+#include <stdbool.h>
+#include "scale_fixed.h"
 
 // --- DEFINIES PARTILHADAS PARA CALIBRAO ---
-#define NUM_CAL_POINTS 4
+#define ADS1232_CAL_MAX_POINTS 12 // Qualquer quantidade de pontos entre 2 e este limite
 
 typedef struct {
     float grams;
     int32_t adc_value;
 } CalPoint_t;
 
-// Declarao 'extern' para tornar a tabela visvel para outros ficheiros
-extern CalPoint_t cal_points[NUM_CAL_POINTS];
+/**
+ * @brief Curva de calibrao pr-calculada (montada s quando a calibrao muda).
+ * O segmento i vale para breakpoints[i] <= x < breakpoints[i+1]; o primeiro e o
+ * ltimo segmentos extrapolam. Converso: y = intercept[i] + slope[i] * x.
+ */
+typedef struct {
+    uint8_t n_segmentos;                                  // pontos - 1
+    int32_t breakpoints[ADS1232_CAL_MAX_POINTS];          // ADC dos pontos (crescente)
+#if SCALE_FIXED_POINT
+    int32_t slope_q24[ADS1232_CAL_MAX_POINTS - 1];        // mg/count (Q24)
+    int64_t intercept_q24[ADS1232_CAL_MAX_POINTS - 1];    // mg em x = 0 (Q24)
+#else
+    float   slope_g[ADS1232_CAL_MAX_POINTS - 1];          // g/count
+    float   intercept_g[ADS1232_CAL_MAX_POINTS - 1];      // g em x = 0
+#endif
+    int32_t adc_zero;                                     // ADC onde a curva vale 0 g
+} ADS1232_CalTable_t;
+
+// Calibrao de fbrica (usada como padro pelo gerenciador de configuraes)
+#define ADS1232_CAL_PADRAO_PONTOS 4
+extern const CalPoint_t ADS1232_CAL_PADRAO[ADS1232_CAL_PADRAO_PONTOS];
+
+// --- TAXA DE CONVERSO ---
+// A placa no liga SPEED nem GAIN1/GAIN0 ao MCU: os strappings fixam 10 SPS e
+// ganho 128 (o da calibrao). As janelas em tempo so convertidas com isto.
+#define ADS1232_SPS 10
+
+// --- RING DE AMOSTRAS (sincronizado com DRDY) ---
+#define ADS1232_RING_SIZE 16 // Potncia de 2 (>= 1.6 s de folga a 10 SPS)
+
+typedef struct {
+    int32_t  raw;   // Converso bruta (24 bits com sinal estendido)
+    uint32_t seq;   // Nmero de sequncia (incrementa a cada DRDY)
+    uint32_t tick;  // HAL_GetTick() no fim do shift
+} ADS1232_Sample_t;
+
+typedef struct {
+    uint32_t total_conversoes; // Converses concludas desde o Init
+    uint32_t descartadas;      // Amostras perdidas por ring cheio
+    uint32_t overruns;         // Vezes em que o ring encheu
+    uint8_t  nivel_atual;      // Amostras aguardando consumo
+    uint8_t  nivel_max;        // Maior ocupao observada
+} ADS1232_Stats_t;
 
 
 // --- Funes Pblicas ---
 void ADS1232_Init(void);
+bool ADS1232_Pop_Sample(ADS1232_Sample_t* out);
+uint32_t ADS1232_Drain(ADS1232_Sample_t* buf, uint32_t max);
+bool ADS1232_HasSample(void);
+void ADS1232_Flush(void);
+void ADS1232_GetStats(ADS1232_Stats_t* stats);
 int32_t ADS1232_Read(void);
-int32_t ADS1232_Read_Median_of_3(void);
-int32_t ADS1232_Tare(void);
-void ADS1232_SetCalibrationFactor(float factor);
 float ADS1232_ConvertToGrams(int32_t raw_value);
+float ADS1232_GetGramsPerCount(int32_t raw_value);
+bool ADS1232_BuildCalTable(const CalPoint_t* pontos, uint8_t n, ADS1232_CalTable_t* out);
+bool ADS1232_SetCalibration(const CalPoint_t* pontos, uint8_t n);
+bool ADS1232_RequestCalibration(const CalPoint_t* pontos, uint8_t n);
+void ADS1232_Calibration_Process(void);
+bool ADS1232_Calibration_IsBusy(void);
+void ADS1232_GetCalTable(ADS1232_CalTable_t* out);
+#if SCALE_FIXED_POINT
+int32_t ADS1232_ConvertToMilligrams(int32_t raw_value);
+int32_t ADS1232_GetMgPerCount_Q24(int32_t raw_value);
+#endif
 int32_t ADS1232_GetOffset(void);
 void ADS1232_SetOffset(int32_t new_offset);
-float ADS1232_GetCalibrationFactor(void);
 void Drv_ADS1232_DRDY_Callback(void);
+void Drv_ADS1232_SCLK_Callback(void);
 
 
 #endif // __ADS1232_DRIVER_H
\ No newline at end of file
@@ -190,6 +190,12 @@ void DWIN_Driver_Process(void);
  */
 void DWIN_TX_Pump(void);
 
+/**
+ * @brief true se DWIN_Driver_Process()/DWIN_TX_Pump() tm trabalho: pacote
+ * recebido, recuperao de erro ou FIFO TX com o DMA livre.
+ */
+bool DWIN_Driver_Pendente(void);
+
 /**
  * @brief Indica se o driver est ocupado enviando dados (FIFO ou DMA ativo).
  */
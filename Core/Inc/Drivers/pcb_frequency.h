@@ -2,9 +2,77 @@
 #define INC_PCB_FREQUENCY_H_
 
 #include "main.h"
+#include <stdbool.h>
 
+typedef enum {
+    FREQ_MODO_CONTAGEM = 0,  // Pulsos numa janela do TIM1 (resoluo = 1 / janela)
+    FREQ_MODO_RECIPROCO = 1  // Carimbo de tempo das bordas a 48 MHz (sub-Hz em 100 ms)
+} Freq_Modo_t;
+
+#define FREQ_MODO_PADRAO        FREQ_MODO_RECIPROCO
+
+// --- Janela (gate): no modo contagem  gerada pelo TIM1 (1 tick = 1 ms) ---
+#define FREQ_JANELA_MIN_MS      50
+#define FREQ_JANELA_MAX_MS      2000
+#define FREQ_JANELA_PADRAO_MS   1000 // Contagem: 1 s -> pulsos da janela = Hz
+// Capturas do TIM2->CNT guardadas pelo DMA (o loop precisa ler antes de dar a volta)
+#define FREQ_RING_CAPTURAS      8
+
+// --- Modo recproco ---
+#define FREQ_RECIP_JANELA_MS    100  // Durao de cada janela curta
+#define FREQ_RECIP_MEDIA        4    // Janelas somadas no resultado (rejeio de rudo)
+#define FREQ_RECIP_MEDIA_MAX    16
+#define FREQ_RECIP_DIV_IC       8    // Prescaler da captura: 1 carimbo a cada 8 bordas
+
+typedef struct {
+    Freq_Modo_t modo;
+    uint32_t janela_ms;      // Durao de cada janela
+    uint8_t  media_janelas;  // Janelas combinadas por resultado (recproco)
+    uint32_t janelas;        // Janelas completas processadas desde a troca de modo
+    uint32_t perdidas;       // Ressincronizaes (ring/contador deu a volta sem ser lido)
+    uint32_t bordas;         // Recproco: bordas de entrada na ltima janela
+    uint32_t ticks;          // Recproco: ticks de 48 MHz entre a 1a e a ltima borda
+} Frequency_Stats_t;
+
+/**
+ * @brief Inicia o TIM2, o TIM1 e o DMA1 canal 5 no modo padro.
+ */
 void Frequency_Init(void);
-void Frequency_Reset(void);
-uint32_t Frequency_Get_Pulse_Count(void);
 
-#endif /* INC_PCB_FREQUENCY_H_ */
\ No newline at end of file
+/**
+ * @brief Troca o mtodo de medio (reconfigura TIM2/TIM1/DMA e zera as mdias).
+ * Mantm a janela escolhida por Frequency_Set_Janela_ms; sem ela, usa a
+ * padro do modo (FREQ_JANELA_PADRAO_MS ou FREQ_RECIP_JANELA_MS).
+ */
+void Frequency_Set_Modo(Freq_Modo_t modo);
+
+/**
+ * @brief Muda a durao da janela do modo atual (FREQ_JANELA_MIN_MS..MAX_MS).
+ * Reinicia a medio; o valor continua valendo nas trocas de modo.
+ */
+bool Frequency_Set_Janela_ms(uint32_t janela_ms);
+
+/**
+ * @brief (Superloop) Consome as capturas novas e fecha as janelas vencidas.
+ * No modo recproco precisa rodar a cada < 65535 capturas (~260 ms a 2 MHz).
+ * @param freq_hz Recebe a frequncia mais recente, arredondada em Hz (pode ser NULL).
+ * @return true se um resultado novo ficou pronto desde a ltima chamada.
+ */
+bool Frequency_Process(uint32_t* freq_hz);
+
+/**
+ * @brief ltima frequncia medida em centsimos de Hz (0 sem sinal ou at o 1o resultado).
+ */
+uint32_t Frequency_Get_Freq_cHz(void);
+
+/**
+ * @brief Frequncia s da janela mais recente (cHz). No recproco o
+ * Frequency_Get_Freq_cHz soma FREQ_RECIP_MEDIA janelas e resultados seguidos
+ * se sobrepem; este no, ento serve para mdia e sigma. Na contagem os
+ * dois so iguais.
+ */
+uint32_t Frequency_Get_Janela_cHz(void);
+
+void Frequency_Get_Stats(Frequency_Stats_t* stats);
+
+#endif /* INC_PCB_FREQUENCY_H_ */
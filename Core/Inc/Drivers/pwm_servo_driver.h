@@ -2,6 +2,15 @@
 #define PWM_SERVO_DRIVER_H
 
 #include "main.h" // Necessrio para o tipo TIM_HandleTypeDef
+#include <stdbool.h>
+
+// Base de tempo dos servos: 1 tick = 1 us, perodo de 20 ms (50 Hz)
+#define PWM_SERVO_PRESCALER        47u     // 48 MHz -> 1 MHz (TIM16/TIM17 no .ioc)
+#define PWM_SERVO_PERIODO_US       20000u
+#define PWM_SERVO_PERIODO_MS       (PWM_SERVO_PERIODO_US / 1000u)
+
+// Perfil de movimento: um CCR por update do timer, copiado pelo DMA1 canal 2
+#define PWM_SERVO_RAMPA_MAX_PASSOS 100u    // 2 s de movimento no mximo
 
 //Estrutura para definir um servo motor e suas propriedades.
 typedef struct {
@@ -9,6 +18,7 @@ typedef struct {
     uint32_t           channel;      // Canal do timer
     uint16_t           min_pulse_us; // Pulso mnimo em microssegundos (valor calibrado para 0)
     uint16_t           max_pulse_us; // Pulso mximo em microssegundos (valor calibrado para 180)
+    uint16_t           pulse_us;     // ltimo pulso comandado (destino do movimento em curso)
 } Servo_t;
 
 /**
@@ -25,6 +35,39 @@ HAL_StatusTypeDef PWM_Servo_Init(Servo_t *servo);
  */
 void PWM_Servo_SetAngle(Servo_t *servo, float angle);
 
+/**
+ * @brief Converte um ngulo inteiro (0..180, saturado) no pulso do servo.
+ * Para calcular uma vez as posies usadas com frequncia, fora do loop.
+ */
+uint16_t PWM_Servo_Angle_To_Pulse(const Servo_t *servo, uint32_t angle_deg);
+
+/**
+ * @brief Como PWM_Servo_SetAngle(), com o pulso j calculado (sem float).
+ */
+void PWM_Servo_SetPulse(Servo_t *servo, uint16_t pulse_us);
+
+/**
+ * @brief Move o servo at 'pulse_us' por um perfil trapezoidal de velocidade.
+ * A rampa de CCR  calculada uma vez e o DMA a copia para o CCR a cada
+ * update do timer (20 ms), sem CPU durante o movimento. Um s canal de DMA
+ * atende os dois servos: um novo movimento do MESMO servo substitui o atual
+ * (parte do pulso em que ele est); o de outro servo espera o atual terminar.
+ * @param pulse_us   Destino (PWM_Servo_Angle_To_Pulse).
+ * @param duracao_ms Tempo do movimento; abaixo de um perodo o pulso salta.
+ * @return false se o DMA est ocupado com outro servo (tente de novo depois).
+ */
+bool PWM_Servo_Move_Pulse(Servo_t *servo, uint16_t pulse_us, uint32_t duracao_ms);
+
+/**
+ * @brief true enquanto um perfil estiver sendo copiado pelo DMA.
+ */
+bool PWM_Servo_Is_Moving(void);
+
+/**
+ * @brief Tratador do DMA1 canal 2 (chamado no DMA1_Channel2_3_IRQHandler).
+ */
+void PWM_Servo_DMA_IRQHandler(void);
+
 /**
  * @brief Para a gerao de PWM para um servo especfico.
  * @param servo Ponteiro para a estrutura do servo.
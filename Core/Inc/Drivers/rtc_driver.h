@@ -11,13 +11,13 @@
 void RTC_Driver_Init(RTC_HandleTypeDef* hrtc);
 
 /**
- * @brief Tarefa de processo peridico do RTC (chamada no super-loop).
+ * @brief Tarefa de processo peridico do RTC (a cada EV_SYSTEM_TICK_1S, pelo app_manager).
  * L a hora atual e a enfileira para envio ao display DWIN (de forma cooperativa).
  */
 void RTC_Driver_Process(void);
 
 /**
- * @brief Define a hora do RTC (chamado pelo Controller aps evento DWIN).
+ * @brief Define a hora do RTC (pelo App Manager, no EV_UI_DATETIME_ENTERED do Controller).
  */
 void RTC_Driver_SetTime(uint8_t hours, uint8_t minutes, uint8_t seconds);
 
@@ -2,6 +2,7 @@
 #define TEMP_SENSOR_H
 
 #include "main.h"
+#include <stdbool.h>
 
 /**
  * @brief L a temperatura do sensor interno do STM32.
@@ -10,4 +11,31 @@
  */
 float TempSensor_GetTemperature(void);
 
+/**
+ * @brief Dispara uma converso em segundo plano (no bloqueia).
+ * @return false se o ADC no pde ser iniciado.
+ */
+bool TempSensor_Iniciar_Conversao(void);
+
+/**
+ * @brief (Superloop) Recolhe a converso em curso, se j terminou.
+ * @return true quando uma temperatura nova ficou disponvel.
+ */
+bool TempSensor_Process(void);
+
+/**
+ * @brief true enquanto h converso em segundo plano para recolher.
+ */
+bool TempSensor_Em_Conversao(void);
+
+/**
+ * @brief ltima temperatura medida (bloqueante ou em segundo plano), em C.
+ */
+float TempSensor_Get_Ultima(void);
+
+/**
+ * @brief Converses em segundo plano concludas desde o boot.
+ */
+uint32_t TempSensor_Get_Contador(void);
+
 #endif // TEMP_SENSOR_H
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef CALCULO_UMIDADE_H
+#define CALCULO_UMIDADE_H
+
+#include "main.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Temperatura de referncia das curvas do Produto[] (x100)
+#define UMID_TEMP_REF_X100      2500
+// Correo da Escala A pela massa da amostra (x = Escala A * Peso_Pad / peso).
+// Desligada: as curvas do Produto[] foram levantadas na massa padro e esta
+// correo no foi validada com amostras de referncia fora do Peso_Pad
+#ifndef UMID_CORRECAO_PESO
+#define UMID_CORRECAO_PESO      0
+#endif
+
+typedef enum {
+    UMID_OK,
+    UMID_ABAIXO_FAIXA,      // Resultado limitado em Um_Min
+    UMID_ACIMA_FAIXA,       // Resultado limitado em Um_Max
+    UMID_PESO_INVALIDO,     // Sem peso para a correo de massa (UMID_CORRECAO_PESO)
+    UMID_SEM_GRAO           // Nenhum gro vlido selecionado
+} Umid_Status_t;
+
+typedef struct {
+    Umid_Status_t status;
+    uint8_t  grao;                 // ndice no Produto[]
+    int32_t  escala_a_x10000;      // Escala A da frequncia (entrada da curva)
+    int32_t  umidade_bruta_x100;   // Curva sem correo de temperatura
+    int32_t  umidade_x100;         // Resultado final (% x100), j limitado  faixa
+    bool     densidade_valida;     // Volume da cmara configurado (seno no h densidade)
+    int32_t  densidade_x10;        // kg/hL x10 = peso (g) / volume (mL) * 1000
+} Umid_Resultado_t;
+
+/**
+ * @brief Converte os coeficientes do gro (Produto[indice]) e o Cal_A para ponto fixo.
+ * Chamar no boot e sempre que o operador trocar o gro ativo.
+ */
+bool Calculo_Umidade_Selecionar_Grao(uint8_t indice);
+
+/**
+ * @brief Rel o ajuste de campo Cal_A da configurao e o guarda em ponto fixo.
+ * Chamar depois de Gerenciador_Config_Set_Cal_A() (a seleo do gro j chama).
+ */
+void Calculo_Umidade_Atualizar_Cal_A(void);
+
+/**
+ * @brief Massa padro (Peso_Pad) do gro ativo, em mg (0 sem gro vlido).
+ */
+int32_t Calculo_Umidade_Get_Peso_Pad_mg(void);
+
+/**
+ * @brief Escala A (x10000) a partir da frequncia, com o ajuste de campo Cal_A.
+ * S inteiros: usa o Cal_A convertido por Calculo_Umidade_Atualizar_Cal_A().
+ */
+int32_t Calculo_Umidade_Escala_A_x10000(uint32_t freq_chz);
+
+/**
+ * @brief Avalia a curva do gro ativo.
+ * @param freq_chz Frequncia do sensor capacitivo (centsimos de Hz).
+ * @param peso_mg Peso da amostra na cmara.
+ * @param temp_x100 Temperatura da amostra (centsimos de C).
+ * @param resultado Recebe todos os valores intermedirios (pode ser NULL).
+ */
+Umid_Status_t Calculo_Umidade_Calcular(uint32_t freq_chz, int32_t peso_mg, int32_t temp_x100,
+                                       Umid_Resultado_t* resultado);
+
+/**
+ * @brief Envia umidade e densidade para os VPs UMIDADE_1_CASA e DENSIDADE.
+ * O DENSIDADE s  escrito com densidade_valida (volume da cmara medido).
+ */
+void Calculo_Umidade_Publicar(const Umid_Resultado_t* resultado);
+
+/**
+ * @brief Zera os VPs UMIDADE_1_CASA e DENSIDADE (medio sem resultado vlido).
+ */
+void Calculo_Umidade_Limpar(void);
+
+#endif // CALCULO_UMIDADE_H
@@ -0,0 +1,67 @@
+#ifndef CALIBRACAO_BALANCA_H
+#define CALIBRACAO_BALANCA_H
+
+#include "main.h"
+#include "gerenciador_configuracoes.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Etapas da calibrao guiada (DWIN TELA_ADJUST_SCALE ou CLI "CAL").
+ */
+typedef enum {
+    CAL_BAL_OCIOSO,
+    CAL_BAL_AGUARDA_PESO,   // Operador coloca a massa do ponto atual e confirma
+    CAL_BAL_CAPTURANDO,     // Mdia das converses do ADS1232 com a massa estvel
+    CAL_BAL_SALVANDO        // Aguardando o gerenciador aceitar os novos pontos
+} Cal_Bal_Etapa_t;
+
+typedef struct {
+    Cal_Bal_Etapa_t etapa;
+    uint8_t ponto_atual;            // ndice do ponto sendo capturado
+    uint8_t num_pontos;             // Total de pontos desta calibrao
+    float   massa_atual_g;          // Massa que o operador deve colocar
+    Config_Ponto_Cal_t pontos[MAX_PONTOS_CAL_BALANCA]; // Pontos j capturados
+} Cal_Bal_Status_t;
+
+/**
+ * @brief Aplica a calibrao salva na EEPROM ao driver (chamar no boot, aps o gerenciador).
+ */
+void Calibracao_Balanca_Init(void);
+
+/**
+ * @brief Avana a calibrao guiada e a remontagem da tabela em segundo plano.
+ * Deve ser chamada repetidamente no loop principal.
+ */
+void Calibracao_Balanca_Process(void);
+
+/**
+ * @brief true enquanto a tabela  remontada ou os pontos esperam a EEPROM.
+ */
+bool Calibracao_Balanca_Pendente(void);
+
+/**
+ * @brief Entrega uma converso bruta do ADS1232 (chamada por Task_Handle_Scale).
+ */
+void Calibracao_Balanca_Nova_Amostra(int32_t raw);
+
+/**
+ * @brief Inicia a calibrao guiada.
+ * @param massas_g Massas de referncia (gramas) ou NULL para reutilizar as massas da calibrao atual.
+ * @param n Quantidade de massas (2..MAX_PONTOS_CAL_BALANCA).
+ */
+bool Calibracao_Balanca_Iniciar(const float* massas_g, uint8_t n);
+
+/**
+ * @brief Operador confirmou que a massa do ponto atual est no prato.
+ */
+bool Calibracao_Balanca_Confirmar_Ponto(void);
+
+/**
+ * @brief Aborta a calibrao guiada. A calibrao anterior continua ativa.
+ */
+void Calibracao_Balanca_Cancelar(void);
+
+void Calibracao_Balanca_Get_Status(Cal_Bal_Status_t* status);
+
+#endif // CALIBRACAO_BALANCA_H
@@ -0,0 +1,111 @@
+#ifndef CICLO_MEDICAO_H
+#define CICLO_MEDICAO_H
+
+#include "main.h"
+#include "calculo_umidade.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Os *_MS marcados "padro" so os tempos da sequncia de fbrica; o ciclo usa
+// os passos da configurao (Config_Passo_Servo_t, CLI "SEQ")
+
+// --- Enchimento (funil aberto) ---
+#define CICLO_ENCHIMENTO_MIN_MS     300   // Padro. Ignora o impacto inicial do gro na cmara
+#define CICLO_ENCHIMENTO_MAX_MS     2000  // Padro. Mesmo tempo do antigo roteiro fixo
+#define CICLO_PLATO_JANELA_MS       100   // Janela do plat
+#define CICLO_PLATO_MIN_AMOSTRAS    3     // A 10 SPS o plat alonga para 3 amostras
+#define CICLO_PLATO_MG              1000  // Variao mxima na janela para "cmara cheia"
+#define CICLO_CHEIO_MIN_PCT         50    // Peso mnimo (% do Peso_Pad) para aceitar o plat
+
+// --- Dosagem em malha fechada (alvo = Peso_Pad do gro) ---
+#define CICLO_VAZAO_JANELA_MS       200   // Regresso da vazo
+#define CICLO_VAZAO_MIN_AMOSTRAS    6     // A 10 SPS a regresso alonga para 6 amostras (600 ms)
+#define CICLO_PESO_AMOSTRAS         16    // Histrico do peso (1.6 s a 10 SPS)
+#define CICLO_ANTECIPACAO_PADRAO_MS 150   // Fechamento do servo + atraso dos filtros
+#define CICLO_ANTECIPACAO_MIN_MS    20
+#define CICLO_ANTECIPACAO_MAX_MS    600
+#define CICLO_ANTECIPACAO_SHIFT     2     // Aprende 1/4 do erro por ciclo
+#define CICLO_QUEDA_MAX_MS          400   // Padro. Espera da massa em queda aps fechar o funil
+
+// --- Nivelamento (raspador aberto) ---
+#define CICLO_RASPAGEM_MIN_MS       600   // Padro. Curso completo do raspador
+#define CICLO_RASPAGEM_MAX_MS       2000  // Padro
+
+// --- Medio (servos fechados) ---
+#define CICLO_MEDICAO_MAX_MS        4000  // Padro. Desiste se frequncia/peso no fecharem
+
+typedef enum {
+    CICLO_OCIOSO,
+    CICLO_ENCHENDO,     // Funil aberto at a dosagem prever o alvo (ou plat)
+    CICLO_NIVELANDO,    // Massa em queda assenta; depois o raspador abre.
+                        // Frequncia e temperatura j correm
+    CICLO_MEDINDO,      // Espera mdia de frequncia, peso estvel e temperatura nova
+    CICLO_CONCLUIDO     // Resultado disponvel at o prximo ciclo
+} Ciclo_Fase_t;
+
+typedef struct {
+    Ciclo_Fase_t fase;
+    uint32_t ciclos;                // Ciclos concludos desde o boot
+    bool     resultado_valido;      // Mdia de frequncia e peso estvel obtidos
+    bool     enchimento_por_tempo;  // Espera DOSAGEM encerrada pelo limite do passo
+    bool     fechou_por_dosagem;    // Fechou pela previso da vazo (e no por plat/tempo)
+    bool     nivelamento_por_tempo; // Peso no estabilizou com o raspador aberto (limite do passo)
+    bool     medicao_por_tempo;     // Espera MEDICAO encerrada pelo limite do passo
+    uint32_t t_enchimento_ms;
+    uint32_t t_nivelamento_ms;
+    uint32_t t_medicao_ms;
+    uint32_t t_total_ms;
+    int32_t  alvo_mg;               // Peso_Pad do gro ativo
+    int32_t  vazao_mg_s;            // Vazo estimada no fechamento do funil
+    int32_t  peso_fechamento_mg;    // Peso lido no comando de fechar
+    int32_t  massa_dosada_mg;       // Peso depois que a massa em queda assentou
+    uint32_t antecipacao_ms;        // Antecipao usada neste ciclo
+    int32_t  peso_mg;               // Peso estvel (ou previsto) usado no clculo
+    bool     peso_por_previsao;     // Peso veio da previso do assentamento
+    int32_t  incerteza_mg;          // Limite da previso usada (0 se veio da estabilidade)
+    uint32_t freq_chz;              // Mdia sincronizada usada no clculo
+    int32_t  temp_x100;             // Temperatura usada no clculo
+    Umid_Resultado_t umidade;
+} Ciclo_Status_t;
+
+/**
+ * @brief Inicia um ciclo de medio (ignorado se outro estiver em andamento).
+ * A sequncia de passos dos servos  lida da configurao nesta chamada:
+ * uma alterao vale a partir do prximo ciclo.
+ * @return false se j havia um ciclo (ou sequncia dos servos) rodando.
+ */
+bool Ciclo_Medicao_Iniciar(void);
+
+/**
+ * @brief (Superloop) Avana a sequncia dos servos e as fases conforme os sensores.
+ * Chamar depois de Medicao_Freq_Process() e TempSensor_Process().
+ */
+void Ciclo_Medicao_Process(void);
+
+/**
+ * @brief Entrega cada amostra da balana j filtrada (mesmo fluxo da tara).
+ * @param peso_mg Peso lquido.
+ * @param tick_ms Instante da converso (ADS1232_Sample_t.tick), base da vazo.
+ * @param estavel Resultado do teste de estabilidade da aplicao (falso durante a tara).
+ */
+void Ciclo_Medicao_Nova_Amostra_Peso(int32_t peso_mg, uint32_t tick_ms, bool estavel);
+
+/**
+ * @brief Entrega a previso do peso assentado (ScaleSettle) da mesma amostra.
+ * Com a previso convergida as esperas de peso terminam sem esperar
+ * o prato parar de oscilar.
+ * @param convergiu    Previso dentro do limite de incerteza.
+ * @param previsto_mg  Peso final previsto.
+ * @param incerteza_mg Limite () da previso.
+ */
+void Ciclo_Medicao_Nova_Previsao_Peso(bool convergiu, int32_t previsto_mg, int32_t incerteza_mg);
+
+/**
+ * @brief Antecipao aprendida pela dosagem (ms); reinicia no boot.
+ */
+uint32_t Ciclo_Medicao_Get_Antecipacao_ms(void);
+
+Ciclo_Fase_t Ciclo_Medicao_Get_Fase(void);
+void Ciclo_Medicao_Get_Status(Ciclo_Status_t* status);
+
+#endif // CICLO_MEDICAO_H
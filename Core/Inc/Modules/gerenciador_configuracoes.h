@@ -14,6 +14,19 @@
 #define MAX_NOME_GRAO_LEN 15
 #define MAX_SENHA_LEN 10
 #define MAX_VALIDADE_LEN 10
+#define MAX_PONTOS_CAL_BALANCA 8   // Deve ser <= ADS1232_CAL_MAX_POINTS
+#define MAX_ESTAGIOS_FILTRO_BALANCA 3 // Deve ser <= SF_CHAIN_MAX_STAGES
+#define MEDIANA_BALANCA_PADRAO 5
+#define MAX_REPETICOES 10          // Medies por lote no modo repetio
+#define REPETICOES_PADRAO 1
+#define SERVO_RAMPA_PADRAO_MS 300  // Durao dos movimentos dos servos (perfil trapezoidal)
+#define SERVO_RAMPA_MIN_MS 20      // Um perodo do PWM: na prtica, salto
+#define SERVO_RAMPA_MAX_MS 2000    // PWM_SERVO_RAMPA_MAX_PASSOS * 20 ms
+#define CICLO_TEMPO_MAX_MS 60000   // Maior tempo (ou limite) de um passo da sequncia
+#define MAX_PASSOS_SEQUENCIA 12    // Passos da sequncia dos servos (ciclo de medio)
+#define VOLUME_CAMARA_MAX_ML 5000  // Volume til da cmara (densidade); 0 = no medido
+#define CONFIG_VERSAO_STRUCT 2     // V2: calibrao e filtros da balana, repeties, servos, ciclo e cmara
+                                   // (V1, o firmware original,  migrado no boot: Migrar_Configuracao_V1)
 
 //==============================================================================
 // Estruturas de Dados
@@ -27,16 +40,55 @@ typedef struct {
     int16_t umidade_max;
 } Config_Grao_t;
 
+typedef struct {
+    float gramas;      // Massa de referncia do ponto
+    int32_t adc;       // Leitura bruta do ADS1232 com essa massa
+} Config_Ponto_Cal_t;
+
+typedef struct {
+    uint8_t tipo;      // ScaleFilterStageType (scale_filter.h); 0 = estgio vazio
+    uint8_t janela;    // Mdia mvel / mediana: amostras
+    uint16_t param_a;  // EMA: alfa (Q16). Kalman: rudo de processo (counts, Q8)
+    uint16_t param_b;  // Kalman: rudo de medida (counts)
+    uint16_t reservado;
+} Config_Estagio_Filtro_t;
+
+typedef struct {
+    uint8_t servo;         // Servo_Seq_Alvo_t (servo_controle.h); 0 = passo s de espera
+    uint8_t angulo;        // Alvo em graus (0..SERVO_ANGULO_MAX)
+    uint8_t espera;        // Servo_Seq_Espera_t: tempo, fim do movimento ou condio do ciclo
+    uint8_t reservado;
+    uint16_t duracao_ms;   // Tempo do passo; nas esperas por condio, o limite (0 = sem limite)
+    uint16_t minimo_ms;    // Esperas por condio: tempo antes da primeira consulta
+} Config_Passo_Servo_t;
+
 typedef struct {
     uint32_t versao_struct;
     uint8_t indice_idioma_selecionado;
     uint8_t indice_grao_ativo;
-    uint8_t preenchimento[2];
+    uint8_t num_repeticoes;          // Medies por lote (0 = padro, bloco V1)
+    uint8_t servo_rampa_10ms;        // Durao dos movimentos (x10 ms; 0 = padro, bloco V1)
     char senha_sistema[MAX_SENHA_LEN + 2];
     
     float fat_cal_a_gain;
     float fat_cal_a_zero;
 
+    uint8_t cal_bal_num_pontos;
+    uint8_t preenchimento_cal[3];
+    Config_Ponto_Cal_t cal_bal_pontos[MAX_PONTOS_CAL_BALANCA];
+
+    uint8_t filtro_num_estagios;
+    uint8_t filtro_mediana_janela;   // Mediana antes da cadeia (0 = padro)
+    uint16_t filtro_degrau_mg;       // Limiar do fast-settle (0 = desligado)
+    Config_Estagio_Filtro_t filtro_estagios[MAX_ESTAGIOS_FILTRO_BALANCA];
+
+    uint8_t seq_num_passos;
+    uint8_t preenchimento_seq[3];
+    Config_Passo_Servo_t seq_passos[MAX_PASSOS_SEQUENCIA];
+
+    uint16_t volume_camara_ml;       // Volume til da cmara (0 = no medido: sem densidade)
+    uint16_t preenchimento_camara;
+
     Config_Grao_t graos[MAX_GRAOS];
     uint32_t crc;
 } Config_Aplicacao_t;
@@ -46,8 +98,8 @@ typedef struct {
 //==============================================================================
 
 #define CONFIG_BLOCK_SIZE sizeof(Config_Aplicacao_t) // Calcula o tamanho exato do bloco de dados.
-#define CONFIG_PAGES_NEEDED ((CONFIG_BLOCK_SIZE / EEPROM_PAGE_SIZE) + 1) // (276 / 32) + 1 = 9 pginas
-#define EEPROM_CONFIG_BLOCK_SPACING (CONFIG_PAGES_NEEDED * EEPROM_PAGE_SIZE) // 9 * 32 = 288 bytes
+#define CONFIG_PAGES_NEEDED ((CONFIG_BLOCK_SIZE / EEPROM_PAGE_SIZE) + 1) // V2: (484 / 32) + 1 = 16 pginas
+#define EEPROM_CONFIG_BLOCK_SPACING (CONFIG_PAGES_NEEDED * EEPROM_PAGE_SIZE) // V2: 16 * 32 = 512 bytes
 
 #define ADDR_CONFIG_PRIMARY   0x0000
 #define ADDR_CONFIG_BACKUP1   (ADDR_CONFIG_PRIMARY + EEPROM_CONFIG_BLOCK_SPACING)
@@ -71,6 +123,22 @@ bool Gerenciador_Config_Set_Grao_Ativo(uint8_t novo_indice);
 bool Gerenciador_Config_Get_Grao_Ativo(uint8_t* indice_ativo);
 bool Gerenciador_Config_Get_Cal_A(float* gain, float* zero);
 bool Gerenciador_Config_Set_Cal_A(float gain, float zero);
+uint8_t Gerenciador_Config_Get_Cal_Balanca(Config_Ponto_Cal_t* pontos, uint8_t max_pontos);
+bool Gerenciador_Config_Set_Cal_Balanca(const Config_Ponto_Cal_t* pontos, uint8_t num_pontos);
+uint8_t Gerenciador_Config_Get_Filtro_Balanca(Config_Estagio_Filtro_t* estagios, uint8_t max_estagios, uint16_t* degrau_mg);
+bool Gerenciador_Config_Set_Filtro_Balanca(const Config_Estagio_Filtro_t* estagios, uint8_t num_estagios, uint16_t degrau_mg);
+uint8_t Gerenciador_Config_Get_Mediana_Balanca(void);
+bool Gerenciador_Config_Set_Mediana_Balanca(uint8_t janela);
+uint8_t Gerenciador_Config_Get_Repeticoes(void);
+bool Gerenciador_Config_Set_Repeticoes(uint8_t repeticoes);
+uint32_t Gerenciador_Config_Get_Servo_Rampa_ms(void);
+bool Gerenciador_Config_Set_Servo_Rampa_ms(uint32_t duracao_ms);
+uint8_t Gerenciador_Config_Get_Sequencia_Servos(Config_Passo_Servo_t* passos, uint8_t max_passos);
+bool Gerenciador_Config_Set_Sequencia_Servos(const Config_Passo_Servo_t* passos, uint8_t num_passos);
+bool Gerenciador_Config_Restaurar_Sequencia_Servos(void);
+uint16_t Gerenciador_Config_Get_Volume_Camara_ml(void);
+bool Gerenciador_Config_Set_Volume_Camara_ml(uint16_t volume_ml);
 void Gerenciador_Config_Run_FSM(void);
+bool Gerenciador_Config_Pendente(void); // Alterao esperando gravao ou gravao em curso
 
 #endif // GERENCIADOR_CONFIGURACOES_H
\ No newline at end of file
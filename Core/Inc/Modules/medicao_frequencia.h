@@ -0,0 +1,73 @@
+#ifndef MEDICAO_FREQUENCIA_H
+#define MEDICAO_FREQUENCIA_H
+
+#include "main.h"
+#include "pcb_frequency.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MED_FREQ_HISTORICO          32  // Resultados guardados para mdia/sigma/deriva
+#define MED_FREQ_MEDIA_SEQ_JANELAS  10  // Janelas da mdia sincronizada com a sequncia
+#define MED_FREQ_MEDIA_MAX_JANELAS  100
+
+typedef struct {
+    uint32_t ultima_chz;     // Resultado mais recente (centsimos de Hz)
+    uint32_t media_chz;      // Mdia do histrico
+    uint32_t sigma_chz;      // Desvio padro do histrico
+    int32_t  deriva_chz_s;   // Inclinao do histrico (cHz/s, mnimos quadrados)
+    uint8_t  amostras;       // Resultados vlidos no histrico
+    uint32_t janela_ms;      // Janela atual do pcb_frequency
+} Med_Freq_Stats_t;
+
+typedef enum {
+    MED_FREQ_MEDIA_OCIOSA,
+    MED_FREQ_MEDIA_COLETANDO,   // Acumulando as janelas pedidas
+    MED_FREQ_MEDIA_PRONTA       // Resultado disponvel at o prximo pedido
+} Med_Freq_Estado_Media_t;
+
+typedef struct {
+    Med_Freq_Estado_Media_t estado;
+    uint8_t  janelas_alvo;
+    uint8_t  janelas;        // Janelas j acumuladas
+    uint32_t media_chz;
+    uint32_t sigma_chz;
+} Med_Freq_Media_t;
+
+/**
+ * @brief Inicia o pcb_frequency e zera o histrico.
+ */
+void Medicao_Freq_Init(void);
+
+/**
+ * @brief (Superloop) Recolhe os resultados novos do pcb_frequency.
+ * @return true se chegou um resultado novo nesta chamada.
+ */
+bool Medicao_Freq_Process(void);
+
+/**
+ * @brief Troca a janela de medio (FREQ_JANELA_MIN_MS..FREQ_JANELA_MAX_MS).
+ * Independe do intervalo de atualizao do display. Zera o histrico.
+ */
+bool Medicao_Freq_Set_Janela_ms(uint32_t janela_ms);
+
+/**
+ * @brief Troca o mtodo (contagem/recproco). Zera o histrico.
+ */
+void Medicao_Freq_Set_Modo(Freq_Modo_t modo);
+
+uint32_t Medicao_Freq_Get_Ultima_cHz(void);
+void Medicao_Freq_Get_Stats(Med_Freq_Stats_t* stats);
+
+/**
+ * @brief Pede uma mdia de 'janelas' resultados que comecem depois deste pedido.
+ * Chamada pela aplicao num ponto fixo da sequncia de medio.
+ */
+void Medicao_Freq_Iniciar_Media(uint8_t janelas);
+
+/**
+ * @brief Estado/resultado da mdia sincronizada.
+ * @return true se a mdia est pronta.
+ */
+bool Medicao_Freq_Get_Media(Med_Freq_Media_t* media);
+
+#endif // MEDICAO_FREQUENCIA_H
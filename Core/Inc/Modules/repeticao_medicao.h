@@ -0,0 +1,50 @@
+#ifndef REPETICAO_MEDICAO_H
+#define REPETICAO_MEDICAO_H
+
+#include "main.h"
+#include "gerenciador_configuracoes.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Rejeio por MAD: |x - mediana| > K * 1.4826 * MAD (desvio padro equivalente)
+#define REPET_MAD_K_X10         30    // K = 3.0
+#define REPET_MAD_MIN_X100      10    // Piso do MAD (0.10 %): evita rejeitar tudo com MAD = 0
+#define REPET_MAD_MIN_AMOSTRAS  3     // Aceitas antes de o teste comear a valer
+
+typedef enum {
+    REPET_OCIOSA,
+    REPET_MEDINDO,      // Ciclo de medio em andamento
+    REPET_CONCLUIDA     // Lote terminado; estatstica disponvel at o prximo
+} Repet_Estado_t;
+
+typedef struct {
+    Repet_Estado_t estado;
+    uint8_t  alvo;              // Repeties pedidas
+    uint8_t  executadas;        // Ciclos concludos no lote
+    uint8_t  aceitas;           // Entraram na estatstica
+    uint8_t  rejeitadas;        // Reprovadas no teste do MAD
+    uint8_t  invalidas;         // Ciclo incompleto ou fora da curva
+    int32_t  ultima_x100;       // ltima umidade medida (aceita ou no)
+    int32_t  media_x100;        // Mdia de Welford das aceitas
+    int32_t  desvio_x100;       // Desvio padro amostral das aceitas
+    int32_t  mediana_x100;
+    int32_t  mad_x100;
+    int32_t  densidade_x10;     // Mdia das densidades aceitas
+} Repet_Status_t;
+
+/**
+ * @brief Inicia um lote de 'repeticoes' ciclos (1..MAX_REPETICOES).
+ * @return false se j houver lote/ciclo em andamento ou n invlido.
+ */
+bool Repeticao_Medicao_Iniciar(uint8_t repeticoes);
+
+/**
+ * @brief (Superloop) Recolhe cada ciclo concludo e dispara o prximo.
+ * Chamar depois de Ciclo_Medicao_Process().
+ */
+void Repeticao_Medicao_Process(void);
+
+void Repeticao_Medicao_Cancelar(void);
+void Repeticao_Medicao_Get_Status(Repet_Status_t* status);
+
+#endif // REPETICAO_MEDICAO_H
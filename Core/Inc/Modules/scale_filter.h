@@ -2,9 +2,11 @@
 #define SCALE_FILTER_H
 
 #include <stdint.h>
+#include "scale_fixed.h" // SCALE_FIXED_POINT: escolhe o caminho inteiro ou float
 
 #ifndef SCALE_FILTER_WIN_SIZE
 // por padro usa 64 amostras; voc pode #define SCALE_FILTER_WIN_SIZE antes do include
+// (o custo do Push  constante, ento janelas de 256+ so viveis a 80 SPS)
 #define SCALE_FILTER_WIN_SIZE 64
 #endif
 
@@ -13,12 +15,21 @@ extern "C" {
 #endif
 
 typedef struct {
+#if SCALE_FIXED_POINT
+    int32_t avg_counts;
+    int32_t avg_mg;
+    int32_t sigma_counts_q8; // desvio padro em counts (Q8)
+    int32_t sigma_ug;        // desvio padro em g
+    int32_t slope_counts_q8; // inclinao em counts/amostra (Q8)
+    int32_t slope_ug;        // inclinao em g/amostra
+#else
     float avg_counts;
     float avg_grams;
     float sigma_counts;
     float sigma_grams;
     float slope_counts;
     float slope_grams;
+#endif
     uint8_t is_stable;      // 1 se sigma/slope em gramas estiverem abaixo dos limiares
     uint8_t step_detected;  // 1 se houve degrau > limiar (em g) entre mdias consecutivas
 } ScaleFilterOut;
@@ -26,16 +37,32 @@ typedef struct {
 typedef struct {
     // buffer e ndices
     int32_t buffer[SCALE_FILTER_WIN_SIZE];
-    int     idx;
+    uint16_t idx;
     uint8_t filled;
 
+    // somas incrementais (inteiras, sem deriva) de d = y - ref, com i = 0 na amostra mais antiga
+    int32_t ref;      // referncia em counts (acompanha a mdia)
+    int64_t sum_d;    // soma(d)
+    int64_t sum_d2;   // soma(d^2)
+    int64_t sum_id;   // soma(i*d)
+
     // limiares
+#if SCALE_FIXED_POINT
+    int32_t stability_sigma_ug;
+    int32_t stability_slope_ug;
+    int32_t step_threshold_mg;
+#else
     float stability_sigma_g;
     float stability_slope_g;
     float step_threshold_g;
+#endif
 
     // memria para deteco de degrau
+#if SCALE_FIXED_POINT
+    int32_t prev_avg_mg;
+#else
     float  prev_avg_g;
+#endif
     uint8_t first_avg;
 } ScaleFilter;
 
@@ -54,6 +81,150 @@ void ScaleFilter_SetThresholds(ScaleFilter* sf,
 // insere uma nova amostra (em counts) e retorna mtricas em "out"
 void ScaleFilter_Push(ScaleFilter* sf, int32_t new_counts, ScaleFilterOut* out);
 
+//==============================================================================
+// Estabilidade simples: N leituras seguidas dentro de +-limiar da referncia
+//==============================================================================
+
+typedef struct {
+#if SCALE_FIXED_POINT
+    int32_t ref_mg;
+    int32_t threshold_mg;
+#else
+    float   ref_g;
+    float   threshold_g;
+#endif
+    uint8_t count;
+    uint8_t target;
+} ScaleStability;
+
+void ScaleStability_Init(ScaleStability* st, float threshold_g, uint8_t target);
+
+#if SCALE_FIXED_POINT
+uint8_t ScaleStability_Push(ScaleStability* st, int32_t new_mg);
+#else
+uint8_t ScaleStability_Push(ScaleStability* st, float new_grams);
+#endif
+
+//==============================================================================
+// Mediana deslizante incremental (janela ordenada mantida entre as amostras)
+//==============================================================================
+
+#define SF_MEDIAN_WIN_MIN     5    // abaixo disso no rejeita rajadas de 2 amostras
+#define SF_MEDIAN_WIN_MAX     31   // janela mxima da mediana (mpar)
+
+typedef struct {
+    int32_t ring[SF_MEDIAN_WIN_MAX];    // ordem de chegada (para saber quem sai)
+    int32_t sorted[SF_MEDIAN_WIN_MAX];  // mesma janela, em ordem crescente
+    uint8_t window;
+    uint8_t count;                      // amostras vlidas (a janela enche de novo aps um Reset)
+    uint8_t idx;                        // prxima posio do ring
+} ScaleMedian;
+
+// janela mpar entre SF_MEDIAN_WIN_MIN e SF_MEDIAN_WIN_MAX (valores fora so ajustados)
+void ScaleMedian_Init(ScaleMedian* m, uint8_t window);
+
+// esvazia a janela e recomea a partir de 'counts'
+void ScaleMedian_Reset(ScaleMedian* m, int32_t counts);
+
+// insere uma amostra e devolve a mediana da janela atual
+int32_t ScaleMedian_Push(ScaleMedian* m, int32_t new_counts);
+
+//==============================================================================
+// Cadeia de filtros configurvel (estgios em srie sobre as contagens brutas)
+//==============================================================================
+
+#define SF_CHAIN_MAX_STAGES   3
+#define SF_STAGE_WIN_MAX      32   // janela mxima da mdia mvel
+#define SF_STEP_CONFIRM       2    // amostras seguidas fora do limiar para confirmar o degrau
+
+typedef enum {
+    SF_STAGE_NONE = 0,
+    SF_STAGE_MOVING_AVG,   // janela = amostras
+    SF_STAGE_MEDIAN,       // janela = amostras (mpar, SF_MEDIAN_WIN_MIN..SF_MEDIAN_WIN_MAX)
+    SF_STAGE_EMA,          // param_a = alfa em Q16 (1..65535)
+    SF_STAGE_KALMAN        // param_a = rudo de processo Q (counts, Q8); param_b = rudo de medida R (counts)
+} ScaleFilterStageType;
+
+typedef struct {
+    uint8_t  type;         // ScaleFilterStageType
+    uint8_t  window;
+    uint16_t param_a;
+    uint16_t param_b;
+} ScaleFilterStageCfg;
+
+typedef struct {
+    ScaleFilterStageCfg cfg;
+    union {
+        ScaleMedian median;                // SF_STAGE_MEDIAN
+        struct {
+            int32_t buffer[SF_STAGE_WIN_MAX];
+            uint8_t idx;
+            uint8_t count;                 // amostras vlidas (cresce de novo aps um flush)
+            int64_t acc;                   // mdia mvel: soma; EMA/Kalman: estado em Q16
+            int64_t p_q16;                 // Kalman: covarincia do erro (counts, Q16)
+        } lin;                             // mdia mvel, EMA e Kalman
+    } u;
+} ScaleFilterStage;
+
+typedef struct {
+    ScaleFilterStage stages[SF_CHAIN_MAX_STAGES];
+    uint8_t  n_stages;
+    int32_t  step_threshold_mg;
+    int32_t  last_out;     // ltima sada (counts)
+    int32_t  last_out_mg;
+    uint8_t  step_count;   // amostras consecutivas alm do limiar de degrau
+    uint8_t  primed;
+} ScaleFilterChain;
+
+// monta a cadeia; estgios invlidos so ignorados (cadeia vazia = passa direto)
+void ScaleFilterChain_Init(ScaleFilterChain* ch, const ScaleFilterStageCfg* cfg, uint8_t n,
+                           int32_t step_threshold_mg);
+
+// esvazia o histrico de todos os estgios e recomea a partir de 'counts'
+void ScaleFilterChain_Flush(ScaleFilterChain* ch, int32_t counts);
+
+// filtra uma amostra; 'step_detected' (opcional) indica que o histrico foi descartado
+int32_t ScaleFilterChain_Push(ScaleFilterChain* ch, int32_t new_counts, uint8_t* step_detected);
+
+//==============================================================================
+// Previso do peso assentado: modelo de 2a ordem sobre as diferenas
+//   d[k] = a1*d[k-1] + a2*d[k-2]   (d[k] = y[k] - y[k-1])
+// ajustado por mnimos quadrados na janela. Cobre o decaimento exponencial
+// (polos reais) e a oscilao amortecida do prato (polos complexos); o peso
+// final  y[k] + a soma fechada das diferenas futuras.
+//==============================================================================
+
+#define SF_SETTLE_WIN_MIN     8
+#define SF_SETTLE_WIN_MAX     32
+#define SF_SETTLE_CONFIRM     4     // previses seguidas usadas na incerteza (400 ms a 10 SPS)
+#define SF_SETTLE_MARGIN_Q16  3277  // 1 - a1 - a2 >= 0.05: polo em 1 = sem ponto final
+#define SF_SETTLE_TAIL_DIV    16    // frao da cauda extrapolada somada  incerteza
+
+typedef struct {
+    int32_t  ring[SF_SETTLE_WIN_MAX];
+    uint8_t  window;
+    uint8_t  idx;
+    uint8_t  count;
+    int32_t  bound_max_mg;               // incerteza mxima para declarar convergncia
+    int32_t  preds[SF_SETTLE_CONFIRM];   // ltimas previses (para a disperso)
+    uint8_t  n_preds;
+    int32_t  a1_q16;                     // coeficientes do ltimo ajuste
+    int32_t  a2_q16;
+    int32_t  pred_mg;                    // peso final previsto
+    int32_t  bound_mg;                   // incerteza (+-) da previso
+    uint8_t  converged;
+} ScaleSettle;
+
+// janela (em amostras) entre SF_SETTLE_WIN_MIN e SF_SETTLE_WIN_MAX; o ajuste comea
+// com SF_SETTLE_WIN_MIN amostras e a janela cresce at 'window'
+void ScaleSettle_Init(ScaleSettle* s, uint8_t window, int32_t bound_max_mg);
+
+// descarta o histrico (degrau, movimento dos servos)
+void ScaleSettle_Reset(ScaleSettle* s);
+
+// entrega uma amostra j filtrada (mg); retorna 1 enquanto a previso estiver convergida
+uint8_t ScaleSettle_Push(ScaleSettle* s, int32_t new_mg);
+
 #ifdef __cplusplus
 }
 #endif
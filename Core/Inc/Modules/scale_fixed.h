@@ -0,0 +1,56 @@
+/*******************************************************************************
+ * @file        scale_fixed.h
+ * @brief       Aritmtica de ponto fixo da cadeia de pesagem (Cortex-M0+ sem FPU)
+ * @details     Chave de compilao SCALE_FIXED_POINT:
+ * 1 = counts -> mg s com inteiros (tara, calibrao, filtro e estabilidade).
+ * 0 = caminho original em float (mantido como referncia).
+ * Pode ser sobrescrita pelas Defines do projeto (ex.: SCALE_FIXED_POINT=0).
+ ******************************************************************************/
+
+#ifndef SCALE_FIXED_H
+#define SCALE_FIXED_H
+
+#include <stdint.h>
+
+#ifndef SCALE_FIXED_POINT
+#define SCALE_FIXED_POINT 1
+#endif
+
+// Inclinao da curva de calibrao: mg/count em Q24 (~0.16 mg/count -> ~2.7e6)
+#define SCALE_Q_SLOPE      24
+#define SCALE_Q_SLOPE_HALF (1L << (SCALE_Q_SLOPE - 1))
+
+/**
+ * @brief Raiz quadrada inteira (piso) de 64 bits, bit a bit (sem divises).
+ */
+static inline uint32_t Scale_Isqrt64(uint64_t v)
+{
+    uint64_t res = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (v >= res + bit) {
+            v  -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)res;
+}
+
+/**
+ * @brief Multiplica 'x' por um fator Qn com arredondamento (meio para cima).
+ * O deslocamento  direita de negativos  aritmtico no armcc/armclang.
+ */
+static inline int32_t Scale_Mul_Q(int32_t x, int32_t fator_q, uint8_t q)
+{
+    int64_t p = (int64_t)x * fator_q;
+    return (int32_t)((p + (1LL << (q - 1))) >> q);
+}
+
+#endif // SCALE_FIXED_H
@@ -2,6 +2,58 @@
 #define SERVO_CONTROLE_H
 
 #include "main.h"
+#include "app_eventos.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SERVO_ANGULO_FECHADO        0     // Repouso: os dois servos voltam aqui no fim da sequncia
+#define SERVO_ANGULO_FUNIL_ABRE     75    // Padro. S para a sequncia de fbrica
+#define SERVO_ANGULO_SCRAP_ABRE     90    // Padro. S para a sequncia de fbrica
+#define SERVO_ANGULO_MAX            180
+
+// Servo movido por um passo da sequncia (Config_Passo_Servo_t.servo)
+typedef enum {
+    SERVO_SEQ_NENHUM,       // Passo s de espera
+    SERVO_SEQ_FUNIL,
+    SERVO_SEQ_RASPADOR
+} Servo_Seq_Alvo_t;
+
+// O que encerra um passo (Config_Passo_Servo_t.espera). Nas esperas por
+// condio, duracao_ms  o limite e minimo_ms o tempo antes da primeira
+// consulta. De SERVO_SEQ_PESO_ESTAVEL em diante a condio vem de quem
+// iniciou a sequncia (Funcao_Condicao_Seq_t) e o limite  obrigatrio
+typedef enum {
+    SERVO_SEQ_TEMPO,        // duracao_ms contados da entrada no passo (0: segue direto)
+    SERVO_SEQ_MOVIMENTO,    // Fim da rampa (limite opcional: 0 = sem limite)
+    SERVO_SEQ_PESO_ESTAVEL, // Fim da rampa e depois peso estvel
+    SERVO_SEQ_DOSAGEM,      // Dosagem prev o alvo (ou cmara cheia)
+    SERVO_SEQ_QUEDA,        // Massa em queda assentada
+    SERVO_SEQ_MEDICAO,      // Frequncia, peso e temperatura prontos
+    SERVO_SEQ_NUM_ESPERAS   // Sentinela
+} Servo_Seq_Espera_t;
+
+/**
+ * @brief Condio de um passo (esperas a partir de SERVO_SEQ_PESO_ESTAVEL).
+ * @return true quando o passo pode terminar.
+ */
+typedef bool (*Funcao_Condicao_Seq_t)(Servo_Seq_Espera_t espera);
+
+// Passo que terminou em Servos_Sequence_Process()
+typedef struct {
+    Servo_Seq_Espera_t espera;  // Condio do passo que terminou
+    bool por_limite;            // Terminou pelo limite (duracao_ms), sem a condio
+    bool fim;                   // Era o ltimo: a sequncia acabou e os servos fecham
+} Servo_Seq_Transicao_t;
+
+typedef struct {
+    bool     ativa;
+    uint8_t  indice;            // Passo em execuo
+    uint8_t  total;             // Passos carregados na partida
+    Servo_Seq_Alvo_t servo;     // Servo movido pelo passo em execuo
+    Servo_Seq_Espera_t espera;  // Condio do passo em execuo
+    uint8_t  limites_esgotados; // Na execuo atual (ou na ltima)
+    uint32_t execucoes;         // Sequncias concludas desde o boot
+} Servo_Seq_Status_t;
 
 /**
  * @brief Inicializa o mdulo de controle dos servos.
@@ -9,20 +61,48 @@
 void Servos_Init(void);
 
 /**
- * @brief Processa a mquina de estados e atualiza a posio dos servos.
+ * @brief Entrega ao driver a posio pedida para cada servo.
  * Deve ser chamada repetidamente no loop principal.
  */
 void Servos_Process(void);
 
 /**
- * @brief Inicia a sequncia de movimento dos servos.
+ * @brief Inicia a sequncia de passos da configurao
+ * (Gerenciador_Config_Get_Sequencia_Servos), copiada nesta chamada: uma
+ * alterao vale a partir da prxima partida.
+ * @param condicao Avalia as esperas por condio (NULL: terminam pelo limite).
+ * @return false se j houver sequncia rodando.
+ */
+bool Servos_Start_Sequence(Funcao_Condicao_Seq_t condicao);
+
+/**
+ * @brief Avana a sequncia: confere a espera do passo atual e entra no
+ * prximo (ou encerra). Chamada por quem iniciou a sequncia (ciclo_medicao),
+ * no contexto dele; a condio  consultada aqui.
+ * @param transicao Preenchida quando um passo termina.
+ * @return true se um passo terminou nesta chamada.
+ */
+bool Servos_Sequence_Process(Servo_Seq_Transicao_t* transicao);
+
+/**
+ * @brief Registra quem recebe EV_SERVOS_SEQUENCE_STEP_CHANGED e
+ * EV_SERVOS_SEQUENCE_FINISHED (payload ServoSeqPayload_t, vlido s durante
+ * a chamada). Chamado no contexto de Servos_Start_Sequence() /
+ * Servos_Sequence_Process(). NULL desliga.
+ */
+void Servos_Registrar_Handler_Evento(Funcao_Handler_Evento_t handler);
+
+void Servos_Get_Status_Sequencia(Servo_Seq_Status_t* status);
+
+/**
+ * @brief true durante um movimento (rampa no DMA ou mudana ainda no iniciada).
  */
-void Servos_Start_Sequence(void);
+bool Servos_Em_Movimento(void);
 
 /**
- * @brief Decrementa os temporizadores internos de controle dos servos.
- * Esta funo DEVE ser chamada a cada 1ms por uma interrupo de timer (ex: SysTick).
+ * @brief true se o Servos_Process() tem trabalho: alvo de algum servo ainda
+ * no entregue ao driver.
  */
-void Servos_Tick_ms(void);
+bool Servos_Pendente(void);
 
 #endif // SERVO_CONTROLE_H
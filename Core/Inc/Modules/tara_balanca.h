@@ -0,0 +1,47 @@
+#ifndef TARA_BALANCA_H
+#define TARA_BALANCA_H
+
+#include "main.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    TARA_OCIOSA,
+    TARA_COLETANDO,     // Consumindo amostras do fluxo normal de aquisio
+    TARA_CONCLUIDA,     // ltimo pedido terminou com sucesso
+    TARA_FALHOU         // Balana no estabilizou; offset anterior mantido
+} Tara_Estado_t;
+
+typedef struct {
+    Tara_Estado_t estado;
+    uint8_t  progresso_pct;      // 0..100 dentro da tentativa atual
+    uint8_t  tentativa;          // 1..TARA_MAX_TENTATIVAS
+    int32_t  offset;             // Offset atual do ADS1232 (counts)
+    bool     auto_zero_ativo;
+    int32_t  auto_zero_correcao; // Correo acumulada pelo auto-zero desde a ltima tara (counts)
+    uint32_t auto_zero_ajustes;  // Quantos passos de correo foram aplicados
+} Tara_Status_t;
+
+/**
+ * @brief Inicializa a FSM de tara e o rastreador de auto-zero.
+ */
+void Tara_Balanca_Init(void);
+
+/**
+ * @brief Pede uma nova tara. Retorna imediatamente; o resultado sai no status.
+ */
+void Tara_Balanca_Solicitar(void);
+
+/**
+ * @brief Entrega uma leitura (mediana) ao motor de tara/auto-zero.
+ * @param raw Contagem bruta filtrada do ADS1232.
+ * @param peso_mg Peso lquido correspondente (para a janela do auto-zero).
+ * @param estavel Resultado do teste de estabilidade da aplicao.
+ */
+void Tara_Balanca_Nova_Amostra(int32_t raw, int32_t peso_mg, bool estavel);
+
+bool Tara_Balanca_Em_Andamento(void);
+void Tara_Balanca_Set_Auto_Zero(bool ativo);
+void Tara_Balanca_Get_Status(Tara_Status_t* status);
+
+#endif // TARA_BALANCA_H
@@ -55,6 +55,7 @@ void EXTI4_15_IRQHandler(void);
 void DMA1_Channel1_IRQHandler(void);
 void DMA1_Channel2_3_IRQHandler(void);
 void DMAMUX1_DMA1_CH4_5_IRQHandler(void);
+void TIM3_IRQHandler(void);
 void TIM14_IRQHandler(void);
 void USART1_IRQHandler(void);
 void USART2_IRQHandler(void);
@@ -0,0 +1,462 @@
+/*******************************************************************************
+ * @file        agendador.c
+ * @brief       Agendador cooperativo do superloop (perodos, eventos, prioridades).
+ * @version     1.1
+ * @details     Cada tarefa  peridica (liberao a cada N ms, sem deriva),
+ * peridica condicional (s enquanto 'ativa') ou por evento (consulta 'pronto'
+ * ou Agendador_Sinalizar()). A cada passagem, as tarefas vencidas rodam uma
+ * vez, em ordem de prioridade. Para cada uma so medidos durao (ltima,
+ * mdia, pior), atraso de incio e perdas de prazo, na base de 1 us do TIM14
+ * (incio do perodo + CNT).
+ * Sem tarefa vencida, a CPU dorme no __WFI(). O TIM14  o nico tick (tambm
+ * do HAL_GetTick(); o SysTick fica suspenso). Se o prximo prazo estiver a
+ * AGENDADOR_SONO_MIN_MS ou mais, o perodo do TIM14  esticado at ele (sono
+ * sem tick); as IRQs dos perifricos acordam antes. Ao acordar, ainda com as
+ * IRQs mascaradas, os ms dormidos so contabilizados (uwTick e ganchos) e o
+ * perodo volta a 1 ms na prxima fronteira de ms, sem perder a fase.
+ * A consulta final e o __WFI() rodam com PRIMASK: uma IRQ nesse intervalo
+ * fica pendente e faz o __WFI() voltar na hora (nenhum evento espera o prazo).
+ ******************************************************************************/
+
+#include "agendador.h"
+#include <stddef.h>
+#include <string.h>
+
+//================================================================================
+// Definies
+//================================================================================
+
+#define AGENDADOR_US_POR_TICK   1000u   // TIM14: 1 MHz, ARR 999
+#define AGENDADOR_MARGEM_ARR_US 20u     // Folga para reprogramar o ARR antes de o CNT chegar l
+
+typedef struct {
+    const char*            nome;
+    Agendador_Funcao_t     funcao;
+    Agendador_Pronto_t     pronto;
+    Agendador_Prioridade_t prioridade;
+    uint32_t               periodo_us;      // 0: por evento
+    uint32_t               prazo_us;
+    uint32_t               proxima_us;      // Prxima liberao (peridicas)
+    bool                   dormente;        // Condicional com 'ativa' falso
+    volatile bool          sinalizada;
+    volatile uint32_t      sinal_us;        // Instante do Agendador_Sinalizar()
+    // Estatsticas
+    uint32_t               execucoes;
+    uint32_t               perdas_prazo;
+    uint32_t               ultimo_us;
+    uint32_t               pior_us;
+    uint64_t               total_us;
+    uint32_t               latencia_max_us;
+} Tarefa_t;
+
+//================================================================================
+// Variveis Estticas
+//================================================================================
+
+static Tarefa_t s_tarefas[AGENDADOR_MAX_TAREFAS];
+static uint8_t  s_ordem[AGENDADOR_MAX_TAREFAS];   // Ids por prioridade (estvel)
+static uint8_t  s_num_tarefas = 0;
+
+static volatile uint32_t s_base_us = 0;           // Agendador_Micros() no incio do perodo do TIM14
+static volatile uint32_t s_periodo_us = AGENDADOR_US_POR_TICK; // ARR + 1 (esticado no sono sem tick)
+static volatile uint32_t s_ms = 0;                // ms contabilizados (uwTick e ganchos)
+static Agendador_Funcao_t s_ticks[AGENDADOR_MAX_TICKS];
+static uint8_t s_num_ticks = 0;
+static volatile bool s_base_hal = false;          // uwTick j anda pelo TIM14
+
+static struct {
+    uint32_t inicio_ms;
+    uint64_t ocioso_us;
+    uint32_t passagens;
+    uint32_t dormidas;
+    uint32_t sonos_sem_tick;
+    uint32_t maior_sono_us;
+    uint32_t despertares_prazo;
+    uint32_t despertares_irq;
+    uint32_t latencia_despertar_max_us;
+    uint64_t latencia_despertar_total_us;
+} s_global;
+
+//================================================================================
+// Funes Privadas
+//================================================================================
+
+/**
+ * @brief Avana os ms contabilizados at 'agora_us' (fronteiras de ms do TIM14).
+ * Roda na ISR do TIM14 ou no lao com PRIMASK, nunca nos dois ao mesmo tempo.
+ */
+static void Contabilizar_ms(uint32_t agora_us)
+{
+    uint32_t novos = (agora_us - s_ms * AGENDADOR_US_POR_TICK) / AGENDADOR_US_POR_TICK;
+    while (novos-- > 0u) {
+        s_ms++;
+        if (s_base_hal) HAL_IncTick();
+        for (uint8_t i = 0; i < s_num_ticks; i++) {
+            s_ticks[i]();
+        }
+    }
+}
+
+/**
+ * @brief Passa o uwTick para o TIM14 (como o timebase por TIM do CubeMX): com
+ * o SysTick interrompendo a cada 1 ms no haveria sono sem tick.
+ */
+static void Assumir_Base_HAL(void)
+{
+    __disable_irq();
+    HAL_SuspendTick();
+    s_base_hal = true;
+    __enable_irq();
+}
+
+static uint8_t Registrar(const char* nome, Agendador_Funcao_t funcao, Agendador_Pronto_t pronto,
+                         uint32_t periodo_ms, uint32_t prazo_ms, Agendador_Prioridade_t prioridade)
+{
+    if (funcao == NULL || s_num_tarefas >= AGENDADOR_MAX_TAREFAS) {
+        return AGENDADOR_ID_INVALIDO;
+    }
+
+    uint8_t id = s_num_tarefas;
+    Tarefa_t* t = &s_tarefas[id];
+    memset(t, 0, sizeof(*t));
+    t->nome = nome;
+    t->funcao = funcao;
+    t->pronto = pronto;
+    t->prioridade = prioridade;
+    t->periodo_us = periodo_ms * AGENDADOR_US_POR_TICK;
+    t->prazo_us = prazo_ms * AGENDADOR_US_POR_TICK;
+    t->proxima_us = Agendador_Micros();
+
+    // Insero na ordem de execuo: depois das de mesma prioridade
+    uint8_t pos = s_num_tarefas;
+    while (pos > 0 && s_tarefas[s_ordem[pos - 1]].prioridade > prioridade) {
+        s_ordem[pos] = s_ordem[pos - 1];
+        pos--;
+    }
+    s_ordem[pos] = id;
+    s_num_tarefas++;
+    return id;
+}
+
+/**
+ * @brief Decide se a tarefa roda nesta passagem e devolve o instante da liberao.
+ */
+static bool Vencida(Tarefa_t* t, uint32_t agora_us, uint32_t* liberacao_us)
+{
+    if (t->periodo_us > 0) {
+        if (t->pronto != NULL) {
+            if (!t->pronto()) {
+                t->dormente = true;
+                return false;
+            }
+            if (t->dormente) {
+                // Acabou de ativar: libera agora, sem herdar o atraso da dormncia
+                t->dormente = false;
+                t->proxima_us = agora_us;
+            }
+        }
+        if ((int32_t)(agora_us - t->proxima_us) < 0) return false;
+        *liberacao_us = t->proxima_us;
+        return true;
+    }
+    if (t->sinalizada) {
+        t->sinalizada = false;
+        *liberacao_us = t->sinal_us;
+        return true;
+    }
+    if (t->pronto != NULL && t->pronto()) {
+        *liberacao_us = agora_us;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Consulta final antes do __WFI() (com PRIMASK, sem efeitos).
+ * @param prazo_us Sada: liberao peridica mais prxima (ou agora + SONO_MAX).
+ * @return true se alguma tarefa j pode rodar.
+ */
+static bool Algo_Pronto(uint32_t agora_us, uint32_t* prazo_us)
+{
+    uint32_t espera = AGENDADOR_SONO_MAX_MS * AGENDADOR_US_POR_TICK;
+
+    for (uint8_t i = 0; i < s_num_tarefas; i++) {
+        const Tarefa_t* t = &s_tarefas[i];
+        if (t->periodo_us == 0) {
+            if (t->sinalizada || (t->pronto != NULL && t->pronto())) return true;
+            continue;
+        }
+        if (t->pronto != NULL) {
+            if (!t->pronto()) continue;
+            if (t->dormente) return true;
+        }
+        int32_t falta = (int32_t)(t->proxima_us - agora_us);
+        if (falta <= 0) return true;
+        if ((uint32_t)falta < espera) espera = (uint32_t)falta;
+    }
+    *prazo_us = agora_us + espera;
+    return false;
+}
+
+/**
+ * @brief Estica o perodo atual do TIM14 at a fronteira de ms no (ou antes
+ * do) prazo. Com PRIMASK. Recusa se o update de 1 ms estiver em cima.
+ * @return true se o perodo foi esticado (sono sem tick).
+ */
+static bool Esticar_Periodo(uint32_t prazo_us)
+{
+    uint32_t cnt = TIM14->CNT;
+    if ((TIM14->SR & TIM_SR_UIF) != 0u || (cnt + AGENDADOR_MARGEM_ARR_US) >= s_periodo_us) {
+        return false;
+    }
+
+    uint32_t periodo = ((prazo_us - s_base_us) / AGENDADOR_US_POR_TICK) * AGENDADOR_US_POR_TICK;
+    if (periodo > AGENDADOR_SONO_MAX_MS * AGENDADOR_US_POR_TICK) {
+        periodo = AGENDADOR_SONO_MAX_MS * AGENDADOR_US_POR_TICK;
+    }
+    if (periodo < AGENDADOR_SONO_MIN_MS * AGENDADOR_US_POR_TICK) {
+        return false;
+    }
+    // Perodo j esticado e prazo na mesma fronteira (ou antes) do CNT: o ARR
+    // cairia abaixo do CNT e, com ARPE = 0, o update s viria no estouro em 0xFFFF
+    if (periodo <= cnt + AGENDADOR_MARGEM_ARR_US) {
+        return false;
+    }
+
+    TIM14->ARR = periodo - 1u;   // ARPE = 0: vale j para o perodo em curso
+    s_periodo_us = periodo;
+    s_global.sonos_sem_tick++;
+    if (periodo > s_global.maior_sono_us) s_global.maior_sono_us = periodo;
+    return true;
+}
+
+/**
+ * @brief Logo depois do __WFI() de um sono sem tick, ainda com PRIMASK.
+ * Pelo prazo: mede a latncia do despertar (CNT desde o update) e deixa a ISR
+ * do TIM14 contabilizar o perodo. Por outra IRQ: contabiliza os ms j
+ * passados e encerra o perodo na prxima fronteira de ms.
+ */
+static void Encerrar_Sono(void)
+{
+    uint32_t cnt = TIM14->CNT;
+    if ((TIM14->SR & TIM_SR_UIF) != 0u) {
+        uint32_t latencia = TIM14->CNT; // Lido de novo: o update pode ter vindo depois do 1 CNT
+        s_global.despertares_prazo++;
+        s_global.latencia_despertar_total_us += latencia;
+        if (latencia > s_global.latencia_despertar_max_us) s_global.latencia_despertar_max_us = latencia;
+        return;
+    }
+
+    s_global.despertares_irq++;
+    uint32_t fronteira = (cnt / AGENDADOR_US_POR_TICK + 1u) * AGENDADOR_US_POR_TICK;
+    if ((fronteira - cnt) < AGENDADOR_MARGEM_ARR_US) {
+        fronteira += AGENDADOR_US_POR_TICK;
+    }
+    if (fronteira < s_periodo_us) {
+        TIM14->ARR = fronteira - 1u;
+        s_periodo_us = fronteira;
+    }
+    Contabilizar_ms(s_base_us + cnt);
+}
+
+static void Dormir(void)
+{
+    uint32_t prazo_us;
+
+    __disable_irq(); // IRQ que chegar daqui em diante fica pendente e acorda o __WFI()
+    uint32_t antes = Agendador_Micros();
+    if (Algo_Pronto(antes, &prazo_us)) {
+        __enable_irq();
+        return;
+    }
+
+    bool sem_tick = Esticar_Periodo(prazo_us);
+    __WFI();
+    if (sem_tick) {
+        Encerrar_Sono();
+    }
+    uint32_t depois = Agendador_Micros();
+    __enable_irq(); // A ISR que acordou a CPU roda aqui, j com o tempo em dia
+
+    s_global.ocioso_us += depois - antes;
+    s_global.dormidas++;
+}
+
+static void Executar_Tarefa(Tarefa_t* t, uint32_t liberacao_us)
+{
+    uint32_t inicio = Agendador_Micros();
+    t->funcao();
+    uint32_t fim = Agendador_Micros();
+
+    uint32_t duracao = fim - inicio;
+    uint32_t latencia = inicio - liberacao_us;
+    t->execucoes++;
+    t->ultimo_us = duracao;
+    t->total_us += duracao;
+    if (duracao > t->pior_us) t->pior_us = duracao;
+    if (latencia > t->latencia_max_us) t->latencia_max_us = latencia;
+    if (t->prazo_us > 0 && (fim - liberacao_us) > t->prazo_us) t->perdas_prazo++;
+
+    if (t->periodo_us > 0) {
+        // Sem deriva; se ficou um perodo inteiro para trs, pula as liberaes perdidas
+        t->proxima_us += t->periodo_us;
+        if ((int32_t)(fim - t->proxima_us) >= 0) {
+            uint32_t atraso = fim - t->proxima_us;
+            t->proxima_us += (atraso / t->periodo_us + 1u) * t->periodo_us;
+        }
+    }
+}
+
+//================================================================================
+// Funes Pblicas
+//================================================================================
+
+void Agendador_Init(void)
+{
+    memset(s_tarefas, 0, sizeof(s_tarefas));
+    s_num_tarefas = 0;
+    s_num_ticks = 0;
+    Agendador_Zerar_Stats();
+}
+
+uint8_t Agendador_Registrar_Periodica(const char* nome, Agendador_Funcao_t funcao,
+                                      uint32_t periodo_ms, Agendador_Prioridade_t prioridade)
+{
+    if (periodo_ms == 0) return AGENDADOR_ID_INVALIDO;
+    return Registrar(nome, funcao, NULL, periodo_ms, periodo_ms, prioridade);
+}
+
+uint8_t Agendador_Registrar_Periodica_Condicional(const char* nome, Agendador_Funcao_t funcao,
+                                                  Agendador_Pronto_t ativa, uint32_t periodo_ms,
+                                                  Agendador_Prioridade_t prioridade)
+{
+    if (periodo_ms == 0 || ativa == NULL) return AGENDADOR_ID_INVALIDO;
+    return Registrar(nome, funcao, ativa, periodo_ms, periodo_ms, prioridade);
+}
+
+uint8_t Agendador_Registrar_Evento(const char* nome, Agendador_Funcao_t funcao, Agendador_Pronto_t pronto,
+                                   uint32_t prazo_ms, Agendador_Prioridade_t prioridade)
+{
+    return Registrar(nome, funcao, pronto, 0, prazo_ms, prioridade);
+}
+
+void Agendador_Sinalizar(uint8_t id)
+{
+    if (id >= s_num_tarefas || s_tarefas[id].periodo_us > 0) return;
+    s_tarefas[id].sinal_us = Agendador_Micros();
+    s_tarefas[id].sinalizada = true;
+}
+
+bool Agendador_Registrar_Tick(Agendador_Funcao_t funcao)
+{
+    if (funcao == NULL || s_num_ticks >= AGENDADOR_MAX_TICKS) return false;
+    s_ticks[s_num_ticks++] = funcao;
+    return true;
+}
+
+void Agendador_Executar(void)
+{
+    bool executou = false;
+    if (!s_base_hal) {
+        Assumir_Base_HAL(); // O TIM14 j roda (main.c inicia depois do App_Manager_Init)
+    }
+    s_global.passagens++;
+
+    for (uint8_t k = 0; k < s_num_tarefas; k++) {
+        Tarefa_t* t = &s_tarefas[s_ordem[k]];
+        uint32_t liberacao_us;
+        if (Vencida(t, Agendador_Micros(), &liberacao_us)) {
+            Executar_Tarefa(t, liberacao_us);
+            executou = true;
+        }
+    }
+
+    if (!executou) {
+        Dormir();
+    }
+}
+
+uint32_t Agendador_Micros(void)
+{
+    uint32_t base;
+    uint32_t periodo;
+    uint32_t cnt;
+    do {
+        base = s_base_us;
+        periodo = s_periodo_us;
+        cnt = TIM14->CNT;
+    } while (base != s_base_us);
+
+    // Update ainda no atendido (chamada com a IRQ do TIM14 pendente ou mascarada)
+    if ((TIM14->SR & TIM_SR_UIF) != 0u && cnt < (periodo / 2u)) {
+        cnt += periodo;
+    }
+    return base + cnt;
+}
+
+void Agendador_TIM14_Update(void)
+{
+    s_base_us += s_periodo_us;
+    if (s_periodo_us != AGENDADOR_US_POR_TICK) {
+        TIM14->ARR = AGENDADOR_US_POR_TICK - 1u; // CNT acabou de zerar: volta ao tick de 1 ms
+        s_periodo_us = AGENDADOR_US_POR_TICK;
+    }
+    Contabilizar_ms(s_base_us);
+}
+
+uint8_t Agendador_Get_Num_Tarefas(void)
+{
+    return s_num_tarefas;
+}
+
+/**
+ * @brief Estatsticas na ordem de execuo (ndice 0 = maior prioridade).
+ */
+bool Agendador_Get_Stats_Tarefa(uint8_t indice, Agendador_Stats_Tarefa_t* stats)
+{
+    if (indice >= s_num_tarefas || stats == NULL) return false;
+
+    const Tarefa_t* t = &s_tarefas[s_ordem[indice]];
+    stats->nome = t->nome;
+    stats->prioridade = t->prioridade;
+    stats->periodo_ms = t->periodo_us / AGENDADOR_US_POR_TICK;
+    stats->prazo_us = t->prazo_us;
+    stats->execucoes = t->execucoes;
+    stats->perdas_prazo = t->perdas_prazo;
+    stats->ultimo_us = t->ultimo_us;
+    stats->pior_us = t->pior_us;
+    stats->medio_us = (t->execucoes > 0) ? (uint32_t)(t->total_us / t->execucoes) : 0u;
+    stats->latencia_max_us = t->latencia_max_us;
+    return true;
+}
+
+void Agendador_Get_Stats(Agendador_Stats_t* stats)
+{
+    if (stats == NULL) return;
+    stats->janela_ms = s_ms - s_global.inicio_ms;
+    stats->ocioso_ms = (uint32_t)(s_global.ocioso_us / AGENDADOR_US_POR_TICK);
+    stats->passagens = s_global.passagens;
+    stats->dormidas = s_global.dormidas;
+    stats->sonos_sem_tick = s_global.sonos_sem_tick;
+    stats->maior_sono_ms = s_global.maior_sono_us / AGENDADOR_US_POR_TICK;
+    stats->despertares_prazo = s_global.despertares_prazo;
+    stats->despertares_irq = s_global.despertares_irq;
+    stats->latencia_despertar_max_us = s_global.latencia_despertar_max_us;
+    stats->latencia_despertar_media_us = (s_global.despertares_prazo > 0) ?
+        (uint32_t)(s_global.latencia_despertar_total_us / s_global.despertares_prazo) : 0u;
+}
+
+void Agendador_Zerar_Stats(void)
+{
+    for (uint8_t i = 0; i < s_num_tarefas; i++) {
+        Tarefa_t* t = &s_tarefas[i];
+        t->execucoes = 0;
+        t->perdas_prazo = 0;
+        t->ultimo_us = 0;
+        t->pior_us = 0;
+        t->total_us = 0;
+        t->latencia_max_us = 0;
+    }
+    memset(&s_global, 0, sizeof(s_global));
+    s_global.inicio_ms = s_ms;
+}
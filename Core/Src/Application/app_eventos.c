@@ -0,0 +1,281 @@
+/*******************************************************************************
+ * @file        app_eventos.c
+ * @brief       Barramento de eventos: filas sem trava, payload fixo e assinantes.
+ * @version     1.0
+ * @details     Duas filas circulares de um produtor e um consumidor: uma para
+ * as ISRs e outra para o superloop (a escolha  pelo IPSR; s ISRs de
+ * EVENTOS_PRIORIDADE_ISR publicam, verificado pelo NVIC). Cada entrada
+ * carrega o prprio payload (at EVENTOS_PAYLOAD_MAX bytes, tamanho fixo por
+ * tipo), ento publicar no aloca nem espera. O produtor s escreve a
+ * 'cabeca' e o consumidor s a 'cauda'; o __DMB() garante que a entrada
+ * esteja completa antes de o ndice andar.
+ * Eventos_Despachar() roda como tarefa por evento do agendador e chama os
+ * assinantes de cada tipo. A latncia (publicao -> despacho)  medida com
+ * o Agendador_Micros().
+ ******************************************************************************/
+
+#include "app_eventos.h"
+#include "agendador.h"
+#include <stddef.h>
+#include <string.h>
+
+//================================================================================
+// Definies
+//================================================================================
+
+#define EVENTOS_MS_POR_TICK_1S  1000u
+
+_Static_assert((EVENTOS_TAM_FILA_ISR & (EVENTOS_TAM_FILA_ISR - 1)) == 0, "EVENTOS_TAM_FILA_ISR deve ser potencia de 2");
+_Static_assert((EVENTOS_TAM_FILA & (EVENTOS_TAM_FILA - 1)) == 0, "EVENTOS_TAM_FILA deve ser potencia de 2");
+_Static_assert(sizeof(StringPayload_t) <= EVENTOS_PAYLOAD_MAX, "payload maior que EVENTOS_PAYLOAD_MAX");
+_Static_assert(sizeof(DateTimePayload_t) <= EVENTOS_PAYLOAD_MAX, "payload maior que EVENTOS_PAYLOAD_MAX");
+_Static_assert(sizeof(ServoSeqPayload_t) <= EVENTOS_PAYLOAD_MAX, "payload maior que EVENTOS_PAYLOAD_MAX");
+
+typedef struct {
+    uint8_t  tipo;
+    uint8_t  tamanho;
+    uint16_t reservado;
+    uint32_t carimbo_us;                    // Agendador_Micros() da publicao
+    uint32_t payload[EVENTOS_PAYLOAD_MAX / 4u]; // uint32_t: alinhado para qualquer payload
+} Entrada_t;
+
+typedef struct {
+    Entrada_t*       entradas;
+    uint8_t          mascara;
+    volatile uint8_t cabeca;                // ndices livres (uint8_t d a volta sozinho)
+    volatile uint8_t cauda;
+    uint8_t          profundidade_max;
+    volatile uint32_t publicados;
+    volatile uint32_t descartados;
+} Fila_t;
+
+typedef struct {
+    Tipo_Evento_t           tipo;
+    Funcao_Handler_Evento_t handler;
+} Assinante_t;
+
+//================================================================================
+// Variveis Estticas
+//================================================================================
+
+static Entrada_t s_entradas_isr[EVENTOS_TAM_FILA_ISR];
+static Entrada_t s_entradas[EVENTOS_TAM_FILA];
+
+static Fila_t s_fila_isr = { s_entradas_isr, EVENTOS_TAM_FILA_ISR - 1u, 0, 0, 0, 0, 0 };
+static Fila_t s_fila     = { s_entradas, EVENTOS_TAM_FILA - 1u, 0, 0, 0, 0, 0 };
+
+static Assinante_t s_assinantes[EVENTOS_MAX_ASSINANTES];
+static uint8_t s_num_assinantes = 0;
+
+static uint16_t s_ms_tick_1s = 0;
+
+static struct {
+    uint32_t despachados;
+    uint32_t sem_assinante;
+    uint32_t fora_de_prioridade;
+    uint32_t latencia_ultima_us;
+    uint32_t latencia_max_us;
+    uint64_t latencia_total_us;
+} s_stats;
+
+//================================================================================
+// Funes Privadas
+//================================================================================
+
+/**
+ * @brief Tamanho do payload de cada tipo (0: evento sem dados).
+ */
+static uint8_t Tamanho_Payload(Tipo_Evento_t tipo)
+{
+    switch (tipo) {
+        case EV_UI_PASSWORD_ENTERED:
+        case EV_UI_NEW_PASSWORD_SET:          return (uint8_t)sizeof(StringPayload_t);
+        case EV_UI_DATETIME_ENTERED:          return (uint8_t)sizeof(DateTimePayload_t);
+        case EV_SERVOS_SEQUENCE_STEP_CHANGED:
+        case EV_SERVOS_SEQUENCE_FINISHED:     return (uint8_t)sizeof(ServoSeqPayload_t);
+        default:                              return 0u;
+    }
+}
+
+static uint8_t Profundidade(const Fila_t* fila)
+{
+    return (uint8_t)(fila->cabeca - fila->cauda);
+}
+
+/**
+ * @brief Lado do produtor: s escreve a entrada livre e a 'cabeca'.
+ */
+static bool Enfileirar(Fila_t* fila, Tipo_Evento_t tipo, const void* payload, uint8_t tamanho)
+{
+    uint8_t cabeca = fila->cabeca;
+    uint8_t ocupacao = (uint8_t)(cabeca - fila->cauda);
+    if (ocupacao > fila->mascara) {
+        fila->descartados++;
+        return false;
+    }
+
+    Entrada_t* e = &fila->entradas[cabeca & fila->mascara];
+    e->tipo = (uint8_t)tipo;
+    e->tamanho = tamanho;
+    e->carimbo_us = Agendador_Micros();
+    if (tamanho > 0u) {
+        memcpy(e->payload, payload, tamanho);
+    }
+
+    __DMB(); // Entrada completa antes de publicar o ndice
+    fila->cabeca = (uint8_t)(cabeca + 1u);
+
+    fila->publicados++;
+    if (ocupacao + 1u > fila->profundidade_max) {
+        fila->profundidade_max = (uint8_t)(ocupacao + 1u);
+    }
+    return true;
+}
+
+/**
+ * @brief Lado do consumidor: copia a entrada mais antiga e libera o espao.
+ */
+static bool Desenfileirar(Fila_t* fila, Entrada_t* saida)
+{
+    uint8_t cauda = fila->cauda;
+    if (cauda == fila->cabeca) return false;
+
+    __DMB(); // L a entrada s depois de ver a 'cabeca' nova
+    *saida = fila->entradas[cauda & fila->mascara];
+    __DMB(); // Cpia feita antes de devolver o espao ao produtor
+    fila->cauda = (uint8_t)(cauda + 1u);
+    return true;
+}
+
+static void Entregar(const Entrada_t* e)
+{
+    uint32_t latencia = Agendador_Micros() - e->carimbo_us;
+    s_stats.despachados++;
+    s_stats.latencia_ultima_us = latencia;
+    s_stats.latencia_total_us += latencia;
+    if (latencia > s_stats.latencia_max_us) s_stats.latencia_max_us = latencia;
+
+    // Cpia local: o handler pode publicar e a entrada j foi devolvida  fila
+    uint32_t payload[EVENTOS_PAYLOAD_MAX / 4u];
+    memcpy(payload, e->payload, sizeof(payload));
+    Evento_t evento = { .type = (Tipo_Evento_t)e->tipo, .payload = (e->tamanho > 0u) ? payload : NULL };
+
+    bool entregue = false;
+    for (uint8_t i = 0; i < s_num_assinantes; i++) {
+        if (s_assinantes[i].tipo == evento.type) {
+            s_assinantes[i].handler(evento);
+            entregue = true;
+        }
+    }
+    if (!entregue) s_stats.sem_assinante++;
+}
+
+static void Preencher_Stats_Fila(const Fila_t* fila, Eventos_Stats_Fila_t* saida)
+{
+    saida->profundidade = Profundidade(fila);
+    saida->profundidade_max = fila->profundidade_max;
+    saida->capacidade = (uint8_t)(fila->mascara + 1u);
+    saida->publicados = fila->publicados;
+    saida->descartados = fila->descartados;
+}
+
+static void Zerar_Stats_Fila(Fila_t* fila)
+{
+    fila->profundidade_max = Profundidade(fila);
+    fila->publicados = 0;
+    fila->descartados = 0;
+}
+
+//================================================================================
+// Funes Pblicas
+//================================================================================
+
+void Eventos_Init(void)
+{
+    s_fila_isr.cabeca = s_fila_isr.cauda = 0;
+    s_fila.cabeca = s_fila.cauda = 0;
+    memset(s_assinantes, 0, sizeof(s_assinantes));
+    s_num_assinantes = 0;
+    s_ms_tick_1s = 0;
+    Eventos_Zerar_Stats();
+}
+
+bool Eventos_Assinar(Tipo_Evento_t tipo, Funcao_Handler_Evento_t handler)
+{
+    if (handler == NULL || tipo == EV_NONE || tipo >= EV_NUM_TIPOS ||
+        s_num_assinantes >= EVENTOS_MAX_ASSINANTES) {
+        return false;
+    }
+    s_assinantes[s_num_assinantes].tipo = tipo;
+    s_assinantes[s_num_assinantes].handler = handler;
+    s_num_assinantes++;
+    return true;
+}
+
+bool Eventos_Publicar(Tipo_Evento_t tipo, const void* payload)
+{
+    uint8_t tamanho = Tamanho_Payload(tipo);
+    if (tipo == EV_NONE || tipo >= EV_NUM_TIPOS || (tamanho > 0u && payload == NULL)) {
+        return false;
+    }
+    uint32_t excecao = __get_IPSR();
+    if (excecao == 0u) {
+        return Enfileirar(&s_fila, tipo, payload, tamanho);
+    }
+    // Uma ISR de outra prioridade poderia interromper um produtor no meio da fila
+    if (NVIC_GetPriority((IRQn_Type)((int32_t)excecao - 16)) != EVENTOS_PRIORIDADE_ISR) {
+        s_stats.fora_de_prioridade++;
+        return false;
+    }
+    return Enfileirar(&s_fila_isr, tipo, payload, tamanho);
+}
+
+void Eventos_Publicar_Evento(Evento_t evento)
+{
+    (void)Eventos_Publicar(evento.type, evento.payload);
+}
+
+void Eventos_Despachar(void)
+{
+    Entrada_t e;
+    for (uint8_t n = 0; n < EVENTOS_MAX_POR_DESPACHO; n++) {
+        if (!Desenfileirar(&s_fila_isr, &e) && !Desenfileirar(&s_fila, &e)) {
+            return;
+        }
+        Entregar(&e);
+    }
+}
+
+bool Eventos_Pendente(void)
+{
+    return (s_fila_isr.cabeca != s_fila_isr.cauda) || (s_fila.cabeca != s_fila.cauda);
+}
+
+void Eventos_Tick_1ms(void)
+{
+    if (++s_ms_tick_1s >= EVENTOS_MS_POR_TICK_1S) {
+        s_ms_tick_1s = 0;
+        (void)Eventos_Publicar(EV_SYSTEM_TICK_1S, NULL);
+    }
+}
+
+void Eventos_Get_Stats(Eventos_Stats_t* stats)
+{
+    if (stats == NULL) return;
+    Preencher_Stats_Fila(&s_fila_isr, &stats->isr);
+    Preencher_Stats_Fila(&s_fila, &stats->principal);
+    stats->despachados = s_stats.despachados;
+    stats->sem_assinante = s_stats.sem_assinante;
+    stats->fora_de_prioridade = s_stats.fora_de_prioridade;
+    stats->latencia_ultima_us = s_stats.latencia_ultima_us;
+    stats->latencia_max_us = s_stats.latencia_max_us;
+    stats->latencia_media_us = (s_stats.despachados > 0u) ?
+        (uint32_t)(s_stats.latencia_total_us / s_stats.despachados) : 0u;
+}
+
+void Eventos_Zerar_Stats(void)
+{
+    Zerar_Stats_Fila(&s_fila_isr);
+    Zerar_Stats_Fila(&s_fila);
+    memset(&s_stats, 0, sizeof(s_stats));
+}
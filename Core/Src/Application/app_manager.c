@@ -4,9 +4,19 @@
  * @version     8.6 (Refatorado por Dev STM)
  * @details     Implementa a proposta do usurio V8.6:
  * 1. Na tela do Monitor, a FSM roda a cada 1s.
- * 2. Freq/Reset so lidos a cada 1s (para clculo correto).
- * 3. A leitura bloqueante do ADC (Temp) s ocorre a cada 5s (via sub-contador),
- * enquanto Freq/Escala A so enviados a cada 1s.
+ * 2. A frequncia vem do medicao_frequencia, com janela prpria (independe do display).
+ * 3. A temperatura vem de converses do ADC em segundo plano (sem bloqueio),
+ * pedidas a cada 1s e pelo ciclo de medio.
+ * 4. O ciclo de medio (ciclo_medicao) roda a sequncia de passos dos servos
+ * da configurao, com as esperas e as aquisies pelos sensores;
+ * o repeticao_medicao encadeia NR_REPETICOES ciclos com estatstica corrente.
+ * 5. As tarefas so registradas no agendador com perodo (ou evento) e
+ * prioridade; o App_Manager_Process() s chama o agendador, que dorme no
+ * __WFI() quando nada est vencido. As de 1 ms so condicionais (dormem sem
+ * trabalho pendente), ento o agendador dorme sem tick at o prximo prazo.
+ * 6. Pedidos da UI (controller), eventos da sequncia dos servos e o tick de
+ * 1 s do TIM14 passam pelo barramento app_eventos, despachado pela tarefa
+ * "eventos" assim que algo  publicado.
  ******************************************************************************/
 
 #include "app_manager.h"
@@ -15,13 +25,22 @@
 #include "controller.h" // (V8.3) Para GetCurrentScreen
 #include "servo_controle.h"
 #include "ads1232_driver.h"
-#include "pcb_frequency.h"
+#include "medicao_frequencia.h"
+#include "calculo_umidade.h"
+#include "ciclo_medicao.h"
+#include "repeticao_medicao.h"
 #include "temp_sensor.h"
 #include "gerenciador_configuracoes.h"
+#include "calibracao_balanca.h"
+#include "tara_balanca.h"
+#include "scale_filter.h"
+#include "agendador.h"
+#include "app_eventos.h"
 #include <stdio.h>
 #include <string.h>
 #include <math.h>   
 #include <stdbool.h>
+#include <stdlib.h>
 
 //================================================================================
 // Variveis de Estado Globais do Mdulo
@@ -31,7 +50,39 @@ static App_ScaleData_t s_scale_output;
 static FreqData_t s_freq_data;
 static float s_temperatura_mcu = 0.0f;
 
-extern volatile bool g_ads_data_ready; 
+// Converso de temperatura em segundo plano (o ciclo de medio pede as suas  parte)
+#define TEMP_INTERVALO_CONVERSAO_MS 1000
+
+// Perodos das tarefas agendadas (ms)
+#define PERIODO_RAPIDO_MS       1     // Acorda junto com o TIM14
+#define PERIODO_FREQ_MS         5     // Janela mnima do pcb_frequency: 50 ms
+#define PERIODO_TEMP_MS         5
+#define PERIODO_CALIBRACAO_MS   10
+#define PERIODO_DISPLAY_MS      1000
+#define PRAZO_EVENTOS_MS        5
+#define PRAZO_CLI_MS            50
+
+// Mediana deslizante (largura configurvel) sobre as amostras consecutivas do ring do ADS1232
+#define SCALE_BATCH_MAX 8
+static ScaleMedian s_mediana;
+
+// Cadeia de filtros configurvel (aps a mediana), montada a partir da configurao
+static ScaleFilterChain s_filtro_cadeia;
+
+// Critrio da UI: 3 leituras seguidas dentro de 0.05 g (mesma rotina do scale_replay)
+#define STABILITY_THRESHOLD_G  0.05f
+#define STABLE_COUNT_TARGET    3
+static ScaleStability s_estabilidade;
+
+// Previso do peso assentado: 1.6 s a 10 SPS, mesmo limite da estabilidade
+#define PREVISAO_JANELA_AMOSTRAS 16
+#define PREVISAO_INCERTEZA_MG    50
+static ScaleSettle s_previsao;
+static Ciclo_Fase_t s_previsao_fase = CICLO_OCIOSO;
+
+// Captura de amostras brutas para anlise offline (Tools/scale_replay)
+static uint32_t s_captura_restantes = 0;
+static Ciclo_Fase_t s_captura_fase = CICLO_OCIOSO;
 
 //================================================================================
 // Definies da FSM de Atualizao do Display
@@ -42,18 +93,33 @@ typedef enum {
 } TaskDisplay_State_t;
 
 static TaskDisplay_State_t s_display_state = TASK_DISPLAY_IDLE;
-static uint32_t s_display_last_tick = 0;
-static const uint32_t DISPLAY_UPDATE_INTERVAL_MS = 1000;
-static uint8_t s_display_temp_counter = 0; // (V8.5) Sub-contador para coleta de dados bloqueante
 
 //================================================================================
 // Prottipos das Tarefas (Funes Privadas)
 //================================================================================
-static void Task_Handle_High_Frequency_Polling(void);
+static void Registrar_Tarefas(void);
+static void Task_Comunicacao(void);
+static bool Comunicacao_Pendente(void);
+static bool Ciclo_Pendente(void);
+static bool Balanca_Pendente(void);
+static void Task_Ciclo(void);
+static void Task_Handle_Frequency(void);
+static void Task_Handle_Temperature(void);
+static void Task_Pedir_Temperatura(void);
 static void Task_Handle_Scale(void); 
 static void Task_Update_Display_FSM(void);
-static float Calcular_Escala_A(uint32_t frequencia_hz);
+static void Atualizar_Previsao(bool reiniciar);
+static void Assinar_Eventos(void);
+static void On_Evento_Servos(Evento_t evento);
+static void On_Evento_UI(Evento_t evento);
+static void On_Evento_Tick_1s(Evento_t evento);
+#if SCALE_FIXED_POINT
+static int32_t Calcular_Escala_A_x10000(void);
+static bool Check_Stability(int32_t new_mg);
+#else
+static float Calcular_Escala_A(void);
 static bool Check_Stability(float new_grams); 
+#endif
 
 //================================================================================
 // Implementao da Funo de Inicializao
@@ -76,22 +142,36 @@ void App_Manager_Init(void)
         printf("[OK]\r\n");
     }
     
+    uint8_t grao_ativo = 0;
+    Gerenciador_Config_Get_Grao_Ativo(&grao_ativo);
+    Calculo_Umidade_Selecionar_Grao(grao_ativo);
+
     ADS1232_Init();
-    Frequency_Init(); // Usa TIM2 Counter Mode
+    Calibracao_Balanca_Init(); // Aplica os pontos de calibrao salvos na EEPROM
+    App_Manager_Aplicar_Filtro_Balanca();
+    ScaleStability_Init(&s_estabilidade, STABILITY_THRESHOLD_G, STABLE_COUNT_TARGET);
+    ScaleSettle_Init(&s_previsao, PREVISAO_JANELA_AMOSTRAS, PREVISAO_INCERTEZA_MG);
+    Medicao_Freq_Init(); // TIM2 + DMA1 canal 5 (recproco por padro)
+    Assinar_Eventos();
     Servos_Init();    // Usa TIM16/17 PWM
+    Servos_Registrar_Handler_Evento(Eventos_Publicar_Evento);
     printf("4. Modulos de Hardware (ADC, Servos, Frequencia)... OK\r\n");
     
-    printf("5. Executando tara da balanca (pode demorar alguns segundos)...\r\n");
-    ADS1232_Tare();
-    
+    // A tara roda em segundo plano com as amostras do ring (Task_Handle_Scale)
     memset(&s_scale_output, 0, sizeof(s_scale_output));
-    printf("   ... Tara concluida.\r\n");
+    Tara_Balanca_Init();
+    Tara_Balanca_Solicitar();
+    printf("5. Tara da balanca... Solicitada (segundo plano).\r\n");
     
     s_temperatura_mcu = TempSensor_GetTemperature(); // L uma vez no boot
     printf("Temperatura inicial: %.2f C\r\n", s_temperatura_mcu);
         
     DWIN_Driver_Init(&huart2, Controller_DwinCallback);
+    DWIN_Driver_WriteInt(NR_REPETICOES, Gerenciador_Config_Get_Repeticoes());
     printf("6. Interface de Usuario... Iniciando sequencia de splash.\r\n");
+
+    Registrar_Tarefas();
+    printf("7. Agendador... %u tarefas.\r\n", (unsigned)Agendador_Get_Num_Tarefas());
     printf("\r\n>>> INICIALIZACAO COMPLETA (V8.2 Robusta) <<<\r\n\r\n");
 }
 
@@ -100,75 +180,300 @@ void App_Manager_Init(void)
 //================================================================================
 void App_Manager_Process(void)
 {
-    // 1. Tarefas de alta frequncia
-    Task_Handle_High_Frequency_Polling();
-    
-    // 2. Tarefa da Balana
-    Task_Handle_Scale();
-    
-    // 3. FSM de Atualizao de Display (V8.6)
-    Task_Update_Display_FSM();
-    
-    // 4. Tarefa de atualizao do RTC (V8.3)
-    RTC_Driver_Process();
-    
-    // 5. FSM de Armazenamento
-    Gerenciador_Config_Run_FSM(); 
+    Agendador_Executar();
+}
+
+/**
+ * @brief Tabela de tarefas. Na mesma prioridade vale a ordem de registro:
+ * balana, frequncia e temperatura antes do ciclo, e o ciclo antes dos
+ * servos que ele comanda (mesma ordem do antigo superloop).
+ */
+static void Registrar_Tarefas(void)
+{
+    Agendador_Init();
+    Agendador_Registrar_Tick(Eventos_Tick_1ms);
+
+    // 0. Barramento de eventos (publicaes de ISR e da UI)
+    Agendador_Registrar_Evento("eventos", Eventos_Despachar, Eventos_Pendente, PRAZO_EVENTOS_MS, AGENDADOR_PRIO_ALTA);
+
+    // 1. Aquisio e atuadores
+    // As condicionais dormem sem trabalho pendente e no impedem o sono sem tick
+    Agendador_Registrar_Periodica_Condicional("balanca", Task_Handle_Scale, Balanca_Pendente, PERIODO_RAPIDO_MS, AGENDADOR_PRIO_ALTA);
+    Agendador_Registrar_Periodica("freq", Task_Handle_Frequency, PERIODO_FREQ_MS, AGENDADOR_PRIO_ALTA);
+    Agendador_Registrar_Periodica_Condicional("temp", Task_Handle_Temperature, TempSensor_Em_Conversao, PERIODO_TEMP_MS, AGENDADOR_PRIO_ALTA);
+    Agendador_Registrar_Periodica_Condicional("ciclo", Task_Ciclo, Ciclo_Pendente, PERIODO_RAPIDO_MS, AGENDADOR_PRIO_ALTA);
+    Agendador_Registrar_Periodica_Condicional("servos", Servos_Process, Servos_Pendente, PERIODO_RAPIDO_MS, AGENDADOR_PRIO_ALTA);
+
+    // 2. Comunicao
+    Agendador_Registrar_Periodica_Condicional("uart", Task_Comunicacao, Comunicacao_Pendente, PERIODO_RAPIDO_MS, AGENDADOR_PRIO_MEDIA);
+    Agendador_Registrar_Evento("cli", CLI_Process, CLI_Comando_Pendente, PRAZO_CLI_MS, AGENDADOR_PRIO_MEDIA);
+
+    // 3. Display, relgio, armazenamento
+    Agendador_Registrar_Periodica("display", Task_Update_Display_FSM, PERIODO_DISPLAY_MS, AGENDADOR_PRIO_BAIXA);
+    Agendador_Registrar_Periodica("temp_ped", Task_Pedir_Temperatura, TEMP_INTERVALO_CONVERSAO_MS, AGENDADOR_PRIO_BAIXA);
+    Agendador_Registrar_Periodica_Condicional("config", Gerenciador_Config_Run_FSM, Gerenciador_Config_Pendente, PERIODO_RAPIDO_MS, AGENDADOR_PRIO_BAIXA);
+    Agendador_Registrar_Periodica_Condicional("calib", Calibracao_Balanca_Process, Calibracao_Balanca_Pendente, PERIODO_CALIBRACAO_MS, AGENDADOR_PRIO_BAIXA);
 }
 
 //================================================================================
 // Implementao das Tarefas
 //================================================================================
 
-static void Task_Handle_High_Frequency_Polling(void)
+/**
+ * @brief Bombas de TX por DMA (CLI e DWIN) e recepo do DWIN.
+ */
+static void Task_Comunicacao(void)
 {
     CLI_TX_Pump();   
     DWIN_TX_Pump();  
     DWIN_Driver_Process(); 
-    CLI_Process();         
-    Servos_Process();      
 }
 
+static bool Comunicacao_Pendente(void)
+{
+    return CLI_TX_Pendente() || DWIN_Driver_Pendente();
+}
+
+static bool Ciclo_Pendente(void)
+{
+    Ciclo_Fase_t fase = Ciclo_Medicao_Get_Fase();
+    Repet_Status_t repeticao;
+    Repeticao_Medicao_Get_Status(&repeticao);
+    return (fase != CICLO_OCIOSO && fase != CICLO_CONCLUIDO) || (repeticao.estado == REPET_MEDINDO);
+}
+
+static void Task_Ciclo(void)
+{
+    Ciclo_Medicao_Process();
+    Repeticao_Medicao_Process();
+}
+
+/**
+ * @brief Publica cada resultado novo do medicao_frequencia e recalcula a Escala A.
+ * Roda no ritmo da janela de medio, no no do display.
+ */
+static void Task_Handle_Frequency(void)
+{
+    if (!Medicao_Freq_Process()) {
+        return; // Nenhuma janela terminou
+    }
+    s_freq_data.frequencia_chz = Medicao_Freq_Get_Ultima_cHz();
+    s_freq_data.frequencia_hz = (s_freq_data.frequencia_chz + 50u) / 100u;
+
+    // Usa a temperatura lida anteriormente (s_temperatura_mcu) para o clculo
+    if (s_temperatura_mcu > 0) {
+#if SCALE_FIXED_POINT
+        s_freq_data.escala_a_x10000 = Calcular_Escala_A_x10000();
+#else
+        s_freq_data.escala_a = Calcular_Escala_A();
+        s_freq_data.escala_a_x10000 = (int32_t)lrintf(s_freq_data.escala_a * 10000.0f);
+#endif
+    } else {
+        s_freq_data.escala_a = 0.0f;
+        s_freq_data.escala_a_x10000 = 0;
+    }
+}
+
+/**
+ * @brief Recolhe as converses de temperatura (as desta tarefa e as do ciclo).
+ * O ADC converte em ~15 us; o superloop nunca espera por ele.
+ */
+static void Task_Handle_Temperature(void)
+{
+    if (TempSensor_Process()) {
+        s_temperatura_mcu = TempSensor_Get_Ultima();
+    }
+}
+
+static void Task_Pedir_Temperatura(void)
+{
+    TempSensor_Iniciar_Conversao();
+}
+
+#if SCALE_FIXED_POINT
+static bool Check_Stability(int32_t new_mg)
+{
+    return ScaleStability_Push(&s_estabilidade, new_mg) != 0;
+}
+#else
 static bool Check_Stability(float new_grams)
 {
-    static float stable_grams_ref = 0.0f;
-    static int stable_counter = 0;
-    const float STABILITY_THRESHOLD_G = 0.05f; 
-    const int STABLE_COUNT_TARGET = 3;         
+    return ScaleStability_Push(&s_estabilidade, new_grams) != 0;
+}
+#endif
 
-    if (fabsf(new_grams - stable_grams_ref) < STABILITY_THRESHOLD_G)
-    {
-        stable_counter++;
-        if (stable_counter >= STABLE_COUNT_TARGET)
-        {
-            stable_counter = STABLE_COUNT_TARGET; 
-            return true; 
+/**
+ * @brief Tabela de assinantes do barramento (o relgio anda pelo
+ * EV_SYSTEM_TICK_1S em vez de uma tarefa peridica).
+ */
+static void Assinar_Eventos(void)
+{
+    Eventos_Init();
+    Eventos_Assinar(EV_SERVOS_SEQUENCE_STEP_CHANGED, On_Evento_Servos);
+    Eventos_Assinar(EV_SERVOS_SEQUENCE_FINISHED, On_Evento_Servos);
+    Eventos_Assinar(EV_UI_START_BUTTON_PRESSED, On_Evento_UI);
+    Eventos_Assinar(EV_UI_NEW_PASSWORD_SET, On_Evento_UI);
+    Eventos_Assinar(EV_UI_DATETIME_ENTERED, On_Evento_UI);
+    Eventos_Assinar(EV_SYSTEM_TICK_1S, On_Evento_Tick_1s);
+}
+
+static void On_Evento_UI(Evento_t evento)
+{
+    switch (evento.type) {
+        case EV_UI_START_BUTTON_PRESSED:
+            App_Manager_Handle_Start_Process();
+            break;
+        case EV_UI_NEW_PASSWORD_SET:
+            App_Manager_Handle_New_Password(((const StringPayload_t*)evento.payload)->value);
+            break;
+        case EV_UI_DATETIME_ENTERED: {
+            // O RTC_Driver s ajusta a hora; a data do payload  ignorada
+            const DateTimePayload_t* p = (const DateTimePayload_t*)evento.payload;
+            RTC_Driver_SetTime(p->hour, p->minute, p->second);
+            printf("APP: RTC ajustado para %02u:%02u:%02u\r\n", p->hour, p->minute, p->second);
+            break;
         }
+        default:
+            break;
     }
-    else
-    {
-        stable_counter = 0;
-        stable_grams_ref = new_grams;
+}
+
+static void On_Evento_Tick_1s(Evento_t evento)
+{
+    (void)evento;
+    RTC_Driver_Process();
+}
+
+/**
+ * @brief Log dos passos da sequncia dos servos no ciclo (EV_SERVOS_SEQUENCE_*).
+ */
+static void On_Evento_Servos(Evento_t evento)
+{
+    static const char* const nomes[] = { "funil", "raspador", "ocioso", "fim" };
+    const ServoSeqPayload_t* p = (const ServoSeqPayload_t*)evento.payload;
+
+    if (evento.type == EV_SERVOS_SEQUENCE_STEP_CHANGED) {
+        printf("CICLO: passo %u/%u (%s)\r\n", (unsigned)(p->indice + 1), (unsigned)p->total, nomes[p->passo]);
+    } else if (evento.type == EV_SERVOS_SEQUENCE_FINISHED) {
+        printf("CICLO: sequencia concluida apos %u/%u passos (%u espera(s) encerrada(s) pelo limite)\r\n",
+               (unsigned)p->indice, (unsigned)p->total, (unsigned)p->limites_esgotados);
+    }
+}
+
+/**
+ * @brief Mudana de fase que muda a massa no prato (o histrico da previso no vale mais).
+ * NIVELANDO -> MEDINDO fica de fora: o raspador voltando s sacode o prato,
+ * e o histrico desde a abertura dele carrega a dinmica do prato.
+ * Reiniciar ali custava SF_SETTLE_WIN_MIN amostras + SF_SETTLE_CONFIRM
+ * previses antes da primeira convergncia (ver "Ciclo" no scale_replay).
+ */
+static bool Fase_Muda_Massa(Ciclo_Fase_t anterior, Ciclo_Fase_t fase)
+{
+    return (fase != anterior) && !(anterior == CICLO_NIVELANDO && fase == CICLO_MEDINDO);
+}
+
+/**
+ * @brief Alimenta a previso do peso assentado com a amostra filtrada.
+ * O histrico  descartado quando o prato leva um golpe novo: degrau da
+ * cadeia de filtros, tara e as mudanas de fase em que a massa muda
+ * (Fase_Muda_Massa).
+ */
+static void Atualizar_Previsao(bool reiniciar)
+{
+    Ciclo_Fase_t fase = Ciclo_Medicao_Get_Fase();
+
+    if (reiniciar || Fase_Muda_Massa(s_previsao_fase, fase)) {
+        ScaleSettle_Reset(&s_previsao);
     }
-    return false;
+    s_previsao_fase = fase;
+
+    s_scale_output.previsao_convergiu = ScaleSettle_Push(&s_previsao, s_scale_output.peso_mg) != 0;
+    s_scale_output.peso_previsto_mg = s_previsao.pred_mg;
+    s_scale_output.previsao_incerteza_mg = s_previsao.bound_mg;
 }
 
+/**
+ * @brief A balana s tem trabalho com amostra no ring.
+ */
+static bool Balanca_Pendente(void)
+{
+    return ADS1232_HasSample();
+}
+
+/**
+ * @brief Drena em lote as amostras que o EXTI/TIM3 deixaram no ring.
+ * Cada amostra  processada exatamente uma vez, na ordem de chegada.
+ */
 static void Task_Handle_Scale(void)
 {
-    if (g_ads_data_ready) 
+    ADS1232_Sample_t lote[SCALE_BATCH_MAX];
+    uint32_t n = ADS1232_Drain(lote, SCALE_BATCH_MAX);
+
+    for (uint32_t i = 0; i < n; i++)
     {
-        g_ads_data_ready = false;
-        int32_t leitura_adc_mediana = ADS1232_Read_Median_of_3(); 
-        s_scale_output.raw_counts_median = (float)leitura_adc_mediana;
-        s_scale_output.grams_display = ADS1232_ConvertToGrams(leitura_adc_mediana); 
+        if (s_captura_restantes > 0) {
+            // Marca as fases do ciclo para o replay reproduzir os reincios da previso
+            Ciclo_Fase_t fase = Ciclo_Medicao_Get_Fase();
+            if (fase != s_captura_fase) {
+                s_captura_fase = fase;
+                printf("#FASE %u\n", (unsigned)fase);
+            }
+            // Linha compacta (~25 bytes): cabe folgada no FIFO do CLI
+            printf("@%lu,%lu,%ld\n", (unsigned long)lote[i].seq, (unsigned long)lote[i].tick,
+                   (long)lote[i].raw);
+            if (s_captura_restantes != UINT32_MAX && --s_captura_restantes == 0) {
+                printf("#FIM\n");
+            }
+        }
+
+        Calibracao_Balanca_Nova_Amostra(lote[i].raw); // S consome se houver captura em andamento
+
+        int32_t leitura_adc_mediana = ScaleMedian_Push(&s_mediana, lote[i].raw);
+        s_scale_output.raw_counts_median = leitura_adc_mediana;
+
+        uint8_t degrau = 0;
+        int32_t leitura_filtrada = ScaleFilterChain_Push(&s_filtro_cadeia, leitura_adc_mediana, &degrau);
+        s_scale_output.filtered_counts = leitura_filtrada;
+        if (degrau) {
+            s_scale_output.step_count++;
+        }
+#if SCALE_FIXED_POINT
+        // Caminho inteiro: grams_display s  gerado na fronteira com a UI (GetScaleData)
+        s_scale_output.peso_mg = ADS1232_ConvertToMilligrams(leitura_filtrada);
+        s_scale_output.is_stable = Check_Stability(s_scale_output.peso_mg);
+#else
+        s_scale_output.grams_display = ADS1232_ConvertToGrams(leitura_filtrada); 
+        s_scale_output.peso_mg = (int32_t)lrintf(s_scale_output.grams_display * 1000.0f);
         s_scale_output.is_stable = Check_Stability(s_scale_output.grams_display);
+#endif
+        // Durante a tara o peso no tem referncia: nunca reporta estvel
+        Tara_Balanca_Nova_Amostra(leitura_adc_mediana, s_scale_output.peso_mg, s_scale_output.is_stable);
+        s_scale_output.tara_em_andamento = Tara_Balanca_Em_Andamento();
+        if (s_scale_output.tara_em_andamento) {
+            s_scale_output.is_stable = false;
+        }
+        Atualizar_Previsao(degrau || s_scale_output.tara_em_andamento);
+        Ciclo_Medicao_Nova_Amostra_Peso(s_scale_output.peso_mg, lote[i].tick, s_scale_output.is_stable);
+        Ciclo_Medicao_Nova_Previsao_Peso(s_scale_output.previsao_convergiu, s_scale_output.peso_previsto_mg,
+                                         s_scale_output.previsao_incerteza_mg);
+        s_scale_output.sample_seq = lote[i].seq;
+        s_scale_output.sample_tick = lote[i].tick;
     }
 }
 
-static float Calcular_Escala_A(uint32_t frequencia_hz)
+#if SCALE_FIXED_POINT
+/**
+ * @brief Escala A em unidades de 0.0001 (ex.: 123.4567 -> 1234567), sem float no clculo.
+ */
+static int32_t Calcular_Escala_A_x10000(void)
+{
+    return Calculo_Umidade_Escala_A_x10000(Medicao_Freq_Get_Ultima_cHz());
+}
+#else
+static float Calcular_Escala_A(void)
 {
     float escala_a;
-    float freq_corr = (float)frequencia_hz; 
+    float freq_corr = (float)Medicao_Freq_Get_Ultima_cHz() / 100.0f; 
     escala_a = (-0.00014955f * freq_corr) + 396.85f;
     float gain = 1.0f;
     float zero = 0.0f;
@@ -176,23 +481,17 @@ static float Calcular_Escala_A(uint32_t frequencia_hz)
     escala_a = (escala_a * gain) + zero;
     return escala_a;
 }
+#endif
 
 
 /**
- * @brief (V8.6) FSM de atualizao dos VPs (Freq 1s, ADC 5s)
+ * @brief (V8.6) FSM de atualizao dos VPs (Freq, Escala A e Temp a cada 1s).
+ * O agendador chama a cada PERIODO_DISPLAY_MS.
  */
 static void Task_Update_Display_FSM(void)
 {
-    uint32_t tick_atual = HAL_GetTick();
-
     if (s_display_state == TASK_DISPLAY_IDLE)
     {
-        if (tick_atual - s_display_last_tick < DISPLAY_UPDATE_INTERVAL_MS) {
-            return; // No  hora (1s)
-        }
-        
-        s_display_last_tick = tick_atual; 
-
         if (DWIN_Driver_IsTxBusy()) 
         {
              return; 
@@ -211,41 +510,24 @@ static void Task_Update_Display_FSM(void)
             // *** INCIO CORREO V8.6 (Proposta do Usurio) ***
             
             // 1. ATUALIZAES RPIDAS (A CADA 1 SEGUNDO)
-            // Lemos a freq e resetamos o contador a cada 1s para o clculo ficar correto.
-            s_freq_data.pulsos = Frequency_Get_Pulse_Count(); 
-            Frequency_Reset(); 
-            
-            // Usa a temperatura lida anteriormente (s_temperatura_mcu) para o clculo
-            if (s_temperatura_mcu > 0) { 
-                s_freq_data.escala_a = Calcular_Escala_A(s_freq_data.pulsos);
-            } else {
-                s_freq_data.escala_a = 0.0f;
-            }
+            // s_freq_data (Freq/Escala A) j vem pronto do Task_Handle_Frequency.
 
             // Envia dados rpidos (Freq/Escala) a cada 1 segundo
-            int32_t frequencia_para_dwin = (int32_t)((s_freq_data.pulsos / 1000.0f) * 10.0f);
+            int32_t frequencia_para_dwin = (int32_t)(s_freq_data.frequencia_hz / 100u); // kHz x10
             DWIN_Driver_WriteInt32(FREQUENCIA, frequencia_para_dwin); 
             
-            int32_t escala_a_para_dwin = (int32_t)(s_freq_data.escala_a * 10.0f);
+            int32_t escala_a_para_dwin = s_freq_data.escala_a_x10000 / 1000;
             DWIN_Driver_WriteInt32(ESCALA_A, escala_a_para_dwin); 
 
-            // 2. ATUALIZAO LENTA (A CADA 5 SEGUNDOS)
-            // O ADC (Temp) bloqueia por 100ms. Execute apenas a cada 5 segundos.
-            s_display_temp_counter++;
-            if (s_display_temp_counter >= 5) { // Roda a cada 5 chamadas (5 segundos)
-                s_display_temp_counter = 0;
-                
-                s_temperatura_mcu = TempSensor_GetTemperature(); // <-- BLOQUEIO DE 100ms (Agora s a cada 5s)
-                
-                int16_t temperatura_para_dwin = (int16_t)(s_temperatura_mcu * 10.0f);
-                DWIN_Driver_WriteInt(TEMP_SAMPLE, temperatura_para_dwin); 
-            }
+            // 2. Temperatura: j convertida em segundo plano (Task_Handle_Temperature)
+            int16_t temperatura_para_dwin = (int16_t)(s_temperatura_mcu * 10.0f);
+            DWIN_Driver_WriteInt(TEMP_SAMPLE, temperatura_para_dwin); 
             // *** FIM CORREO V8.6 ***
         }
-        else
+        else if (tela_atual == TELA_ADJUST_SCALE) // Tela 51 (calibrao guiada)
         {
-             // No estamos na tela do monitor. Reseta o contador lento.
-             s_display_temp_counter = 0;
+             // Leitura bruta ao vivo para o operador acompanhar a estabilizao
+             DWIN_Driver_WriteInt32(AD_BALANCA, s_scale_output.raw_counts_median);
         }
 
         // 3. Sequncia completa. Volta para ocioso.
@@ -259,27 +541,93 @@ static void Task_Update_Display_FSM(void)
 
 void App_Manager_Handle_Start_Process(void) {
     printf("APP: Comando para iniciar processo recebido.\r\n");
-    Servos_Start_Sequence(); 
+    if (!Repeticao_Medicao_Iniciar(Gerenciador_Config_Get_Repeticoes())) {
+        printf("APP: Ciclo de medicao ja em andamento.\r\n");
+    }
 }
 
 void App_Manager_Handle_New_Password(const char* new_password) {
-    Gerenciador_Config_Set_Senha(new_password); 
-    printf("APP: Nova senha definida (na RAM, pendente de salvamento).\r\n");
+    if (Gerenciador_Config_Set_Senha(new_password)) {
+        printf("APP: Nova senha definida (na RAM, pendente de salvamento).\r\n");
+    } else {
+        printf("APP: ERRO ao definir a nova senha (FSM ocupada?)\r\n");
+    }
+}
+
+/**
+ * @brief (Re)monta a cadeia de filtros da balana a partir da configurao.
+ * Chamada no boot e sempre que o CLI altera os estgios.
+ */
+void App_Manager_Aplicar_Filtro_Balanca(void) {
+    Config_Estagio_Filtro_t cfg[MAX_ESTAGIOS_FILTRO_BALANCA];
+    ScaleFilterStageCfg estagios[MAX_ESTAGIOS_FILTRO_BALANCA];
+    uint16_t degrau_mg = 0;
+
+    uint8_t n = Gerenciador_Config_Get_Filtro_Balanca(cfg, MAX_ESTAGIOS_FILTRO_BALANCA, &degrau_mg);
+    for (uint8_t i = 0; i < n; i++) {
+        estagios[i].type    = cfg[i].tipo;
+        estagios[i].window  = cfg[i].janela;
+        estagios[i].param_a = cfg[i].param_a;
+        estagios[i].param_b = cfg[i].param_b;
+    }
+    ScaleFilterChain_Init(&s_filtro_cadeia, estagios, n, degrau_mg);
+    ScaleMedian_Init(&s_mediana, Gerenciador_Config_Get_Mediana_Balanca());
+    printf("APP: Filtro da balanca: mediana de %u + %u estagio(s), degrau %u mg.\r\n",
+           (unsigned)s_mediana.window, (unsigned)s_filtro_cadeia.n_stages, (unsigned)degrau_mg);
+}
+
+/**
+ * @brief Inicia a captura das converses brutas no console (0 = at App_Manager_Parar_Captura).
+ * O cabealho traz o offset e a calibrao para o replay no PC (Tools/scale_replay).
+ */
+void App_Manager_Iniciar_Captura(uint32_t num_amostras) {
+    Config_Ponto_Cal_t pontos[MAX_PONTOS_CAL_BALANCA];
+    uint8_t n = Gerenciador_Config_Get_Cal_Balanca(pontos, MAX_PONTOS_CAL_BALANCA);
+
+    printf("#CAPTURA %lu\n", (unsigned long)num_amostras);
+    printf("#OFFSET %ld\n", (long)ADS1232_GetOffset());
+    for (uint8_t i = 0; i < n; i++) {
+        printf("#CAL %.3f %ld\n", pontos[i].gramas, (long)pontos[i].adc);
+    }
+    printf("#FORMATO seq,tick_ms,raw\n");
+    s_captura_fase = Ciclo_Medicao_Get_Fase();
+    printf("#FASE %u\n", (unsigned)s_captura_fase);
+    s_captura_restantes = (num_amostras == 0) ? UINT32_MAX : num_amostras;
+}
+
+void App_Manager_Parar_Captura(void) {
+    if (s_captura_restantes > 0) {
+        s_captura_restantes = 0;
+        printf("#FIM\n");
+    }
 }
 
 void App_Manager_GetScaleData(App_ScaleData_t* data) {
     if (data != NULL) { 
         *data = s_scale_output; 
+#if SCALE_FIXED_POINT
+        data->grams_display = (float)s_scale_output.peso_mg / 1000.0f;
+#endif
+    }
+}
+
+void App_Manager_GetUmidade(Umid_Resultado_t* resultado) {
+    if (resultado != NULL) {
+        Ciclo_Status_t ciclo;
+        Ciclo_Medicao_Get_Status(&ciclo);
+        *resultado = ciclo.umidade;
     }
 }
 
 void App_Manager_GetFreqData(FreqData_t* data) {
-    if (data != NULL) { *data = s_freq_data; }
+    if (data != NULL) {
+        *data = s_freq_data;
+#if SCALE_FIXED_POINT
+        data->escala_a = (float)s_freq_data.escala_a_x10000 / 10000.0f;
+#endif
+    }
 }
 
 float App_Manager_GetTemperature(void) {
     return s_temperatura_mcu;
 }
-
-// Definindo o flag g_ads_data_ready que ser usado externamente
-volatile bool g_ads_data_ready = false;
\ No newline at end of file
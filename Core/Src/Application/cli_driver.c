@@ -9,6 +9,14 @@
 #include "cli_driver.h"
 #include "dwin_driver.h"
 #include "app_manager.h" 
+#include "calibracao_balanca.h"
+#include "tara_balanca.h"
+#include "scale_filter.h"
+#include "ciclo_medicao.h"
+#include "repeticao_medicao.h"
+#include "servo_controle.h"
+#include "agendador.h"
+#include "app_eventos.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -43,6 +51,18 @@ static void Cmd_Dwin(char* args);
 static void Cmd_GetPeso(char* args); // <-- Modificado
 static void Cmd_GetTemp(char* args);
 static void Cmd_GetFreq(char* args);
+static void Cmd_AdcStats(char* args);
+static void Cmd_Calibracao(char* args);
+static void Cmd_Tara(char* args);
+static void Cmd_Filtro(char* args);
+static void Cmd_Captura(char* args);
+static void Cmd_Umidade(char* args);
+static void Cmd_Ciclo(char* args);
+static void Cmd_Repete(char* args);
+static void Cmd_Servo(char* args);
+static void Cmd_Seq(char* args);
+static void Cmd_Tarefas(char* args);
+static void Cmd_Eventos(char* args);
 static void Handle_Dwin_PIC(char* sub_args);
 static void Handle_Dwin_INT(char* sub_args);
 static void Handle_Dwin_INT32(char* sub_args);
@@ -72,6 +92,12 @@ static volatile bool s_dma_tx_busy = false;
 static const cli_command_t s_command_table[] = {
     { "HELP", Cmd_Help }, { "?", Cmd_Help }, { "DWIN", Cmd_Dwin },
     { "PESO", Cmd_GetPeso }, { "TEMP", Cmd_GetTemp }, { "FREQ", Cmd_GetFreq },
+    { "ADC", Cmd_AdcStats }, { "CAL", Cmd_Calibracao },
+    { "TARA", Cmd_Tara }, { "FILTRO", Cmd_Filtro },
+    { "CAPTURA", Cmd_Captura }, { "UMIDADE", Cmd_Umidade },
+    { "CICLO", Cmd_Ciclo }, { "REPETE", Cmd_Repete },
+    { "SERVO", Cmd_Servo }, { "SEQ", Cmd_Seq },
+    { "TAREFAS", Cmd_Tarefas }, { "EVENTOS", Cmd_Eventos },
 };
 static const size_t NUM_COMMANDS = sizeof(s_command_table) / sizeof(s_command_table[0]);
 
@@ -87,6 +113,39 @@ static const char HELP_TEXT[] =
     "| PESO                     | Mostra a leitura atual da balanca.            |\r\n"
     "| TEMP                     | Mostra a leitura do sensor de temperatura.    |\r\n"
     "| FREQ                     | Mostra a ultima leitura de frequencia.        |\r\n"
+    "| FREQ MODO CONT|RECIP     | Contagem ou reciproco; mantem FREQ JANELA.    |\r\n"
+    "| FREQ JANELA <ms>         | Janela de medicao (50 a 2000 ms).             |\r\n"
+    "| FREQ MEDIA [n]           | Media de n janelas a partir de agora.         |\r\n"
+    "| ADC                      | Estatisticas do ring de amostras do ADS1232.  |\r\n"
+    "| CAL                      | Mostra a calibracao ativa e o progresso.      |\r\n"
+    "| CAL INICIO [g1 g2 ...]   | Inicia calibracao guiada (massas opcionais).  |\r\n"
+    "| CAL OK                   | Captura o ponto atual (massa no prato).       |\r\n"
+    "| CAL CANCELA              | Aborta a calibracao guiada.                   |\r\n"
+    "| TARA                     | Tara em segundo plano (nao trava o loop).     |\r\n"
+    "| TARA STATUS              | Progresso da tara e estado do auto-zero.      |\r\n"
+    "| TARA AZ ON|OFF           | Liga/desliga o rastreamento de auto-zero.     |\r\n"
+    "| FILTRO                   | Mostra a cadeia de filtros da balanca.        |\r\n"
+    "| FILTRO MM:n MED:n ...    | Ate 3 estagios: MM:n MED:n EMA:a KAL:q:r.     |\r\n"
+    "| FILTRO MEDIANA <n>       | Mediana antes da cadeia (n impar, 5..31).     |\r\n"
+    "| FILTRO DEGRAU <mg>       | Limiar do fast-settle (0 desliga).            |\r\n"
+    "| CAPTURA [n]              | Envia n conversoes brutas (sem n: continua).  |\r\n"
+    "| CAPTURA PARA             | Encerra a captura.                            |\r\n"
+    "| UMIDADE                  | Umidade da ultima sequencia e calculo ao vivo.|\r\n"
+    "| UMIDADE VOLUME <ml>      | Volume medido da camara (0: sem densidade).   |\r\n"
+    "| CICLO                    | Fase e tempos do ultimo ciclo de medicao.     |\r\n"
+    "| CICLO INICIA             | Roda a sequencia SEQ (avanca pelos sensores). |\r\n"
+    "| REPETE                   | Estatistica do lote de repeticoes.            |\r\n"
+    "| REPETE <n> | PARA        | Inicia lote de n ciclos (1..10) / interrompe. |\r\n"
+    "| REPETE CFG <n>           | Repeticoes por medicao (salvo, tela setup).   |\r\n"
+    "| SERVO                    | Duracao dos movimentos e servo em movimento.  |\r\n"
+    "| SERVO RAMPA <ms>         | Duracao do perfil trapezoidal (20..2000 ms).  |\r\n"
+    "| SEQ                      | Passos dos servos no ciclo de medicao.        |\r\n"
+    "| SEQ F|R:a:ms T:ms ...    | Ate 12 passos: servo e angulo (T: so espera). |\r\n"
+    "| SEQ F:a:COND[:lim[:min]] | COND: MOV EST DOS QUEDA MEDE; limite, minimo. |\r\n"
+    "| SEQ PADRAO               | Restaura a sequencia de fabrica.              |\r\n"
+    "| TAREFAS                  | Agendador: duracao, prazos, CPU, sono s/ tick.|\r\n"
+    "| TAREFAS ZERA             | Zera as estatisticas do agendador.            |\r\n"
+    "| EVENTOS [ZERA]           | Barramento: filas, descartes e latencia.      |\r\n"
     "| DWIN PIC <id>            | Muda a tela (ex: DWIN PIC 1).                 |\r\n"
     "| DWIN INT <addr_h> <val>  | Escreve int16 no VP (ex: DWIN INT 2190 1234).  |\r\n"
     "| DWIN RAW <bytes_hex>     | Envia bytes crus para o DWIN (ex: 5AA5...).   |\r\n"
@@ -115,9 +174,18 @@ void CLI_Process(void) {
     }
 }
 
+bool CLI_Comando_Pendente(void) {
+    return s_command_ready;
+}
+
 /**
  * @brief (V8.1) Bomba de TX do CLI (chamada no super-loop).
  */
+bool CLI_TX_Pendente(void)
+{
+    return !s_dma_tx_busy && (s_tx_fifo_head != s_tx_fifo_tail);
+}
+
 void CLI_TX_Pump(void)
 {
     if (s_dma_tx_busy || (s_tx_fifo_head == s_tx_fifo_tail)) {
@@ -292,7 +360,24 @@ static void Cmd_GetPeso(char* args) {
     printf("Dados da Balanca:\r\n");
     printf("  - Peso: %.2f g\r\n", data.grams_display);
     printf("  - Estavel: %s\r\n", data.is_stable ? "SIM" : "NAO");
-    printf("  - ADC Counts (mediana): %.0f\r\n", data.raw_counts_median);
+    if (data.previsao_incerteza_mg != INT32_MAX) {
+        printf("  - Previsao: %ld mg +- %ld mg (%s)\r\n", (long)data.peso_previsto_mg,
+               (long)data.previsao_incerteza_mg, data.previsao_convergiu ? "convergiu" : "ajustando");
+    } else {
+        printf("  - Previsao: sem ajuste\r\n");
+    }
+    printf("  - ADC Counts (mediana): %ld\r\n", (long)data.raw_counts_median);
+    printf("  - Amostra #%lu (t=%lu ms)\r\n", (unsigned long)data.sample_seq, (unsigned long)data.sample_tick);
+}
+
+static void Cmd_AdcStats(char* args) {
+    ADS1232_Stats_t st;
+    ADS1232_GetStats(&st);
+    printf("Aquisicao ADS1232 (ring %u amostras, %u SPS):\r\n", (unsigned)ADS1232_RING_SIZE, (unsigned)ADS1232_SPS);
+    printf("  - Conversoes: %lu\r\n", (unsigned long)st.total_conversoes);
+    printf("  - Descartadas (ring cheio): %lu\r\n", (unsigned long)st.descartadas);
+    printf("  - Overruns: %lu\r\n", (unsigned long)st.overruns);
+    printf("  - Ocupacao: %u (max %u)\r\n", (unsigned)st.nivel_atual, (unsigned)st.nivel_max);
 }
 
 static void Cmd_GetTemp(char* args) {
@@ -301,13 +386,559 @@ static void Cmd_GetTemp(char* args) {
 }
 
 static void Cmd_GetFreq(char* args) {
+    if (args != NULL) {
+        char* sub_args = strchr(args, ' ');
+        if (sub_args != NULL) { *sub_args = '\0'; sub_args++; }
+        if (strcasecmp(args, "MODO") == 0 && sub_args != NULL && strcasecmp(sub_args, "CONT") == 0) {
+            Medicao_Freq_Set_Modo(FREQ_MODO_CONTAGEM);
+            printf("Modo de frequencia alterado.");
+        } else if (strcasecmp(args, "MODO") == 0 && sub_args != NULL && strcasecmp(sub_args, "RECIP") == 0) {
+            Medicao_Freq_Set_Modo(FREQ_MODO_RECIPROCO);
+            printf("Modo de frequencia alterado.");
+        } else if (strcasecmp(args, "JANELA") == 0 && sub_args != NULL) {
+            if (!Medicao_Freq_Set_Janela_ms((uint32_t)strtoul(sub_args, NULL, 10))) {
+                printf("Janela invalida (%d a %d ms).", FREQ_JANELA_MIN_MS, FREQ_JANELA_MAX_MS);
+            } else {
+                printf("Janela de frequencia alterada.");
+            }
+        } else if (strcasecmp(args, "MEDIA") == 0) {
+            uint8_t n = (sub_args != NULL) ? (uint8_t)atoi(sub_args) : MED_FREQ_MEDIA_SEQ_JANELAS;
+            Medicao_Freq_Iniciar_Media(n);
+            printf("Media sincronizada iniciada. Veja com FREQ.");
+        } else {
+            printf("Use FREQ MODO CONT|RECIP, FREQ JANELA <ms> ou FREQ MEDIA [n].");
+        }
+        return;
+    }
+
     FreqData_t data;
+    Frequency_Stats_t fs;
+    Med_Freq_Stats_t st;
+    Med_Freq_Media_t media;
     App_Manager_GetFreqData(&data);
+    Frequency_Get_Stats(&fs);
+    Medicao_Freq_Get_Stats(&st);
+    Medicao_Freq_Get_Media(&media);
     printf("Dados de Frequencia:\r\n");
-    printf("  - Pulsos (em 1s): %lu\r\n", (unsigned long)data.pulsos);
+    printf("  - Frequencia: %lu.%02lu Hz\r\n", (unsigned long)(st.ultima_chz / 100u),
+           (unsigned long)(st.ultima_chz % 100u));
+    if (fs.modo == FREQ_MODO_RECIPROCO) {
+        printf("  - Modo reciproco: janelas de %lu ms, media de %u\r\n", (unsigned long)fs.janela_ms, (unsigned)fs.media_janelas);
+        printf("  - Ultima janela: %lu bordas em %lu ticks\r\n", (unsigned long)fs.bordas, (unsigned long)fs.ticks);
+    } else {
+        printf("  - Modo contagem: janela de %lu ms\r\n", (unsigned long)fs.janela_ms);
+    }
+    printf("  - Janelas: %lu (ressincronizacoes: %lu)\r\n", (unsigned long)fs.janelas, (unsigned long)fs.perdidas);
+    printf("  - Historico (%u): media %lu.%02lu Hz, sigma %lu.%02lu Hz, deriva %ld cHz/s\r\n",
+           (unsigned)st.amostras, (unsigned long)(st.media_chz / 100u), (unsigned long)(st.media_chz % 100u),
+           (unsigned long)(st.sigma_chz / 100u), (unsigned long)(st.sigma_chz % 100u), (long)st.deriva_chz_s);
+    if (media.estado == MED_FREQ_MEDIA_PRONTA) {
+        printf("  - Media sincronizada (%u janelas): %lu.%02lu Hz, sigma %lu.%02lu Hz\r\n", (unsigned)media.janelas,
+               (unsigned long)(media.media_chz / 100u), (unsigned long)(media.media_chz % 100u),
+               (unsigned long)(media.sigma_chz / 100u), (unsigned long)(media.sigma_chz % 100u));
+    } else if (media.estado == MED_FREQ_MEDIA_COLETANDO) {
+        printf("  - Media sincronizada: %u/%u janelas\r\n", (unsigned)media.janelas, (unsigned)media.janelas_alvo);
+    }
     printf("  - Escala A (calc): %.2f\r\n", data.escala_a);
 }
 
+static void Imprimir_Umidade(const char* titulo, const Umid_Resultado_t* r) {
+    static const char* const nomes_status[] = { "OK", "abaixo da faixa", "acima da faixa", "peso invalido", "sem grao" };
+    printf("%s (grao %u): %ld.%02ld %% [%s]\r\n", titulo, (unsigned)r->grao,
+           (long)(r->umidade_x100 / 100), (long)abs(r->umidade_x100 % 100), nomes_status[r->status]);
+    printf("  - Escala A: %ld.%04ld | curva sem temp.: %ld.%02ld %%",
+           (long)(r->escala_a_x10000 / 10000), (long)abs(r->escala_a_x10000 % 10000),
+           (long)(r->umidade_bruta_x100 / 100), (long)abs(r->umidade_bruta_x100 % 100));
+    if (r->densidade_valida) {
+        printf(" | densidade: %ld.%ld kg/hL\r\n", (long)(r->densidade_x10 / 10), (long)(r->densidade_x10 % 10));
+    } else {
+        printf(" | densidade: sem volume da camara\r\n");
+    }
+}
+
+static void Cmd_Umidade(char* args) {
+    Umid_Resultado_t r;
+    App_ScaleData_t peso;
+
+    if (args != NULL) {
+        char* sub_args = strchr(args, ' ');
+        if (sub_args != NULL) { *sub_args = '\0'; sub_args++; }
+
+        if (strcasecmp(args, "VOLUME") == 0 && sub_args != NULL) {
+            long ml = atol(sub_args);
+            if (ml < 0 || ml > VOLUME_CAMARA_MAX_ML || !Gerenciador_Config_Set_Volume_Camara_ml((uint16_t)ml)) {
+                printf("ERRO: Use 0..%u mL (ou aguarde o salvamento em curso).\r\n", (unsigned)VOLUME_CAMARA_MAX_ML);
+            } else if (ml == 0) {
+                printf("Volume da camara apagado: densidade desligada (pendente de salvamento).\r\n");
+            } else {
+                printf("Volume da camara: %ld mL (pendente de salvamento).\r\n", ml);
+            }
+        } else {
+            printf("Uso: UMIDADE [VOLUME <ml>]\r\n");
+        }
+        return;
+    }
+
+    App_Manager_GetUmidade(&r);
+    Imprimir_Umidade("Ultima sequencia", &r);
+
+    App_Manager_GetScaleData(&peso);
+    Calculo_Umidade_Calcular(Medicao_Freq_Get_Ultima_cHz(), peso.peso_mg,
+                             (int32_t)(App_Manager_GetTemperature() * 100.0f), &r);
+    Imprimir_Umidade("Ao vivo", &r);
+}
+
+static void Cmd_Ciclo(char* args) {
+    static const char* const nomes_fase[] = { "ocioso", "enchendo", "nivelando", "medindo", "concluido" };
+
+    if (args != NULL) {
+        char* sub_args = strchr(args, ' ');
+        if (sub_args != NULL) { *sub_args = '\0'; sub_args++; }
+
+        if (strcasecmp(args, "INICIA") == 0) {
+            printf(Ciclo_Medicao_Iniciar() ? "Ciclo de medicao iniciado.\r\n"
+                                           : "ERRO: Ciclo ja em andamento.\r\n");
+        } else {
+            printf("Uso: CICLO [INICIA]\r\n");
+        }
+        return;
+    }
+
+    Ciclo_Status_t st;
+    Ciclo_Medicao_Get_Status(&st);
+    printf("Ciclo de medicao: %s (%lu concluidos)\r\n", nomes_fase[st.fase], (unsigned long)st.ciclos);
+    Servo_Seq_Status_t seq;
+    Servos_Get_Status_Sequencia(&seq);
+    if (seq.ativa) {
+        printf("  - Passo %u/%u da sequencia (SEQ)\r\n", (unsigned)(seq.indice + 1), (unsigned)seq.total);
+    }
+    if (st.ciclos == 0) return;
+    printf("  - Ultimo: %lu ms | enche %lu%s | nivela %lu%s | mede %lu%s\r\n",
+           (unsigned long)st.t_total_ms,
+           (unsigned long)st.t_enchimento_ms, st.enchimento_por_tempo ? " (tempo)" : "",
+           (unsigned long)st.t_nivelamento_ms, st.nivelamento_por_tempo ? " (tempo)" : "",
+           (unsigned long)st.t_medicao_ms, st.medicao_por_tempo ? " (tempo)" : "");
+    printf("  - Esperas encerradas pelo limite: %u\r\n", (unsigned)seq.limites_esgotados);
+    if (st.peso_por_previsao) {
+        printf("  - Peso pela previsao do assentamento (+- %ld mg)\r\n", (long)st.incerteza_mg);
+    }
+    printf("  - Entradas: %ld mg, %lu.%02lu Hz, %ld.%02ld C%s\r\n", (long)st.peso_mg,
+           (unsigned long)(st.freq_chz / 100u), (unsigned long)(st.freq_chz % 100u),
+           (long)(st.temp_x100 / 100), (long)abs(st.temp_x100 % 100),
+           st.resultado_valido ? "" : " [INCOMPLETO]");
+    printf("  - Dosagem: alvo %ld mg, vazao %ld mg/s, fechou em %ld mg (%s), dosado %ld mg\r\n",
+           (long)st.alvo_mg, (long)st.vazao_mg_s, (long)st.peso_fechamento_mg,
+           st.fechou_por_dosagem ? "previsao" : "plato/tempo",
+           (long)st.massa_dosada_mg);
+    printf("  - Antecipacao: %lu ms neste ciclo, %lu ms aprendida\r\n",
+           (unsigned long)st.antecipacao_ms, (unsigned long)Ciclo_Medicao_Get_Antecipacao_ms());
+}
+
+static void Cmd_Repete(char* args) {
+    if (args != NULL) {
+        char* sub_args = strchr(args, ' ');
+        if (sub_args != NULL) { *sub_args = '\0'; sub_args++; }
+
+        if (strcasecmp(args, "PARA") == 0) {
+            Repeticao_Medicao_Cancelar();
+            printf("Lote interrompido (o ciclo em curso termina).\r\n");
+        } else if (strcasecmp(args, "CFG") == 0 && sub_args != NULL) {
+            int n = atoi(sub_args);
+            if (n < 1 || n > MAX_REPETICOES || !Gerenciador_Config_Set_Repeticoes((uint8_t)n)) {
+                printf("ERRO: Use 1..%u (ou aguarde o salvamento em curso).\r\n", (unsigned)MAX_REPETICOES);
+            } else {
+                DWIN_Driver_WriteInt(NR_REPETICOES, (int16_t)n);
+                printf("Repeticoes por medicao: %d (pendente de salvamento).\r\n", n);
+            }
+        } else {
+            int n = atoi(args);
+            if (!Repeticao_Medicao_Iniciar((uint8_t)((n > 0 && n <= MAX_REPETICOES) ? n : 0))) {
+                printf("ERRO: n de 1 a %u, sem ciclo em andamento.\r\n", (unsigned)MAX_REPETICOES);
+            } else {
+                printf("Lote de %d repeticoes iniciado.\r\n", n);
+            }
+        }
+        return;
+    }
+
+    static const char* const nomes_estado[] = { "ocioso", "medindo", "concluido" };
+    Repet_Status_t st;
+    Repeticao_Medicao_Get_Status(&st);
+    printf("Repeticoes: %s, %u/%u ciclos (padrao %u)\r\n", nomes_estado[st.estado],
+           (unsigned)st.executadas, (unsigned)st.alvo, (unsigned)Gerenciador_Config_Get_Repeticoes());
+    if (st.executadas == 0) return;
+    printf("  - Aceitas %u | rejeitadas (MAD) %u | invalidas %u\r\n",
+           (unsigned)st.aceitas, (unsigned)st.rejeitadas, (unsigned)st.invalidas);
+    printf("  - Media %ld.%02ld %% | desvio %ld.%02ld | mediana %ld.%02ld | MAD %ld.%02ld\r\n",
+           (long)(st.media_x100 / 100), (long)abs(st.media_x100 % 100),
+           (long)(st.desvio_x100 / 100), (long)(st.desvio_x100 % 100),
+           (long)(st.mediana_x100 / 100), (long)abs(st.mediana_x100 % 100),
+           (long)(st.mad_x100 / 100), (long)(st.mad_x100 % 100));
+}
+
+static void Cmd_Servo(char* args) {
+    if (args != NULL) {
+        char* sub_args = strchr(args, ' ');
+        if (sub_args != NULL) { *sub_args = '\0'; sub_args++; }
+
+        if (strcasecmp(args, "RAMPA") == 0 && sub_args != NULL) {
+            int ms = atoi(sub_args);
+            if (!Gerenciador_Config_Set_Servo_Rampa_ms((ms > 0) ? (uint32_t)ms : 0u)) {
+                printf("ERRO: Use %u..%u ms (ou aguarde o salvamento em curso).\r\n",
+                       (unsigned)SERVO_RAMPA_MIN_MS, (unsigned)SERVO_RAMPA_MAX_MS);
+            } else {
+                printf("Rampa dos servos: %lu ms (pendente de salvamento).\r\n",
+                       (unsigned long)Gerenciador_Config_Get_Servo_Rampa_ms());
+            }
+        } else {
+            printf("Uso: SERVO [RAMPA <ms>]\r\n");
+        }
+        return;
+    }
+
+    printf("Servos: rampa %lu ms (perfil trapezoidal, DMA1 canal 2)%s\r\n",
+           (unsigned long)Gerenciador_Config_Get_Servo_Rampa_ms(),
+           Servos_Em_Movimento() ? " | em movimento" : "");
+}
+
+// Nomes das esperas no comando SEQ (Servo_Seq_Espera_t; TEMPO  o nmero puro)
+static const char* const s_nomes_espera_seq[SERVO_SEQ_NUM_ESPERAS] = { "", "MOV", "EST", "DOS", "QUEDA", "MEDE" };
+
+/**
+ * @brief Um passo no formato do comando: F:75:DOS:2000:300, F:0:QUEDA:400, T:500.
+ */
+static void Imprimir_Passo_Seq(uint8_t i, const Config_Passo_Servo_t* p) {
+    static const char* const servos[] = { "T", "F", "R" };
+
+    printf("  %2u) %s", (unsigned)(i + 1), servos[p->servo]);
+    if (p->servo != SERVO_SEQ_NENHUM) {
+        printf(":%u", (unsigned)p->angulo);
+    }
+    if (p->espera == SERVO_SEQ_TEMPO) {
+        printf(":%u", (unsigned)p->duracao_ms);
+    } else {
+        printf(":%s", s_nomes_espera_seq[p->espera]);
+        if (p->duracao_ms > 0) printf(":%u", (unsigned)p->duracao_ms);
+        if (p->minimo_ms > 0) printf(":%u", (unsigned)p->minimo_ms);
+    }
+    printf("\r\n");
+}
+
+/**
+ * @brief Espera de um token (ms ou nome da condio) e, nas condies, limite e mnimo.
+ */
+static bool Parse_Espera_Seq(char* campo, Config_Passo_Servo_t* p) {
+    char* lim = strchr(campo, ':');
+    if (lim != NULL) { *lim = '\0'; lim++; }
+    char* min = (lim != NULL) ? strchr(lim, ':') : NULL;
+    if (min != NULL) { *min = '\0'; min++; }
+
+    if (isdigit((unsigned char)campo[0])) {
+        uint32_t ms = strtoul(campo, NULL, 10);
+        if (lim != NULL || ms > CICLO_TEMPO_MAX_MS) return false;
+        p->espera = SERVO_SEQ_TEMPO;
+        p->duracao_ms = (uint16_t)ms;
+        return true;
+    }
+    for (uint8_t e = SERVO_SEQ_MOVIMENTO; e < SERVO_SEQ_NUM_ESPERAS; e++) {
+        if (strcasecmp(campo, s_nomes_espera_seq[e]) == 0) {
+            uint32_t ms = (lim != NULL) ? strtoul(lim, NULL, 10) : 0;
+            uint32_t minimo = (min != NULL) ? strtoul(min, NULL, 10) : 0;
+            if (ms > CICLO_TEMPO_MAX_MS || minimo > CICLO_TEMPO_MAX_MS) return false;
+            p->espera = e;
+            p->duracao_ms = (uint16_t)ms;
+            p->minimo_ms = (uint16_t)minimo;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void Cmd_Seq(char* args) {
+    Config_Passo_Servo_t passos[MAX_PASSOS_SEQUENCIA];
+
+    if (args == NULL) {
+        Servo_Seq_Status_t st;
+        Servos_Get_Status_Sequencia(&st);
+        uint8_t n = Gerenciador_Config_Get_Sequencia_Servos(passos, MAX_PASSOS_SEQUENCIA);
+        printf("Sequencia dos servos: %u passo(s), %lu execucao(oes)", (unsigned)n, (unsigned long)st.execucoes);
+        if (st.ativa) {
+            printf(" | rodando passo %u/%u", (unsigned)(st.indice + 1), (unsigned)st.total);
+        }
+        printf(" | limites esgotados: %u\r\n", (unsigned)st.limites_esgotados);
+        for (uint8_t i = 0; i < n; i++) {
+            Imprimir_Passo_Seq(i, &passos[i]);
+        }
+        return;
+    }
+
+    if (strcasecmp(args, "PADRAO") == 0) {
+        printf(Gerenciador_Config_Restaurar_Sequencia_Servos() ? "Sequencia padrao restaurada (pendente de salvamento).\r\n"
+               : "Configuracao ocupada (salvando). Tente novamente.\r\n");
+        return;
+    }
+
+    // Cada token: F|R:angulo[:espera] ou T:espera; espera = ms | COND[:limite[:minimo]]
+    uint8_t n = 0;
+    memset(passos, 0, sizeof(passos));
+    for (char* tok = strtok(args, " "); tok != NULL; tok = strtok(NULL, " ")) {
+        if (n >= MAX_PASSOS_SEQUENCIA) { printf("Maximo de %d passos.\r\n", MAX_PASSOS_SEQUENCIA); return; }
+        char* p1 = strchr(tok, ':');
+        if (p1 != NULL) { *p1 = '\0'; p1++; }
+        Config_Passo_Servo_t* p = &passos[n];
+        bool ok = false;
+
+        if (strcasecmp(tok, "T") == 0 && p1 != NULL) {
+            p->servo = SERVO_SEQ_NENHUM;
+            ok = Parse_Espera_Seq(p1, p);
+        } else if ((strcasecmp(tok, "F") == 0 || strcasecmp(tok, "R") == 0) && p1 != NULL) {
+            char* p2 = strchr(p1, ':');
+            if (p2 != NULL) { *p2 = '\0'; p2++; }
+            uint32_t a = strtoul(p1, NULL, 10);
+            p->servo = (toupper((unsigned char)tok[0]) == 'F') ? SERVO_SEQ_FUNIL : SERVO_SEQ_RASPADOR;
+            p->angulo = (uint8_t)a;
+            p->espera = SERVO_SEQ_MOVIMENTO;
+            ok = (a <= SERVO_ANGULO_MAX) && (p2 == NULL || Parse_Espera_Seq(p2, p));
+        }
+        if (!ok) {
+            printf("Passo invalido: \"%s\" (use F|R:0..%d[:ms|COND[:limite[:minimo]]] ou T:ms|COND...)\r\n",
+                   tok, SERVO_ANGULO_MAX);
+            return;
+        }
+        n++;
+    }
+
+    if (!Gerenciador_Config_Set_Sequencia_Servos(passos, n)) {
+        printf("ERRO: EST/DOS/QUEDA/MEDE exigem limite (ate %u ms) >= minimo, ou salvamento em curso.\r\n",
+               (unsigned)CICLO_TEMPO_MAX_MS);
+        return;
+    }
+    printf("Sequencia com %u passo(s) (pendente de salvamento; vale no proximo ciclo).\r\n", (unsigned)n);
+}
+
+static void Cmd_Tarefas(char* args) {
+    static const char* const prioridades[] = { "A", "M", "B" };
+
+    if (args != NULL) {
+        if (strcasecmp(args, "ZERA") == 0) {
+            Agendador_Zerar_Stats();
+            printf("Estatisticas do agendador zeradas.\r\n");
+        } else {
+            printf("Uso: TAREFAS [ZERA]\r\n");
+        }
+        return;
+    }
+
+    Agendador_Stats_t g;
+    Agendador_Get_Stats(&g);
+    uint32_t ocioso_pct_x10 = (g.janela_ms > 0) ? (uint32_t)(((uint64_t)g.ocioso_ms * 1000u) / g.janela_ms) : 0u;
+    if (ocioso_pct_x10 > 1000u) ocioso_pct_x10 = 1000u;
+    uint32_t ocupado_pct_x10 = 1000u - ocioso_pct_x10;
+    printf("Agendador: %lu ms, CPU ocupada %lu.%lu %% (%lu de %lu passagens dormiram)\r\n",
+           (unsigned long)g.janela_ms, (unsigned long)(ocupado_pct_x10 / 10u), (unsigned long)(ocupado_pct_x10 % 10u),
+           (unsigned long)g.dormidas, (unsigned long)g.passagens);
+    printf("Sem tick: %lu sonos (maior %lu ms), acordou no prazo %lu / por IRQ %lu, latencia %lu us (pior %lu)\r\n",
+           (unsigned long)g.sonos_sem_tick, (unsigned long)g.maior_sono_ms, (unsigned long)g.despertares_prazo,
+           (unsigned long)g.despertares_irq, (unsigned long)g.latencia_despertar_media_us,
+           (unsigned long)g.latencia_despertar_max_us);
+    printf("  tarefa   P period     execs medio_us pior_us atraso_us perdas\r\n"); // Cabe no FIFO do CLI
+    for (uint8_t i = 0; i < Agendador_Get_Num_Tarefas(); i++) {
+        Agendador_Stats_Tarefa_t t;
+        if (!Agendador_Get_Stats_Tarefa(i, &t)) break;
+        char periodo[10];
+        if (t.periodo_ms > 0) {
+            snprintf(periodo, sizeof(periodo), "%lums", (unsigned long)t.periodo_ms);
+        } else {
+            snprintf(periodo, sizeof(periodo), "evento");
+        }
+        printf("  %-8s %s %6s %9lu %8lu %7lu %9lu %6lu\r\n", t.nome, prioridades[t.prioridade], periodo,
+               (unsigned long)t.execucoes, (unsigned long)t.medio_us, (unsigned long)t.pior_us,
+               (unsigned long)t.latencia_max_us, (unsigned long)t.perdas_prazo);
+    }
+}
+
+static void Cmd_Eventos(char* args) {
+    if (args != NULL) {
+        if (strcasecmp(args, "ZERA") == 0) {
+            Eventos_Zerar_Stats();
+            printf("Estatisticas do barramento zeradas.\r\n");
+        } else {
+            printf("Uso: EVENTOS [ZERA]\r\n");
+        }
+        return;
+    }
+
+    Eventos_Stats_t st;
+    Eventos_Get_Stats(&st);
+    const Eventos_Stats_Fila_t* filas[] = { &st.isr, &st.principal };
+    static const char* const nomes[] = { "isr", "main" };
+    printf("  fila prof max/cap publicados descartados\r\n");
+    for (uint8_t i = 0; i < 2; i++) {
+        printf("  %-4s %4u %3u/%-3u %10lu %11lu\r\n", nomes[i], (unsigned)filas[i]->profundidade,
+               (unsigned)filas[i]->profundidade_max, (unsigned)filas[i]->capacidade,
+               (unsigned long)filas[i]->publicados, (unsigned long)filas[i]->descartados);
+    }
+    printf("Despachados: %lu (%lu sem assinante). Latencia us: ultima %lu, media %lu, pior %lu\r\n",
+           (unsigned long)st.despachados, (unsigned long)st.sem_assinante, (unsigned long)st.latencia_ultima_us,
+           (unsigned long)st.latencia_media_us, (unsigned long)st.latencia_max_us);
+    if (st.fora_de_prioridade > 0u) {
+        printf("ERRO: %lu publicacao(oes) de ISR fora da prioridade %u recusada(s)\r\n",
+               (unsigned long)st.fora_de_prioridade, (unsigned)EVENTOS_PRIORIDADE_ISR);
+    }
+}
+
+static void Cmd_Calibracao(char* args) {
+    if (args == NULL) {
+        Config_Ponto_Cal_t pontos[MAX_PONTOS_CAL_BALANCA];
+        uint8_t n = Gerenciador_Config_Get_Cal_Balanca(pontos, MAX_PONTOS_CAL_BALANCA);
+        printf("Calibracao da balanca (%u pontos):\r\n", (unsigned)n);
+        for (uint8_t i = 0; i < n; i++) {
+            printf("  %u) %8.2f g = %ld counts\r\n", (unsigned)(i + 1), pontos[i].gramas, (long)pontos[i].adc);
+        }
+        Cal_Bal_Status_t st;
+        Calibracao_Balanca_Get_Status(&st);
+        if (st.etapa != CAL_BAL_OCIOSO) {
+            printf("  Em andamento: ponto %u/%u (%.2f g)\r\n",
+                   (unsigned)(st.ponto_atual + 1), (unsigned)st.num_pontos, st.massa_atual_g);
+        }
+        if (ADS1232_Calibration_IsBusy()) {
+            printf("  Tabela de conversao sendo remontada...\r\n");
+        }
+        return;
+    }
+
+    char* sub_args = strchr(args, ' ');
+    if (sub_args != NULL) { *sub_args = '\0'; sub_args++; }
+
+    if (strcasecmp(args, "INICIO") == 0) {
+        float massas[MAX_PONTOS_CAL_BALANCA];
+        uint8_t n = 0;
+        char* ptr = sub_args;
+        while (ptr != NULL && n < MAX_PONTOS_CAL_BALANCA) {
+            while (isspace((unsigned char)*ptr)) ptr++;
+            if (*ptr == '\0') break;
+            char* fim;
+            massas[n] = strtof(ptr, &fim);
+            if (fim == ptr) { printf("Massa invalida: \"%s\"", ptr); return; }
+            n++;
+            ptr = fim;
+        }
+        if (!Calibracao_Balanca_Iniciar((n > 0) ? massas : NULL, n)) {
+            printf("Nao foi possivel iniciar (use de 2 a %d massas).", MAX_PONTOS_CAL_BALANCA);
+        }
+    } else if (strcasecmp(args, "OK") == 0) {
+        if (!Calibracao_Balanca_Confirmar_Ponto()) printf("Nenhum ponto aguardando confirmacao.");
+    } else if (strcasecmp(args, "CANCELA") == 0) {
+        Calibracao_Balanca_Cancelar();
+    } else {
+        printf("Subcomando CAL desconhecido: \"%s\"", args);
+    }
+}
+
+static void Cmd_Tara(char* args) {
+    if (args == NULL) {
+        if (Tara_Balanca_Em_Andamento()) { printf("Tara ja em andamento."); return; }
+        Tara_Balanca_Solicitar();
+        return;
+    }
+
+    char* sub_args = strchr(args, ' ');
+    if (sub_args != NULL) { *sub_args = '\0'; sub_args++; }
+
+    if (strcasecmp(args, "STATUS") == 0) {
+        static const char* const nomes[] = { "OCIOSA", "COLETANDO", "CONCLUIDA", "FALHOU" };
+        Tara_Status_t st;
+        Tara_Balanca_Get_Status(&st);
+        printf("Tara: %s", nomes[st.estado]);
+        if (st.estado == TARA_COLETANDO) {
+            printf(" (tentativa %u, %u%%)", (unsigned)st.tentativa, (unsigned)st.progresso_pct);
+        }
+        printf("\r\n  - Offset: %ld counts\r\n", (long)st.offset);
+        printf("  - Auto-zero: %s, correcao %ld counts em %lu ajustes\r\n",
+               st.auto_zero_ativo ? "ON" : "OFF", (long)st.auto_zero_correcao, (unsigned long)st.auto_zero_ajustes);
+    } else if (strcasecmp(args, "AZ") == 0 && sub_args != NULL) {
+        if (strcasecmp(sub_args, "ON") == 0) Tara_Balanca_Set_Auto_Zero(true);
+        else if (strcasecmp(sub_args, "OFF") == 0) Tara_Balanca_Set_Auto_Zero(false);
+        else printf("Use TARA AZ ON ou TARA AZ OFF.");
+    } else {
+        printf("Subcomando TARA desconhecido: \"%s\"", args);
+    }
+}
+
+static void Cmd_Filtro(char* args) {
+    static const char* const nomes[] = { "-", "MM", "MED", "EMA", "KAL" };
+    Config_Estagio_Filtro_t estagios[MAX_ESTAGIOS_FILTRO_BALANCA];
+    uint16_t degrau_mg = 0;
+    uint8_t n = Gerenciador_Config_Get_Filtro_Balanca(estagios, MAX_ESTAGIOS_FILTRO_BALANCA, &degrau_mg);
+
+    if (args == NULL) {
+        printf("Filtro da balanca: mediana de %u, %u estagio(s), degrau %u mg:\r\n",
+               (unsigned)Gerenciador_Config_Get_Mediana_Balanca(), (unsigned)n, (unsigned)degrau_mg);
+        for (uint8_t i = 0; i < n; i++) {
+            uint8_t t = (estagios[i].tipo <= SF_STAGE_KALMAN) ? estagios[i].tipo : 0;
+            printf("  %u) %s janela=%u a=%u b=%u\r\n", (unsigned)(i + 1), nomes[t],
+                   (unsigned)estagios[i].janela, (unsigned)estagios[i].param_a, (unsigned)estagios[i].param_b);
+        }
+        return;
+    }
+
+    char* sub_args = strchr(args, ' ');
+    if (sub_args != NULL) *sub_args = '\0';
+    bool eh_degrau = (strcasecmp(args, "DEGRAU") == 0);
+    bool eh_mediana = (strcasecmp(args, "MEDIANA") == 0);
+    if (sub_args != NULL) *sub_args = ' '; // Devolve o separador para o strtok abaixo
+
+    if (eh_mediana) {
+        uint8_t janela = (sub_args != NULL) ? (uint8_t)strtoul(sub_args + 1, NULL, 10) : 0;
+        if (!Gerenciador_Config_Set_Mediana_Balanca(janela)) {
+            printf("Use FILTRO MEDIANA <n>, n impar de %d a %d.", SF_MEDIAN_WIN_MIN, SF_MEDIAN_WIN_MAX);
+            return;
+        }
+        App_Manager_Aplicar_Filtro_Balanca();
+        return;
+    }
+    if (eh_degrau) {
+        if (sub_args == NULL) { printf("Use FILTRO DEGRAU <mg>."); return; }
+        degrau_mg = (uint16_t)strtoul(sub_args + 1, NULL, 10);
+    } else {
+        // Cada token: TIPO:p1[:p2] (ex.: "MED:5 MM:8" ou "KAL:4:2500")
+        n = 0;
+        memset(estagios, 0, sizeof(estagios));
+        for (char* tok = strtok(args, " "); tok != NULL; tok = strtok(NULL, " ")) {
+            if (n >= MAX_ESTAGIOS_FILTRO_BALANCA) { printf("Maximo de %d estagios.", MAX_ESTAGIOS_FILTRO_BALANCA); return; }
+            char* p1 = strchr(tok, ':');
+            if (p1 != NULL) { *p1 = '\0'; p1++; }
+            char* p2 = (p1 != NULL) ? strchr(p1, ':') : NULL;
+            if (p2 != NULL) { *p2 = '\0'; p2++; }
+            uint32_t a = (p1 != NULL) ? strtoul(p1, NULL, 10) : 0;
+            uint32_t b = (p2 != NULL) ? strtoul(p2, NULL, 10) : 0;
+            Config_Estagio_Filtro_t* e = &estagios[n];
+
+            if (strcasecmp(tok, "MM") == 0)       { e->tipo = SF_STAGE_MOVING_AVG; e->janela = (uint8_t)a; }
+            else if (strcasecmp(tok, "MED") == 0) { e->tipo = SF_STAGE_MEDIAN;     e->janela = (uint8_t)a; }
+            else if (strcasecmp(tok, "EMA") == 0) { e->tipo = SF_STAGE_EMA;        e->param_a = (uint16_t)a; }
+            else if (strcasecmp(tok, "KAL") == 0) { e->tipo = SF_STAGE_KALMAN;     e->param_a = (uint16_t)a; e->param_b = (uint16_t)b; }
+            else if (strcasecmp(tok, "NENHUM") == 0) { continue; }
+            else { printf("Estagio desconhecido: \"%s\"", tok); return; }
+            n++;
+        }
+    }
+
+    if (!Gerenciador_Config_Set_Filtro_Balanca(estagios, n, degrau_mg)) {
+        printf("Configuracao ocupada (salvando). Tente novamente.");
+        return;
+    }
+    App_Manager_Aplicar_Filtro_Balanca();
+}
+
+static void Cmd_Captura(char* args) {
+    if (args != NULL && strcasecmp(args, "PARA") == 0) {
+        App_Manager_Parar_Captura();
+        return;
+    }
+    App_Manager_Iniciar_Captura((args != NULL) ? (uint32_t)strtoul(args, NULL, 10) : 0);
+}
+
 static void Cmd_Dwin(char* args) {
     if (args == NULL) { printf("Subcomando DWIN faltando. Use 'HELP'."); return; }
     char* sub_cmd = args;
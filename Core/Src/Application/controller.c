@@ -6,8 +6,10 @@
 #include "controller.h"
 #include "dwin_driver.h" // Necessrio para ENUMs de Tela (PRINCIPAL, etc.)
 #include "rtc.h"
-#include "rtc_driver.h" 
 #include "gerenciador_configuracoes.h"
+#include "calibracao_balanca.h"
+#include "calculo_umidade.h"
+#include "app_eventos.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -38,6 +40,7 @@ static void Lidar_Com_VP_Senha(const uint8_t* dwin_data, uint16_t len);
 static void Atualizar_Display_Grao_Selecionado(int8_t indice);
 static void Lidar_Com_Selecao_De_Grao(int16_t tecla);
 static void Lidar_Com_Entrada_Tela_Graos(void);
+static void Lidar_Com_Tecla_Ajuste_Balanca(int16_t tecla);
 static void Tela_ON_OFF(void);
 static void Set_Just_Time_Parser(const uint8_t* rx_buffer, uint16_t rx_len); 
 static void Set_Active_Screen(uint16_t screen_id); // (V8.3) Wrapper de rastreamento
@@ -98,6 +101,8 @@ void Controller_DwinCallback(const uint8_t* data, uint16_t len)
             case TECLAS:            
                 if (s_em_tela_de_selecao) {
                     Lidar_Com_Selecao_De_Grao(received_value);
+                } else if (s_current_screen_id == TELA_ADJUST_SCALE) {
+                    Lidar_Com_Tecla_Ajuste_Balanca(received_value);
                 }
                 break;
             case SENHA:
@@ -108,6 +113,13 @@ void Controller_DwinCallback(const uint8_t* data, uint16_t len)
             case SET_TIME:          
                 Set_Just_Time_Parser(data, len);
                 break;
+            case NR_REPETICOES: // VP 0x3020 (Tela de setup das repeties)
+                if (Gerenciador_Config_Set_Repeticoes((uint8_t)received_value)) {
+                    printf("CONTROLLER: %d repeticoes por medicao.\r\n", received_value);
+                } else {
+                    DWIN_Driver_WriteInt(NR_REPETICOES, Gerenciador_Config_Get_Repeticoes());
+                }
+                break;
             
             // **** INCIO DA CORREO V8.4 ****
             case MONITOR: // VP 0x7090 (O usurio pressionou o boto MONITOR)
@@ -117,12 +129,23 @@ void Controller_DwinCallback(const uint8_t* data, uint16_t len)
                 printf("CONTROLLER: Entrando na Tela de Monitor do Sistema.\r\n");
                 break;
             
+            case ADJUST_SCALE: // VP 0x7040 (Menu Servio -> Ajuste da Balana)
+                Set_Active_Screen(TELA_ADJUST_SCALE); // Tela 51
+                if (!Calibracao_Balanca_Iniciar(NULL, 0)) {
+                    printf("CONTROLLER: Nao foi possivel iniciar a calibracao da balanca.\r\n");
+                }
+                break;
+            
             case ESCAPE: // VP 0x5000 (Provavelmente o boto "Voltar" do Monitor/Servio)
                 // Se estamos no monitor, voltamos para a tela de servio.
                 if (s_current_screen_id == TELA_MONITOR_SYSTEM) {
                      Set_Active_Screen(TELA_SERVICO); // Tela 46
                      printf("CONTROLLER: Saindo do Monitor -> Tela de Servico.\r\n");
                 }
+                else if (s_current_screen_id == TELA_ADJUST_SCALE) {
+                     Calibracao_Balanca_Cancelar();
+                     Set_Active_Screen(TELA_SERVICO);
+                }
                 // (Adicione outros 'else if' se o ESCAPE for usado em outras telas)
                 break;
             // **** FIM DA CORREO V8.4 ****
@@ -249,10 +272,13 @@ static void Lidar_Com_VP_Senha(const uint8_t* dwin_data, uint16_t len)
             if (strcmp(s_nova_senha_temporaria, senha_recebida) == 0) {
                 printf("Controller: Senhas coincidem. Salvando nova senha...\r\n");
                 
-                bool sucesso = Gerenciador_Config_Set_Senha(s_nova_senha_temporaria); // No-bloqueante
-
-                if (sucesso) printf("Controller: Nova senha definida na RAM. Sera salva em breve.\r\n");
-                else printf("Controller: ERRO ao definir a nova senha (FSM ocupada?)\r\n");
+                // Gravao pelo App Manager (assinante de EV_UI_NEW_PASSWORD_SET)
+                StringPayload_t nova_senha;
+                memset(&nova_senha, 0, sizeof(nova_senha));
+                strncpy(nova_senha.value, s_nova_senha_temporaria, sizeof(nova_senha.value) - 1);
+                if (!Eventos_Publicar(EV_UI_NEW_PASSWORD_SET, &nova_senha)) {
+                    printf("Controller: ERRO ao publicar a nova senha (fila cheia)\r\n");
+                }
                 
                 s_estado_senha_atual = ESTADO_SENHA_OCIOSO;
                 Set_Active_Screen(TELA_CONFIGURAR); 
@@ -308,7 +334,10 @@ static void Lidar_Com_Selecao_De_Grao(int16_t tecla)
             
             bool sucesso = Gerenciador_Config_Set_Grao_Ativo(s_indice_grao_selecionado);
 
-            if(sucesso) printf("Controller: Salvo na RAM. Sera persistido em breve.\r\n");
+            if(sucesso) {
+                printf("Controller: Salvo na RAM. Sera persistido em breve.\r\n");
+                Calculo_Umidade_Selecionar_Grao((uint8_t)s_indice_grao_selecionado);
+            }
             else printf("Controller: ERRO ao definir o grao ativo!\r\n");
             
             s_em_tela_de_selecao = false;
@@ -326,6 +355,27 @@ static void Lidar_Com_Selecao_De_Grao(int16_t tecla)
 }
 
 
+/**
+ * @brief Teclas da TELA_ADJUST_SCALE: CONFIRMA captura o ponto, ESCAPE aborta.
+ */
+static void Lidar_Com_Tecla_Ajuste_Balanca(int16_t tecla)
+{
+    switch (tecla)
+    {
+        case DWIN_TECLA_CONFIRMA:
+            if (!Calibracao_Balanca_Confirmar_Ponto()) {
+                printf("Controller: Nenhum ponto de calibracao aguardando confirmacao.\r\n");
+            }
+            break;
+        case DWIN_TECLA_ESCAPE:
+            Calibracao_Balanca_Cancelar();
+            Set_Active_Screen(TELA_SERVICO);
+            break;
+        default:
+            break;
+    }
+}
+
 static void Atualizar_Display_Grao_Selecionado(int8_t indice)
 {
     Config_Grao_t dados_grao;
@@ -384,8 +434,14 @@ static void Set_Just_Time_Parser(const uint8_t* rx_buffer, uint16_t rx_len)
 
         if (sscanf(time_str_safe, "%d:%d:%d", &hours, &minutes, &seconds) == 3)
         {
-            RTC_Driver_SetTime(hours, minutes, seconds); 
-            printf("RTC atualizado com sucesso para: %s\r\n", time_str_safe);
+            // Data zerada: s a hora muda (App Manager, assinante de EV_UI_DATETIME_ENTERED)
+            DateTimePayload_t hora = { 0 };
+            hora.hour = (uint8_t)hours;
+            hora.minute = (uint8_t)minutes;
+            hora.second = (uint8_t)seconds;
+            if (!Eventos_Publicar(EV_UI_DATETIME_ENTERED, &hora)) {
+                printf("RTC Driver: Fila de eventos cheia, hora '%s' descartada.\r\n", time_str_safe);
+            }
         }
         else
         {
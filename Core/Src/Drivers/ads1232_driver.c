@@ -1,16 +1,48 @@
 #include "ads1232_driver.h"
 #include "main.h"
+#include "tim.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <math.h>
 
+#include <string.h>
 
-static int32_t cal_zero_adc = 0; // ADC do ponto de 0 g da TABELA de calibrao
-static volatile bool g_ads_data_ready = false;
 
-// --- DEFINIO DA TABELA DE CALIBRAO ---
-// Os valores de adc_value devem ser preenchidos por voc com a rotina de calibrao
-CalPoint_t cal_points[NUM_CAL_POINTS] = {
+// --- Motor de Aquisio (SCLK gerado por interrupo do TIM3) ---
+// Cada interrupo do TIM3 produz UMA meia-borda de SCLK. 24 pulsos trazem os
+// bits de dados e o 25 fora DOUT/DRDY para nvel alto at a prxima converso.
+#define ADS1232_BITS_DADOS      24
+#define ADS1232_PULSOS_SCLK     25
+#define ADS1232_READ_TIMEOUT_MS 200
+
+typedef enum {
+    ADS_ACQ_DESLIGADO,   // Init ainda no foi chamado (ignora DRDY)
+    ADS_ACQ_OCIOSO,      // Aguardando a borda de descida de DRDY (EXTI PC5)
+    ADS_ACQ_SHIFT        // TIM3 deslocando os bits para fora
+} ADS_Acq_Estado_t;
+
+static volatile ADS_Acq_Estado_t s_acq_estado = ADS_ACQ_DESLIGADO;
+static volatile uint8_t  s_acq_meia_borda = 0;   // 0..(2*PULSOS-1)
+static volatile uint32_t s_acq_shift = 0;
+
+// --- Ring SPSC de amostras (produtor: ISR do TIM3 / consumidor: super-loop) ---
+// S o produtor escreve s_ring_head e s o consumidor escreve s_ring_tail.
+// Com ndices de 8 bits e tamanho potncia de 2 no h necessidade de seo crtica.
+#define ADS1232_RING_MASK       (ADS1232_RING_SIZE - 1u)
+
+static ADS1232_Sample_t  s_ring[ADS1232_RING_SIZE];
+static volatile uint8_t  s_ring_head = 0;
+static volatile uint8_t  s_ring_tail = 0;
+static volatile uint32_t s_seq = 0;               // Converses concludas (inclusive as descartadas)
+static volatile uint32_t s_stat_descartadas = 0;  // Amostras perdidas com o ring cheio
+static volatile uint32_t s_stat_overruns = 0;     // Episdios de ring cheio
+static volatile bool     s_ring_cheio = false;
+static uint8_t           s_stat_nivel_max = 0;    // Maior ocupao vista pelo consumidor
+
+// --- TABELA DE CALIBRAO PADRO (de fbrica) ---
+// Usada no Init at que a calibrao salva na EEPROM seja aplicada
+const CalPoint_t ADS1232_CAL_PADRAO[ADS1232_CAL_PADRAO_PONTOS] = {
     {0.0f, 235469},
     {50.0f, 546061},
     {100.0f, 856428},
@@ -19,132 +51,437 @@ CalPoint_t cal_points[NUM_CAL_POINTS] = {
 
 // --- Variveis Estticas ---
 static int32_t adc_offset = 0;
+static int32_t s_eff_shift = 0;      // adc_zero - adc_offset (reancora a leitura na curva)
 
-// --- Funes Privadas ---
-static void delay_us(uint32_t us) {
-    for(volatile uint32_t i = 0; i < us * 8; i++);
-}
+// Tabelas de segmentos em buffer duplo: as converses leem a ativa enquanto a outra
+//  remontada em segundo plano; a troca  s a atribuio do ponteiro.
+static ADS1232_CalTable_t  s_cal_tabelas[2];
+static ADS1232_CalTable_t* s_cal = &s_cal_tabelas[0];
 
-static void sort_three(int32_t *a, int32_t *b, int32_t *c) {
-    int32_t temp;
-    if (*a > *b) { temp = *a; *a = *b; *b = temp; }
-    if (*b > *c) { temp = *b; *b = *c; *c = temp; }
-    if (*a > *b) { temp = *a; *a = *b; *b = temp; }
-}
+typedef enum {
+    CAL_REBUILD_OCIOSO,
+    CAL_REBUILD_SEGMENTOS,   // Um segmento por chamada de ADS1232_Calibration_Process
+    CAL_REBUILD_PUBLICAR
+} CalRebuild_Estado_t;
+
+static struct {
+    CalRebuild_Estado_t estado;
+    CalPoint_t pontos[ADS1232_CAL_MAX_POINTS]; // J ordenados por ADC
+    uint8_t n;
+    uint8_t seg;
+} s_rebuild = { CAL_REBUILD_OCIOSO, {{0}}, 0, 0 };
 
 // --- Implementao das Funes Pblicas ---
 
+/**
+ * @brief (ISR EXTI) Borda de descida em DOUT/DRDY: converso pronta.
+ * Mascara o EXTI (DOUT vai alternar durante o shift) e dispara o TIM3.
+ */
 void Drv_ADS1232_DRDY_Callback(void)
 {
-    g_ads_data_ready = true;
+    if (s_acq_estado != ADS_ACQ_OCIOSO) {
+        return; // Bordas de DOUT durante o shift (ou driver desligado)
+    }
+
+    HAL_NVIC_DisableIRQ(AD_DOUT_BAL_EXTI_IRQn);
+
+    s_acq_estado = ADS_ACQ_SHIFT;
+    s_acq_meia_borda = 0;
+    s_acq_shift = 0;
+
+    __HAL_TIM_SET_COUNTER(&htim3, 0);
+    __HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_UPDATE);
+    HAL_TIM_Base_Start_IT(&htim3);
+}
+
+/**
+ * @brief (ISR TIM3) Gera uma meia-borda de SCLK.
+ * Borda par: SCLK sobe. Borda mpar: amostra DOUT e SCLK desce.
+ * Nunca mascara interrupes globais; cada chamada dura poucos microssegundos.
+ */
+void Drv_ADS1232_SCLK_Callback(void)
+{
+    if (s_acq_estado != ADS_ACQ_SHIFT) {
+        HAL_TIM_Base_Stop_IT(&htim3);
+        return;
+    }
+
+    uint8_t borda = s_acq_meia_borda;
+    uint8_t pulso = borda >> 1;
+
+    if ((borda & 1u) == 0u) {
+        HAL_GPIO_WritePin(AD_SCLK_BAL_GPIO_Port, AD_SCLK_BAL_Pin, GPIO_PIN_SET);
+    } else {
+        if (pulso < ADS1232_BITS_DADOS) {
+            s_acq_shift <<= 1;
+            if (HAL_GPIO_ReadPin(AD_DOUT_BAL_GPIO_Port, AD_DOUT_BAL_Pin) == GPIO_PIN_SET) {
+                s_acq_shift |= 1u;
+            }
+        }
+        HAL_GPIO_WritePin(AD_SCLK_BAL_GPIO_Port, AD_SCLK_BAL_Pin, GPIO_PIN_RESET);
+    }
+
+    borda++;
+    if (borda < (2u * ADS1232_PULSOS_SCLK)) {
+        s_acq_meia_borda = borda;
+        return;
+    }
+
+    // --- Converso completa ---
+    HAL_TIM_Base_Stop_IT(&htim3);
+
+    uint32_t data = s_acq_shift;
+    if (data & 0x800000) data |= 0xFF000000;
+
+    uint8_t head = s_ring_head;
+    uint8_t next = (uint8_t)((head + 1u) & ADS1232_RING_MASK);
+    uint32_t seq = s_seq + 1u;
+    s_seq = seq;
+    if (next == s_ring_tail) {
+        // Consumidor atrasado: descarta a amostra nova, preservando as mais antigas
+        s_stat_descartadas++;
+        if (!s_ring_cheio) {
+            s_ring_cheio = true;
+            s_stat_overruns++;
+        }
+    } else {
+        s_ring[head].raw  = (int32_t)data;
+        s_ring[head].seq  = seq;
+        s_ring[head].tick = HAL_GetTick();
+        s_ring_head = next; // Publica somente depois do slot estar completo
+        s_ring_cheio = false;
+    }
+
+    // Descarta as bordas de DOUT geradas pelo prprio shift antes de religar o EXTI
+    __HAL_GPIO_EXTI_CLEAR_FALLING_IT(AD_DOUT_BAL_Pin);
+    HAL_NVIC_ClearPendingIRQ(AD_DOUT_BAL_EXTI_IRQn);
+    s_acq_estado = ADS_ACQ_OCIOSO;
+    HAL_NVIC_EnableIRQ(AD_DOUT_BAL_EXTI_IRQn);
 }
 
 void ADS1232_Init(void) {
+    HAL_GPIO_WritePin(AD_SCLK_BAL_GPIO_Port, AD_SCLK_BAL_Pin, GPIO_PIN_RESET);
     HAL_GPIO_WritePin(AD_PDWN_BAL_GPIO_Port, AD_PDWN_BAL_Pin, GPIO_PIN_RESET);
     HAL_Delay(1); 
     HAL_GPIO_WritePin(AD_PDWN_BAL_GPIO_Port, AD_PDWN_BAL_Pin, GPIO_PIN_SET);
-		cal_zero_adc = cal_points[0].adc_value;
+    ADS1232_SetCalibration(ADS1232_CAL_PADRAO, ADS1232_CAL_PADRAO_PONTOS);
+
+    s_ring_head = 0;
+    s_ring_tail = 0;
+    s_seq = 0;
+    s_acq_estado = ADS_ACQ_OCIOSO; // A partir daqui o EXTI de DRDY inicia as leituras
+}
+
+/**
+ * @brief (No-bloqueante) Retira a amostra mais antiga do ring.
+ * @return false se o ring estiver vazio.
+ */
+bool ADS1232_Pop_Sample(ADS1232_Sample_t* out) {
+    uint8_t tail = s_ring_tail;
+    uint8_t head = s_ring_head;
+    if (tail == head || out == NULL) {
+        return false;
+    }
+    uint8_t nivel = (uint8_t)((head - tail) & ADS1232_RING_MASK);
+    if (nivel > s_stat_nivel_max) s_stat_nivel_max = nivel;
+
+    *out = s_ring[tail];
+    s_ring_tail = (uint8_t)((tail + 1u) & ADS1232_RING_MASK); // Libera o slot para o produtor
+    return true;
+}
+
+/**
+ * @brief (No-bloqueante) Retira at 'max' amostras de uma vez.
+ * @return Quantidade de amostras copiadas para 'buf'.
+ */
+uint32_t ADS1232_Drain(ADS1232_Sample_t* buf, uint32_t max) {
+    uint32_t n = 0;
+    while (n < max && ADS1232_Pop_Sample(&buf[n])) {
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief true se h amostra no ring (consulta do agendador; no retira nada).
+ */
+bool ADS1232_HasSample(void) {
+    return s_ring_tail != s_ring_head;
+}
+
+/**
+ * @brief Descarta tudo o que estiver no ring (ex.: antes da tara).
+ */
+void ADS1232_Flush(void) {
+    s_ring_tail = s_ring_head;
+}
+
+void ADS1232_GetStats(ADS1232_Stats_t* stats) {
+    if (stats == NULL) return;
+    stats->total_conversoes = s_seq;
+    stats->descartadas      = s_stat_descartadas;
+    stats->overruns         = s_stat_overruns;
+    stats->nivel_atual      = (uint8_t)((s_ring_head - s_ring_tail) & ADS1232_RING_MASK);
+    stats->nivel_max        = s_stat_nivel_max;
 }
 
+/**
+ * @brief (Bloqueante) Aguarda a PRXIMA amostra do ring (uma nova borda de DRDY).
+ * As interrupes continuam habilitadas; use apenas no boot/tara.
+ */
 int32_t ADS1232_Read(void) {
-    uint32_t data = 0;
+    static int32_t s_ultimo_valor = 0;
+    ADS1232_Sample_t amostra;
+    uint32_t inicio = HAL_GetTick();
 
-    __disable_irq();
-    for(int i = 0; i < 24; i++) {
-        HAL_GPIO_WritePin(AD_SCLK_BAL_GPIO_Port, AD_SCLK_BAL_Pin, GPIO_PIN_SET);
-        delay_us(1);
-        data = data << 1;
-        if(HAL_GPIO_ReadPin(AD_DOUT_BAL_GPIO_Port, AD_DOUT_BAL_Pin) == GPIO_PIN_SET) data |= 1;
-        HAL_GPIO_WritePin(AD_SCLK_BAL_GPIO_Port, AD_SCLK_BAL_Pin, GPIO_PIN_RESET);
-        delay_us(1);
+    while (!ADS1232_Pop_Sample(&amostra)) {
+        if (HAL_GetTick() - inicio > ADS1232_READ_TIMEOUT_MS) {
+            return s_ultimo_valor; // ADC no respondeu; devolve a ltima leitura conhecida
+        }
     }
-    HAL_GPIO_WritePin(AD_SCLK_BAL_GPIO_Port, AD_SCLK_BAL_Pin, GPIO_PIN_SET);
-    delay_us(1);
-    HAL_GPIO_WritePin(AD_SCLK_BAL_GPIO_Port, AD_SCLK_BAL_Pin, GPIO_PIN_RESET);
-    __enable_irq();
+    s_ultimo_valor = amostra.raw;
+    return amostra.raw;
+}
 
-    if (data & 0x800000) data |= 0xFF000000;
-    return (int32_t)data;
-}
-
-int32_t ADS1232_Read_Median_of_3(void) {
-    int32_t s1 = ADS1232_Read();
-    int32_t s2 = ADS1232_Read();
-    int32_t s3 = ADS1232_Read();
-    sort_three(&s1, &s2, &s3);
-    return s2;
-}
-
-int32_t ADS1232_Tare(void) { 
-    printf("Tarando... Aguarde estabilidade.\r\n");
-    const int num_samples = 32;
-    const int32_t stability_threshold = 300;
-    int max_retries = 10;
-    
-    for (int retry = 0; retry < max_retries; retry++) {
-        int64_t sum = 0;
-        int32_t min_val = 0x7FFFFFFF, max_val = 0x80000000;
-        for (int i = 0; i < num_samples; i++) {
-            int32_t sample = ADS1232_Read_Median_of_3();
-            sum += sample;
-            if (sample < min_val) min_val = sample;
-            if (sample > max_val) max_val = sample;
-            HAL_Delay(10);
+//================================================================================
+// Calibrao: tabela de segmentos pr-calculada
+//================================================================================
+
+// Valida e copia os pontos ordenados por ADC (insero: n  pequeno e isto s roda ao calibrar)
+static bool cal_ordenar(const CalPoint_t* pontos, uint8_t n, CalPoint_t* p)
+{
+    if (pontos == NULL || n < 2 || n > ADS1232_CAL_MAX_POINTS) {
+        return false;
+    }
+    for (uint8_t i = 0; i < n; i++) {
+        CalPoint_t novo = pontos[i];
+        int j = (int)i - 1;
+        while (j >= 0 && p[j].adc_value > novo.adc_value) {
+            p[j + 1] = p[j];
+            j--;
         }
-        if ((max_val - min_val) < stability_threshold) {
-            adc_offset = (int32_t)(sum / num_samples);
-            printf("Tara estavel concluida! Offset = %d\r\n", (int)adc_offset);
-            return adc_offset; 
+        p[j + 1] = novo;
+    }
+    for (uint8_t i = 0; i < n - 1; i++) {
+        if (p[i + 1].adc_value == p[i].adc_value) {
+            return false; // ADC repetido: segmento sem inclinao definida
         }
-        printf("Leituras instaveis (diff: %d). Tentando novamente...\r\n", (int)(max_val - min_val));
     }
-    printf("AVISO: Balanca nao estabilizou.\r\n");
-    return adc_offset; // Retorna o offset antigo se falhar
+    return true;
 }
 
-float ADS1232_ConvertToGrams(int32_t raw_value)
+// Inclinao e intercepto do segmento i (pontos j ordenados)
+static void cal_montar_segmento(const CalPoint_t* p, uint8_t i, ADS1232_CalTable_t* out)
 {
-    // 1) Leitura lquida: remove a tara medida (adc_offset)
-    // 2) Reancora na curva de calibrao somando o ADC de 0 g da tabela
-    //    => efetivamente "move" a leitura atual para o mesmo referencial da calibrao
-    int32_t eff_adc = (raw_value - adc_offset) + cal_zero_adc;
-
-    // 3) Interpolao linear no segmento correspondente
-    for (int i = 0; i < NUM_CAL_POINTS - 1; i++) {
-        int32_t x1 = cal_points[i].adc_value;
-        int32_t x2 = cal_points[i+1].adc_value;
-        if (eff_adc >= x1 && eff_adc <= x2) {
-            float y1 = cal_points[i].grams;
-            float y2 = cal_points[i+1].grams;
-            float dx = (float)(x2 - x1);
-            if (dx == 0.0f) return y1;
-            float m  = (y2 - y1) / dx;              // g / count
-            return y1 + m * (eff_adc - x1);
+    int32_t dx = p[i + 1].adc_value - p[i].adc_value;
+#if SCALE_FIXED_POINT
+    int32_t mg1 = (int32_t)lrintf(p[i].grams * 1000.0f);
+    int32_t mg2 = (int32_t)lrintf(p[i + 1].grams * 1000.0f);
+    int64_t dy  = (int64_t)(mg2 - mg1) * (1LL << SCALE_Q_SLOPE);
+    int32_t m   = (int32_t)((dy + dx / 2) / dx);
+    out->slope_q24[i]     = m;
+    out->intercept_q24[i] = (int64_t)mg1 * (1LL << SCALE_Q_SLOPE) - (int64_t)m * p[i].adc_value;
+#else
+    float m = (p[i + 1].grams - p[i].grams) / (float)dx;
+    out->slope_g[i]     = m;
+    out->intercept_g[i] = p[i].grams - m * (float)p[i].adc_value;
+#endif
+    out->breakpoints[i] = p[i].adc_value;
+}
+
+// Fecha a tabela: ltimo breakpoint e ADC onde a curva vale 0 g ( nele que a tara reancora as leituras)
+static void cal_finalizar(const CalPoint_t* p, uint8_t n, ADS1232_CalTable_t* out)
+{
+    out->n_segmentos = (uint8_t)(n - 1);
+    out->breakpoints[n - 1] = p[n - 1].adc_value;
+
+    if (p[0].grams == 0.0f) {
+        out->adc_zero = p[0].adc_value;
+        return;
+    }
+    int zero_seg = (p[0].grams > 0.0f) ? 0 : (n - 2);
+    for (uint8_t i = 0; i < n - 1; i++) {
+        if ((p[i].grams <= 0.0f) != (p[i + 1].grams <= 0.0f)) {
+            zero_seg = i;
+            break;
         }
     }
+    float m = (p[zero_seg + 1].grams - p[zero_seg].grams) /
+              (float)(p[zero_seg + 1].adc_value - p[zero_seg].adc_value);
+    out->adc_zero = (m != 0.0f) ? p[zero_seg].adc_value + (int32_t)lrintf(-p[zero_seg].grams / m)
+                                : p[zero_seg].adc_value;
+}
+
+/**
+ * @brief Monta a tabela de segmentos a partir de 'n' pontos (em qualquer ordem).
+ * @return false se houver menos de 2 pontos, mais que ADS1232_CAL_MAX_POINTS
+ *         ou dois pontos com o mesmo ADC.
+ */
+bool ADS1232_BuildCalTable(const CalPoint_t* pontos, uint8_t n, ADS1232_CalTable_t* out)
+{
+    CalPoint_t p[ADS1232_CAL_MAX_POINTS];
+
+    if (out == NULL || !cal_ordenar(pontos, n, p)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < n - 1; i++) {
+        cal_montar_segmento(p, i, out);
+    }
+    cal_finalizar(p, n, out);
+    return true;
+}
+
+// Torna 'nova' a tabela ativa (contexto do superloop, o mesmo das converses)
+static void cal_publicar(ADS1232_CalTable_t* nova)
+{
+    s_cal = nova;
+    s_eff_shift = s_cal->adc_zero - adc_offset;
+}
 
-    // 4) Extrapolao linear (para cima e para baixo) com os extremos CORRETAMENTE
-    if (NUM_CAL_POINTS >= 2) {
-        // abaixo do menor ponto
-        if (eff_adc < cal_points[0].adc_value) {
-            int32_t x1 = cal_points[0].adc_value;
-            int32_t x2 = cal_points[1].adc_value;
-            float   y1 = cal_points[0].grams;
-            float   y2 = cal_points[1].grams;
-            float   m  = (y2 - y1) / (float)(x2 - x1);
-            return y1 + m * (eff_adc - x1);
+/**
+ * @brief (Bloqueante, boot) Monta e ativa uma nova calibrao de imediato.
+ * A anterior  mantida se os pontos forem invlidos.
+ */
+bool ADS1232_SetCalibration(const CalPoint_t* pontos, uint8_t n)
+{
+    ADS1232_CalTable_t* sombra = (s_cal == &s_cal_tabelas[0]) ? &s_cal_tabelas[1] : &s_cal_tabelas[0];
+    if (!ADS1232_BuildCalTable(pontos, n, sombra)) {
+        return false;
+    }
+    s_rebuild.estado = CAL_REBUILD_OCIOSO; // Uma remontagem pendente ficaria obsoleta
+    cal_publicar(sombra);
+    return true;
+}
+
+/**
+ * @brief (No-bloqueante) Agenda a remontagem da tabela em segundo plano.
+ * A tabela atual continua convertendo at ADS1232_Calibration_Process publicar a nova.
+ * @return false se os pontos forem invlidos (nada  agendado).
+ */
+bool ADS1232_RequestCalibration(const CalPoint_t* pontos, uint8_t n)
+{
+    CalPoint_t p[ADS1232_CAL_MAX_POINTS];
+    if (!cal_ordenar(pontos, n, p)) {
+        return false;
+    }
+    memcpy(s_rebuild.pontos, p, n * sizeof(CalPoint_t));
+    s_rebuild.n = n;
+    s_rebuild.seg = 0;
+    s_rebuild.estado = CAL_REBUILD_SEGMENTOS;
+    return true;
+}
+
+/**
+ * @brief Avana a remontagem em segundo plano (chamar no superloop).
+ * Cada chamada faz no mximo um segmento, sem interromper a aquisio.
+ */
+void ADS1232_Calibration_Process(void)
+{
+    ADS1232_CalTable_t* sombra = (s_cal == &s_cal_tabelas[0]) ? &s_cal_tabelas[1] : &s_cal_tabelas[0];
+
+    switch (s_rebuild.estado)
+    {
+        case CAL_REBUILD_SEGMENTOS:
+            cal_montar_segmento(s_rebuild.pontos, s_rebuild.seg, sombra);
+            s_rebuild.seg++;
+            if (s_rebuild.seg >= s_rebuild.n - 1) {
+                s_rebuild.estado = CAL_REBUILD_PUBLICAR;
+            }
+            break;
+
+        case CAL_REBUILD_PUBLICAR:
+            cal_finalizar(s_rebuild.pontos, s_rebuild.n, sombra);
+            cal_publicar(sombra);
+            s_rebuild.estado = CAL_REBUILD_OCIOSO;
+            printf("ADS1232: Nova tabela de calibracao ativa (%u pontos).\r\n", (unsigned)s_rebuild.n);
+            break;
+
+        case CAL_REBUILD_OCIOSO:
+        default:
+            break;
+    }
+}
+
+bool ADS1232_Calibration_IsBusy(void)
+{
+    return s_rebuild.estado != CAL_REBUILD_OCIOSO;
+}
+
+/**
+ * @brief Copia a tabela ativa (para diagnstico).
+ */
+void ADS1232_GetCalTable(ADS1232_CalTable_t* out)
+{
+    if (out != NULL) {
+        *out = *s_cal;
+    }
+}
+
+// Busca binria do segmento: maior i com breakpoints[i] <= x (extremos extrapolam)
+static uint8_t find_segment(int32_t eff_adc)
+{
+    uint8_t lo = 0;
+    if (s_cal->n_segmentos == 0) {
+        return 0; // Tabela ainda no montada (antes do Init)
+    }
+    uint8_t hi = s_cal->n_segmentos - 1;
+    while (lo < hi) {
+        uint8_t mid = (uint8_t)((lo + hi + 1) >> 1);
+        if (s_cal->breakpoints[mid] <= eff_adc) {
+            lo = mid;
+        } else {
+            hi = (uint8_t)(mid - 1);
         }
-        // acima do maior ponto
-        int32_t x1 = cal_points[NUM_CAL_POINTS - 2].adc_value;
-        int32_t x2 = cal_points[NUM_CAL_POINTS - 1].adc_value;
-        float   y1 = cal_points[NUM_CAL_POINTS - 2].grams;
-        float   y2 = cal_points[NUM_CAL_POINTS - 1].grams;
-        float   m  = (y2 - y1) / (float)(x2 - x1);
-        return y2 + m * (eff_adc - x2); 
     }
+    return lo;
+}
+
+#if SCALE_FIXED_POINT
+/**
+ * @brief (Ponto fixo) Converte counts brutos para miligramas: uma busca e um MAC.
+ */
+int32_t ADS1232_ConvertToMilligrams(int32_t raw_value)
+{
+    // Leitura lquida (tara) reancorada no ADC de 0 g da curva
+    int32_t eff_adc = raw_value + s_eff_shift;
+    uint8_t i = find_segment(eff_adc);
+    int64_t y = s_cal->intercept_q24[i] + (int64_t)s_cal->slope_q24[i] * eff_adc;
+    return (int32_t)((y + SCALE_Q_SLOPE_HALF) >> SCALE_Q_SLOPE);
+}
 
-    return 0.0f;
+/**
+ * @brief (Ponto fixo) Ganho local da curva em mg/count (Q24).
+ */
+int32_t ADS1232_GetMgPerCount_Q24(int32_t raw_value)
+{
+    return s_cal->slope_q24[find_segment(raw_value + s_eff_shift)];
+}
+
+float ADS1232_ConvertToGrams(int32_t raw_value)
+{
+    return (float)ADS1232_ConvertToMilligrams(raw_value) / 1000.0f;
+}
+
+float ADS1232_GetGramsPerCount(int32_t raw_value)
+{
+    return (float)ADS1232_GetMgPerCount_Q24(raw_value) / (1000.0f * (float)(1L << SCALE_Q_SLOPE));
+}
+#else
+float ADS1232_ConvertToGrams(int32_t raw_value)
+{
+    int32_t eff_adc = raw_value + s_eff_shift;
+    uint8_t i = find_segment(eff_adc);
+    return s_cal->intercept_g[i] + s_cal->slope_g[i] * (float)eff_adc;
+}
+
+/**
+ * @brief Ganho local da curva (g/count) no ponto 'raw_value'.
+ */
+float ADS1232_GetGramsPerCount(int32_t raw_value)
+{
+    return s_cal->slope_g[find_segment(raw_value + s_eff_shift)];
 }
+#endif
 
 int32_t ADS1232_GetOffset(void) {
     return adc_offset;
@@ -152,4 +489,5 @@ int32_t ADS1232_GetOffset(void) {
 
 void ADS1232_SetOffset(int32_t new_offset) {
     adc_offset = new_offset;
+    s_eff_shift = s_cal->adc_zero - adc_offset;
 }
\ No newline at end of file
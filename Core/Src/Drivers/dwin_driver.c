@@ -173,6 +173,12 @@ void DWIN_Driver_Process(void)
     }
 }
 
+bool DWIN_Driver_Pendente(void)
+{
+    return s_rx_pending_data || s_rx_needs_reset || (s_rx_error_cooldown_tick != 0u) ||
+           (!s_dma_tx_busy && (s_tx_fifo_head != s_tx_fifo_tail));
+}
+
 void DWIN_TX_Pump(void)
 {
     if (s_dma_tx_busy || (s_tx_fifo_head == s_tx_fifo_tail))
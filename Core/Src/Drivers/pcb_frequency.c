@@ -1,27 +1,433 @@
+/*******************************************************************************
+ * @file        pcb_frequency.c
+ * @brief       Medio da frequncia do sensor capacitivo (PA5 / TIM2_CH1).
+ * @details     Dois mtodos, selecionveis em tempo de execuo:
+ *
+ * CONTAGEM (janela em hardware):
+ * - TIM2 conta os pulsos do PA5 (clock externo) livremente, sem reset;
+ * - TIM1 (48 MHz / 48000 = 1 kHz) gera um evento de update a cada janela;
+ * - o update do TIM1 pede ao DMA1 canal 5 uma cpia do TIM2->CNT para um ring
+ *   circular. Janelas consecutivas, sem buracos e sem jitter de software.
+ * Pulsos da janela = diferena entre duas capturas (aritmtica mdulo 2^32).
+ * Resoluo = 1 / janela (1 Hz em 1 s).
+ *
+ * RECPROCO (carimbo de tempo das bordas):
+ * - TIM2 conta o clock interno de 48 MHz; o PA5 entra como input capture do
+ *   CH1 com prescaler /8 (uma captura a cada 8 bordas);
+ * - cada captura pede ao DMA1 canal 5 a cpia do CCR1 para UMA palavra fixa
+ *   (memria sem incremento): a palavra  o carimbo da ltima captura e o
+ *   CNDTR, decrementado a cada transferncia, conta as capturas;
+ * - ao fim de cada janela curta: f = 8 * capturas * 48 MHz / (t_ultima - t_primeira).
+ * A janela termina no tick do superloop, mas as duas pontas so bordas reais
+ * do sinal carimbadas em hardware: o jitter de software no entra na conta.
+ * Resoluo ~ f / (48 MHz * janela): ~0.4 Hz a 2 MHz em 100 ms. As ltimas
+ * FREQ_RECIP_MEDIA janelas so somadas (equivale a uma janela mais longa).
+ * Resultados seguidos dessa soma se sobrepem; quem faz estatstica usa o da
+ * janela mais recente sozinha (Frequency_Get_Janela_cHz).
+ ******************************************************************************/
+
 #include "pcb_frequency.h"
 #include "tim.h"  // Garante acesso ao handle htim2
+#include <string.h>
+
+#define FREQ_GATE_PRESCALER   47999u  // 48 MHz -> 1 kHz (1 tick = 1 ms)
+#define FREQ_RECIP_DMA_N      65535u  // Maior CNDTR: o contador de capturas  mdulo N
+#define FREQ_RECIP_POLL_MAX_MS 100u   // Teto do intervalo entre leituras (ver Limite_Poll_Reciproco_ms)
+
+static TIM_HandleTypeDef s_htim_gate;
+static DMA_HandleTypeDef s_hdma_gate;
+static Freq_Modo_t s_modo;
+static uint32_t s_janela_ms;
+static uint32_t s_clock_tim_hz;
+static uint32_t s_freq_chz;
+static uint32_t s_janela_chz;        // S a ltima janela (sem sobreposio entre resultados)
+static bool s_janela_fixada;         // Janela escolhida por Frequency_Set_Janela_ms
+static Frequency_Stats_t s_stats;
+static uint32_t s_ultimo_poll_ms;
+
+// --- Modo contagem ---
+static volatile uint32_t s_capturas[FREQ_RING_CAPTURAS]; // Escrito s pelo DMA
+static uint16_t s_idx_lido;          // Prxima captura a consumir
+static uint32_t s_ultima_captura;
+static bool     s_tem_referencia;    // J existe uma captura anterior vlida
+
+// --- Modo recproco ---
+static volatile uint32_t s_ic_carimbo; // TIM2->CCR1 da captura mais recente (escrito pelo DMA)
+
+static struct {
+    uint16_t cndtr_ant;
+    bool     referencia;      // t_inicio  o carimbo de uma captura real
+    uint32_t t_inicio;        // ltima captura da janela anterior (incio desta)
+    uint32_t t_ultimo;        // Captura mais recente
+    uint32_t capturas;        // Capturas desde t_inicio
+    uint32_t inicio_ms;       // Tick em que a janela atual comeou
+    uint32_t hist_capturas[FREQ_RECIP_MEDIA_MAX];
+    uint32_t hist_ticks[FREQ_RECIP_MEDIA_MAX];
+    uint8_t  hist_idx;
+    uint8_t  hist_cont;
+} s_rc;
+
+//================================================================================
+// Configurao do hardware
+//================================================================================
+
+static void Configurar_DMA(uint32_t request, uint32_t origem, uint32_t destino,
+                           uint32_t mem_inc, uint32_t tamanho)
+{
+  s_hdma_gate.Instance = DMA1_Channel5;
+  s_hdma_gate.Init.Request = request;
+  s_hdma_gate.Init.Direction = DMA_PERIPH_TO_MEMORY;
+  s_hdma_gate.Init.PeriphInc = DMA_PINC_DISABLE;
+  s_hdma_gate.Init.MemInc = mem_inc;
+  s_hdma_gate.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+  s_hdma_gate.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+  s_hdma_gate.Init.Mode = DMA_CIRCULAR;
+  s_hdma_gate.Init.Priority = DMA_PRIORITY_HIGH;
+  if (HAL_DMA_Init(&s_hdma_gate) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  // Sem IRQ: o loop s olha o CNDTR
+  if (HAL_DMA_Start(&s_hdma_gate, origem, destino, tamanho) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+static void Configurar_TIM2_Entrada(uint32_t modo_escravo)
+{
+  TIM_SlaveConfigTypeDef sSlaveConfig = {0};
+
+  // EXTERNAL1: o PA5  o clock do TIM2. DISABLE: clock interno (48 MHz).
+  sSlaveConfig.SlaveMode = modo_escravo;
+  sSlaveConfig.InputTrigger = TIM_TS_TI1FP1;
+  sSlaveConfig.TriggerPolarity = TIM_TRIGGERPOLARITY_RISING;
+  sSlaveConfig.TriggerFilter = 0;
+  if (HAL_TIM_SlaveConfigSynchro(&htim2, &sSlaveConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+static void Parar_Medicao(void)
+{
+  __HAL_TIM_DISABLE_DMA(&s_htim_gate, TIM_DMA_UPDATE);
+  __HAL_TIM_DISABLE_DMA(&htim2, TIM_DMA_CC1);
+  HAL_TIM_Base_Stop(&s_htim_gate);
+  if (s_modo == FREQ_MODO_RECIPROCO)
+  {
+    HAL_TIM_IC_Stop(&htim2, TIM_CHANNEL_1);
+  }
+  else
+  {
+    HAL_TIM_Base_Stop(&htim2);
+  }
+  HAL_DMA_Abort(&s_hdma_gate);
+  HAL_DMA_DeInit(&s_hdma_gate);
+}
+
+static void Iniciar_Contagem(void)
+{
+  Configurar_TIM2_Entrada(TIM_SLAVEMODE_EXTERNAL1);
+  Configurar_DMA(DMA_REQUEST_TIM1_UP, (uint32_t)&TIM2->CNT, (uint32_t)s_capturas,
+                 DMA_MINC_ENABLE, FREQ_RING_CAPTURAS);
+
+  s_idx_lido = 0;
+  s_tem_referencia = false;
+  s_stats.janela_ms = s_janela_ms;
+  s_stats.media_janelas = 1;
+
+  // Inicia o timer 2. Ele vai contar os pulsos em background (sem nunca zerar).
+  HAL_TIM_Base_Start(&htim2);
+  __HAL_TIM_SET_AUTORELOAD(&s_htim_gate, s_janela_ms - 1);
+  __HAL_TIM_SET_COUNTER(&s_htim_gate, 0);
+  s_htim_gate.Instance->EGR = TIM_EGR_UG; // Carrega o ARR novo antes de habilitar o DMA
+  __HAL_TIM_ENABLE_DMA(&s_htim_gate, TIM_DMA_UPDATE);
+  HAL_TIM_Base_Start(&s_htim_gate);
+}
+
+static void Iniciar_Reciproco(void)
+{
+  TIM_IC_InitTypeDef sConfigIC = {0};
+
+  Configurar_TIM2_Entrada(TIM_SLAVEMODE_DISABLE);
+  sConfigIC.ICPolarity = TIM_INPUTCHANNELPOLARITY_RISING;
+  sConfigIC.ICSelection = TIM_ICSELECTION_DIRECTTI;
+  sConfigIC.ICPrescaler = TIM_ICPSC_DIV8;
+  sConfigIC.ICFilter = 0;
+  if (HAL_TIM_IC_ConfigChannel(&htim2, &sConfigIC, TIM_CHANNEL_1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  Configurar_DMA(DMA_REQUEST_TIM2_CH1, (uint32_t)&TIM2->CCR1, (uint32_t)&s_ic_carimbo,
+                 DMA_MINC_DISABLE, FREQ_RECIP_DMA_N);
+
+  memset(&s_rc, 0, sizeof(s_rc));
+  s_rc.cndtr_ant = (uint16_t)FREQ_RECIP_DMA_N;
+  s_rc.inicio_ms = HAL_GetTick();
+  s_stats.janela_ms = s_janela_ms;
+  s_stats.media_janelas = FREQ_RECIP_MEDIA;
+
+  __HAL_TIM_ENABLE_DMA(&htim2, TIM_DMA_CC1);
+  HAL_TIM_IC_Start(&htim2, TIM_CHANNEL_1);
+}
 
 /**
- * @brief Inicia o Timer 2 no modo de contagem de pulsos.
+ * @brief Zera resultados/estatsticas e liga o hardware do modo atual.
  */
-void Frequency_Init(void)
+static void Reiniciar_Medicao(void)
 {
-  // Inicia o timer 2. Ele vai contar os pulsos em background.
-  HAL_TIM_Base_Start(&htim2);
+  s_freq_chz = 0;
+  s_janela_chz = 0;
+  s_stats.modo = s_modo;
+  s_stats.janelas = 0;
+  s_stats.perdidas = 0;
+  s_stats.bordas = 0;
+  s_stats.ticks = 0;
+  s_ultimo_poll_ms = HAL_GetTick();
+
+  if (s_modo == FREQ_MODO_RECIPROCO)
+  {
+    Iniciar_Reciproco();
+  }
+  else
+  {
+    Iniciar_Contagem();
+  }
+}
+
+//================================================================================
+// Processamento
+//================================================================================
+
+static bool Processar_Contagem(uint32_t agora)
+{
+  uint16_t idx_dma = (uint16_t)((FREQ_RING_CAPTURAS - s_hdma_gate.Instance->CNDTR) % FREQ_RING_CAPTURAS);
+  bool nova = false;
+
+  // Sem leitura por quase um ring inteiro: o ndice do DMA pode ter dado a volta.
+  // Descarta a referncia em vez de calcular uma janela com pulsos de vrias.
+  if ((agora - s_ultimo_poll_ms) >= (uint32_t)(FREQ_RING_CAPTURAS - 1) * s_stats.janela_ms)
+  {
+    s_tem_referencia = false;
+    s_idx_lido = idx_dma;
+    s_stats.perdidas++;
+  }
+
+  while (s_idx_lido != idx_dma)
+  {
+    uint32_t captura = s_capturas[s_idx_lido];
+    if (s_tem_referencia)
+    {
+      uint32_t pulsos = captura - s_ultima_captura; // Correto mesmo com o TIM2 dando a volta
+      s_freq_chz = (uint32_t)(((uint64_t)pulsos * 100000u) / s_stats.janela_ms);
+      s_janela_chz = s_freq_chz;
+      s_stats.janelas++;
+      nova = true;
+    }
+    s_ultima_captura = captura;
+    s_tem_referencia = true;
+    s_idx_lido = (uint16_t)((s_idx_lido + 1) % FREQ_RING_CAPTURAS);
+  }
+  return nova;
+}
+
+/**
+ * @brief Par (carimbo, CNDTR) da mesma captura.
+ * Rel o carimbo at ele no mudar em volta da leitura do CNDTR. O intervalo
+ * entre capturas (8 bordas)  muito maior que essas trs leituras.
+ */
+static void Ler_Captura_Consistente(uint32_t* carimbo, uint16_t* cndtr)
+{
+  uint32_t v1, v2;
+  uint16_t n;
+  do {
+    v1 = s_ic_carimbo;
+    n = (uint16_t)s_hdma_gate.Instance->CNDTR;
+    v2 = s_ic_carimbo;
+  } while (v1 != v2);
+  *carimbo = v1;
+  *cndtr = n;
+}
+
+static uint32_t Reciproco_cHz(uint64_t capturas, uint64_t ticks)
+{
+  if (capturas == 0 || ticks == 0)
+  {
+    return 0; // Sem bordas
+  }
+  // f [cHz] = 8 * capturas * clock * 100 / ticks (arredondado)
+  uint64_t num = capturas * FREQ_RECIP_DIV_IC * (uint64_t)s_clock_tim_hz * 100u;
+  return (uint32_t)((num + ticks / 2u) / ticks);
+}
+
+static void Publicar_Reciproco(void)
+{
+  uint64_t capturas = 0;
+  uint64_t ticks = 0;
+  for (uint8_t i = 0; i < s_rc.hist_cont; i++)
+  {
+    capturas += s_rc.hist_capturas[i];
+    ticks += s_rc.hist_ticks[i];
+  }
+  s_freq_chz = Reciproco_cHz(capturas, ticks);
 }
 
 /**
- * @brief Zera o contador de pulsos do timer.
+ * @brief Maior intervalo entre leituras antes de o CNDTR poder dar a volta:
+ * metade do tempo de FREQ_RECIP_DMA_N capturas na ltima frequncia medida
+ * (~99 ms a 2.65 MHz), limitado a FREQ_RECIP_POLL_MAX_MS.
  */
-void Frequency_Reset(void)
+static uint32_t Limite_Poll_Reciproco_ms(void)
 {
-  __HAL_TIM_SET_COUNTER(&htim2, 0);
+  if (s_freq_chz == 0)
+  {
+    return FREQ_RECIP_POLL_MAX_MS; // Ainda sem taxa medida
+  }
+  // capturas/s = f / 8 = cHz / 800
+  uint64_t limite = ((uint64_t)(FREQ_RECIP_DMA_N / 2u) * 1000u * 100u * FREQ_RECIP_DIV_IC) / s_freq_chz;
+  return (limite < FREQ_RECIP_POLL_MAX_MS) ? (uint32_t)limite : FREQ_RECIP_POLL_MAX_MS;
 }
 
+static bool Processar_Reciproco(uint32_t agora)
+{
+  uint32_t carimbo;
+  uint16_t cndtr;
+  Ler_Captura_Consistente(&carimbo, &cndtr);
+
+  if ((agora - s_ultimo_poll_ms) > Limite_Poll_Reciproco_ms())
+  {
+    // Capturas podem ter se perdido na volta do CNDTR: recomea a janela
+    s_rc.referencia = false;
+    s_rc.capturas = 0;
+    s_rc.cndtr_ant = cndtr;
+    s_rc.inicio_ms = agora;
+    s_stats.perdidas++;
+    return false;
+  }
+
+  uint32_t novas = ((uint32_t)s_rc.cndtr_ant + FREQ_RECIP_DMA_N - cndtr) % FREQ_RECIP_DMA_N;
+  s_rc.cndtr_ant = cndtr;
+  if (novas > 0)
+  {
+    if (!s_rc.referencia)
+    {
+      s_rc.t_inicio = carimbo; // A janela comea exatamente numa borda
+      s_rc.referencia = true;
+    }
+    else
+    {
+      s_rc.capturas += novas;
+    }
+    s_rc.t_ultimo = carimbo;
+  }
+
+  if ((agora - s_rc.inicio_ms) < s_stats.janela_ms)
+  {
+    return false;
+  }
+  s_rc.inicio_ms = agora;
+
+  uint32_t ticks = s_rc.capturas ? (s_rc.t_ultimo - s_rc.t_inicio) : 0;
+  s_rc.hist_capturas[s_rc.hist_idx] = s_rc.capturas;
+  s_rc.hist_ticks[s_rc.hist_idx] = ticks;
+  s_rc.hist_idx = (uint8_t)((s_rc.hist_idx + 1) % s_stats.media_janelas);
+  if (s_rc.hist_cont < s_stats.media_janelas) s_rc.hist_cont++;
+
+  s_stats.bordas = s_rc.capturas * FREQ_RECIP_DIV_IC;
+  s_stats.ticks = ticks;
+  s_stats.janelas++;
+  s_janela_chz = Reciproco_cHz(s_rc.capturas, ticks);
+
+  s_rc.t_inicio = s_rc.t_ultimo; // Prxima janela emenda nesta (sem buracos)
+  s_rc.capturas = 0;
+
+  Publicar_Reciproco();
+  return true;
+}
+
+//================================================================================
+// Funes Pblicas
+//================================================================================
+
 /**
- * @brief L o valor atual do contador de pulsos do timer de 32 bits.
+ * @brief Prepara o TIM1 (gate do modo contagem) e inicia o modo padro.
  */
-uint32_t Frequency_Get_Pulse_Count(void)
+void Frequency_Init(void)
 {
-  return __HAL_TIM_GET_COUNTER(&htim2);
-}
\ No newline at end of file
+  // --- TIM1: base de tempo do gate (no  gerado pelo CubeMX) ---
+  __HAL_RCC_TIM1_CLK_ENABLE();
+  s_htim_gate.Instance = TIM1;
+  s_htim_gate.Init.Prescaler = FREQ_GATE_PRESCALER;
+  s_htim_gate.Init.CounterMode = TIM_COUNTERMODE_UP;
+  s_htim_gate.Init.Period = FREQ_JANELA_PADRAO_MS - 1;
+  s_htim_gate.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  s_htim_gate.Init.RepetitionCounter = 0;
+  s_htim_gate.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+  if (HAL_TIM_Base_Init(&s_htim_gate) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  s_clock_tim_hz = HAL_RCC_GetPCLK1Freq(); // APB sem divisor: clock dos timers = PCLK
+  s_modo = FREQ_MODO_PADRAO;
+  s_janela_ms = (s_modo == FREQ_MODO_RECIPROCO) ? FREQ_RECIP_JANELA_MS : FREQ_JANELA_PADRAO_MS;
+  memset(&s_stats, 0, sizeof(s_stats));
+  Reiniciar_Medicao();
+}
+
+void Frequency_Set_Modo(Freq_Modo_t modo)
+{
+  Parar_Medicao();
+  s_modo = modo;
+  if (!s_janela_fixada)
+  {
+    s_janela_ms = (modo == FREQ_MODO_RECIPROCO) ? FREQ_RECIP_JANELA_MS : FREQ_JANELA_PADRAO_MS;
+  }
+  Reiniciar_Medicao();
+}
+
+bool Frequency_Set_Janela_ms(uint32_t janela_ms)
+{
+  if (janela_ms < FREQ_JANELA_MIN_MS || janela_ms > FREQ_JANELA_MAX_MS)
+  {
+    return false;
+  }
+  Parar_Medicao();
+  s_janela_ms = janela_ms;
+  s_janela_fixada = true;
+  Reiniciar_Medicao();
+  return true;
+}
+
+bool Frequency_Process(uint32_t* freq_hz)
+{
+  uint32_t agora = HAL_GetTick();
+  bool nova = (s_modo == FREQ_MODO_RECIPROCO) ? Processar_Reciproco(agora)
+                                              : Processar_Contagem(agora);
+  s_ultimo_poll_ms = agora;
+
+  if (nova && freq_hz != NULL)
+  {
+    *freq_hz = (s_freq_chz + 50u) / 100u;
+  }
+  return nova;
+}
+
+uint32_t Frequency_Get_Freq_cHz(void)
+{
+  return s_freq_chz;
+}
+
+uint32_t Frequency_Get_Janela_cHz(void)
+{
+  return s_janela_chz;
+}
+
+void Frequency_Get_Stats(Frequency_Stats_t* stats)
+{
+  if (stats != NULL)
+  {
+    *stats = s_stats;
+  }
+}
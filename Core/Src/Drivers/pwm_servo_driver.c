@@ -4,9 +4,24 @@
  * @details     Este mdulo abstrai o controle de um canal de timer em modo PWM
  * para controlar a posio de um servomotor. Ele converte um ngulo
  * em graus para o valor de pulso correspondente no registrador do timer.
+ *
+ * Perfil de movimento (PWM_Servo_Move): a rampa de CCR de um movimento 
+ * calculada de uma vez (velocidade trapezoidal: acelera no primeiro quarto,
+ * velocidade constante, freia no ltimo quarto) e o DMA1 canal 2 (antes do
+ * RX da USART1, que o CLI atende por IT) copia um valor para o CCR a cada
+ * update do timer. O DMAMUX escolhe TIM16_UP ou TIM17_UP por movimento.
  ******************************************************************************/
 
 #include "pwm_servo_driver.h"
+#include <stddef.h>
+
+//==============================================================================
+// Variveis Estticas
+//==============================================================================
+
+static DMA_HandleTypeDef s_hdma_servo;
+static uint16_t s_rampa[PWM_SERVO_RAMPA_MAX_PASSOS]; // Lido pelo DMA durante o movimento
+static Servo_t* volatile s_servo_em_movimento = NULL;
 
 //==============================================================================
 // Funes Privadas (Helpers)
@@ -37,6 +52,113 @@ static uint32_t map_angle_to_ccr(Servo_t *servo, float angle)
     return target_pulse_us;
 }
 
+// Endereo do CCR do canal (mesma conta do __HAL_TIM_SET_COMPARE).
+static volatile uint32_t* ccr_do_canal(Servo_t *servo)
+{
+    return &servo->htim->Instance->CCR1 + (servo->channel >> 2U);
+}
+
+// Preenche s_rampa com 'passos' pulsos de 'de_us' at 'para_us' (o ltimo  o destino).
+// Frao percorrida no passo t, com ta = passos/4:
+//   t < ta:              t / (2 ta (T - ta))
+//   ta <= t <= T - ta:   (2t - ta) ta / (2 ta (T - ta))
+//   t > T - ta:          1 - (T - t) / (2 ta (T - ta))
+static void gerar_rampa(uint16_t de_us, uint16_t para_us, uint32_t passos)
+{
+    int32_t total = (int32_t)passos;
+    int32_t ta = total / 4;
+    if (ta < 1)
+    {
+        ta = 1;
+    }
+    int64_t denom = 2LL * ta * (total - ta);
+    int32_t delta = (int32_t)para_us - (int32_t)de_us;
+
+    for (int32_t t = 1; t <= total; t++)
+    {
+        int64_t num;
+        if (t < ta)
+        {
+            num = (int64_t)t * t;
+        }
+        else if (t <= total - ta)
+        {
+            num = (int64_t)(2 * t - ta) * ta;
+        }
+        else
+        {
+            int32_t r = total - t;
+            num = denom - (int64_t)r * r;
+        }
+        s_rampa[t - 1] = (uint16_t)((int32_t)de_us + (int32_t)((delta * num) / denom));
+    }
+}
+
+// Libera o canal: desliga o pedido de DMA do timer que estava sendo servido.
+static void finalizar_movimento(void)
+{
+    Servo_t *servo = s_servo_em_movimento;
+    if (servo != NULL)
+    {
+        __HAL_TIM_DISABLE_DMA(servo->htim, TIM_DMA_UPDATE);
+        s_servo_em_movimento = NULL;
+    }
+}
+
+static void dma_servo_concluido(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    finalizar_movimento();
+}
+
+static void dma_servo_erro(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    Servo_t *servo = s_servo_em_movimento;
+    if (servo != NULL)
+    {
+        *ccr_do_canal(servo) = servo->pulse_us; // Sem rampa: salta para o destino
+    }
+    finalizar_movimento();
+}
+
+// Interrompe o movimento em curso (o servo fica no ltimo pulso copiado).
+static void interromper_movimento(void)
+{
+    HAL_NVIC_DisableIRQ(DMA1_Channel2_3_IRQn);
+    if (s_servo_em_movimento != NULL)
+    {
+        __HAL_TIM_DISABLE_DMA(s_servo_em_movimento->htim, TIM_DMA_UPDATE);
+        HAL_DMA_Abort(&s_hdma_servo);
+        s_servo_em_movimento = NULL;
+    }
+    HAL_NVIC_EnableIRQ(DMA1_Channel2_3_IRQn);
+}
+
+static bool configurar_dma(uint32_t request)
+{
+    if (s_hdma_servo.State != HAL_DMA_STATE_RESET)
+    {
+        HAL_DMA_DeInit(&s_hdma_servo);
+    }
+    s_hdma_servo.Instance = DMA1_Channel2;
+    s_hdma_servo.Init.Request = request;
+    s_hdma_servo.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    s_hdma_servo.Init.PeriphInc = DMA_PINC_DISABLE;
+    s_hdma_servo.Init.MemInc = DMA_MINC_ENABLE;
+    s_hdma_servo.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    s_hdma_servo.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    s_hdma_servo.Init.Mode = DMA_NORMAL;
+    s_hdma_servo.Init.Priority = DMA_PRIORITY_MEDIUM;
+    if (HAL_DMA_Init(&s_hdma_servo) != HAL_OK)
+    {
+        return false;
+    }
+    s_hdma_servo.XferCpltCallback = dma_servo_concluido;
+    s_hdma_servo.XferErrorCallback = dma_servo_erro;
+    return true;
+}
+
 //==============================================================================
 // Funes Pblicas (API do Driver)
 //==============================================================================
@@ -49,6 +171,16 @@ HAL_StatusTypeDef PWM_Servo_Init(Servo_t *servo)
         return HAL_ERROR;
     }
 
+    // O CubeMX (tim.c) configura a base de 1 us, o perodo de 20 ms e o preload
+    // (o CCR fica em microssegundos; um CCR novo, da CPU ou do DMA, s vale a
+    // partir do prximo perodo). Recusa um timer gerado com outra configurao.
+    if (servo->htim->Instance->PSC != PWM_SERVO_PRESCALER ||
+        servo->htim->Instance->ARR != (PWM_SERVO_PERIODO_US - 1u) ||
+        (servo->htim->Instance->CR1 & TIM_CR1_ARPE) == 0u)
+    {
+        return HAL_ERROR;
+    }
+
     // Inicia o sinal PWM no canal do timer especificado na estrutura do servo.
     return HAL_TIM_PWM_Start(servo->htim, servo->channel);
 }
@@ -62,11 +194,115 @@ void PWM_Servo_SetAngle(Servo_t *servo, float angle)
     }
 
     // Converte o ngulo desejado para o valor bruto do registrador CCR.
-    uint32_t ccr_value = map_angle_to_ccr(servo, angle);
+    PWM_Servo_SetPulse(servo, (uint16_t)map_angle_to_ccr(servo, angle));
+}
+
+// Mesma interpolao do map_angle_to_ccr(), em inteiros (ngulos inteiros do o mesmo pulso).
+uint16_t PWM_Servo_Angle_To_Pulse(const Servo_t *servo, uint32_t angle_deg)
+{
+    if (servo == NULL)
+    {
+        return 0;
+    }
+    if (angle_deg > 180u)
+    {
+        angle_deg = 180u;
+    }
+    uint32_t pulse_range_us = (uint32_t)(servo->max_pulse_us - servo->min_pulse_us);
+    return (uint16_t)(servo->min_pulse_us + (pulse_range_us * angle_deg) / 180u);
+}
+
+void PWM_Servo_SetPulse(Servo_t *servo, uint16_t pulse_us)
+{
+    if (servo == NULL || servo->htim == NULL)
+    {
+        return;
+    }
+
+    // Um salto cancela a rampa em curso deste servo
+    if (s_servo_em_movimento == servo)
+    {
+        interromper_movimento();
+    }
+    servo->pulse_us = pulse_us;
 
     // Define o valor de comparao do timer, o que altera a largura do pulso
     // e, consequentemente, move o servo para a posio desejada.
-    __HAL_TIM_SET_COMPARE(servo->htim, servo->channel, ccr_value);
+    __HAL_TIM_SET_COMPARE(servo->htim, servo->channel, pulse_us);
+}
+
+// Move o servo por um perfil trapezoidal copiado pelo DMA a cada update do timer.
+bool PWM_Servo_Move_Pulse(Servo_t *servo, uint16_t pulse_us, uint32_t duracao_ms)
+{
+    if (servo == NULL || servo->htim == NULL)
+    {
+        return false;
+    }
+
+    Servo_t *ativo = s_servo_em_movimento;
+    if (ativo != NULL && ativo != servo)
+    {
+        return false; // Canal ocupado com o outro servo
+    }
+    if (ativo == servo)
+    {
+        interromper_movimento(); // Recomea do ponto em que a rampa parou
+    }
+
+    uint16_t origem = (uint16_t)*ccr_do_canal(servo);
+    uint16_t destino = pulse_us;
+    servo->pulse_us = destino;
+
+    uint32_t passos = duracao_ms / PWM_SERVO_PERIODO_MS;
+    if (passos > PWM_SERVO_RAMPA_MAX_PASSOS)
+    {
+        passos = PWM_SERVO_RAMPA_MAX_PASSOS;
+    }
+
+    uint32_t request = 0;
+    if (servo->htim->Instance == TIM16)
+    {
+        request = DMA_REQUEST_TIM16_UP;
+    }
+    else if (servo->htim->Instance == TIM17)
+    {
+        request = DMA_REQUEST_TIM17_UP;
+    }
+    else
+    {
+        passos = 0; // Timer sem pedido de DMA mapeado: sem rampa
+    }
+
+    if (passos < 2 || origem == destino || origem == 0 || !configurar_dma(request))
+    {
+        // Movimento curto, servo ainda sem posio conhecida ou DMA indisponvel: salta
+        *ccr_do_canal(servo) = destino;
+        return true;
+    }
+
+    gerar_rampa(origem, destino, passos);
+    s_servo_em_movimento = servo;
+    if (HAL_DMA_Start_IT(&s_hdma_servo, (uint32_t)s_rampa, (uint32_t)ccr_do_canal(servo), passos) != HAL_OK)
+    {
+        s_servo_em_movimento = NULL;
+        *ccr_do_canal(servo) = destino;
+        return true;
+    }
+    __HAL_TIM_ENABLE_DMA(servo->htim, TIM_DMA_UPDATE);
+    return true;
+}
+
+bool PWM_Servo_Is_Moving(void)
+{
+    return s_servo_em_movimento != NULL;
+}
+
+void PWM_Servo_DMA_IRQHandler(void)
+{
+    if (s_hdma_servo.State != HAL_DMA_STATE_RESET)
+    {
+        HAL_DMA_IRQHandler(&s_hdma_servo);
+    }
 }
 
 // Para a gerao de PWM para um servo especfico.
@@ -77,6 +313,11 @@ HAL_StatusTypeDef PWM_Servo_DeInit(Servo_t *servo)
         return HAL_ERROR;
     }
 
+    if (s_servo_em_movimento == servo)
+    {
+        interromper_movimento();
+    }
+
     // Para o sinal PWM no canal do timer especificado.
     return HAL_TIM_PWM_Stop(servo->htim, servo->channel);
 }
\ No newline at end of file
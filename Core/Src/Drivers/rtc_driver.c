@@ -14,7 +14,6 @@
 static RTC_HandleTypeDef* s_hrtc = NULL;
 static char s_time_buffer[9]; // "HH:MM:SS"
 static char s_date_buffer[9]; // "DD/MM/YY"
-static uint32_t s_last_update_tick = 0;
 
 /**
  * @brief Inicializa o driver do RTC.
@@ -48,15 +47,6 @@ void RTC_Driver_Init(RTC_HandleTypeDef* hrtc)
  */
 void RTC_Driver_Process(void)
 {
-    uint32_t tick_atual = HAL_GetTick();
-
-    if (tick_atual - s_last_update_tick < 1000) {
-        return; // No  hora
-    }
-    
-    // Reseta o timer IMEDIATAMENTE (corrige o "pulo" de segundos)
-    s_last_update_tick = tick_atual; 
-
     // **** (V8.3) LGICA DE ATUALIZAO CONDICIONAL (Sua Proposta) ****
     uint16_t tela_atual = Controller_GetCurrentScreen();
     
@@ -101,9 +91,6 @@ void RTC_Driver_SetTime(uint8_t hours, uint8_t minutes, uint8_t seconds)
     new_time.Minutes = minutes;
     new_time.Seconds = seconds;
 
-    if (HAL_RTC_SetTime(s_hrtc, &new_time, RTC_FORMAT_BIN) == HAL_OK)
-    {
-        // Fora a atualizao imediata no display no prximo ciclo de Process()
-        s_last_update_tick = 0; 
-    }
+    // O display mostra a hora nova na prxima chamada de RTC_Driver_Process() (at 1 s)
+    HAL_RTC_SetTime(s_hrtc, &new_time, RTC_FORMAT_BIN);
 }
\ No newline at end of file
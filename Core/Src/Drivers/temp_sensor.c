@@ -5,11 +5,15 @@
  * fbrica de ponto nico (`TS_CAL1`) para fornecer uma leitura de
  * temperatura confivel e mais precisa do que os valores genricos
  * do datasheet. O resultado  a temperatura interna do chip.
+ * Alm da leitura bloqueante (boot), h uma converso em segundo plano:
+ * TempSensor_Iniciar_Conversao() dispara o ADC e TempSensor_Process(), no
+ * superloop, recolhe o resultado quando o EOC subir.
  ******************************************************************************/
 
 #include "temp_sensor.h"
 #include "adc.h"
 #include "stm32c0xx_ll_adc.h" // Inclui o header da ST que contm a definio para TEMPSENSOR_CAL1_ADDR
+#include <stdbool.h>
 
 extern ADC_HandleTypeDef hadc1;
 
@@ -26,35 +30,33 @@ extern ADC_HandleTypeDef hadc1;
 #define ADC_MAX_VALUE       4095.0f // Resoluo mxima de um ADC de 12 bits (2^12 - 1).
 
 //==============================================================================
-// Implementao da Funo Pblica
+// Estado da converso em segundo plano
 //==============================================================================
 
-//L a temperatura do sensor interno do MCU usando calibrao de fbrica.
-float TempSensor_GetTemperature(void)
-{
-    uint32_t raw_temp_sensor = 0;
+#define TEMP_TIMEOUT_CONVERSAO_MS 10 // A converso leva ~15 us; isso s cobre falhas
+
+static bool     s_em_conversao = false;
+static uint32_t s_inicio_ms = 0;
+static float    s_ultima_temperatura = -273.0f;
+static uint32_t s_contador = 0;
 
+//==============================================================================
+// Funes Privadas
+//==============================================================================
+
+static bool Configurar_Canal(void)
+{
     // Configura o ADC para ler o canal do sensor de temperatura
     ADC_ChannelConfTypeDef sConfig = {0};
     sConfig.Channel = ADC_CHANNEL_TEMPSENSOR;
     sConfig.Rank = ADC_REGULAR_RANK_1;
     sConfig.SamplingTime = ADC_SAMPLETIME_160CYCLES_5;
-		
-    if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
-    {
-        return -273.0f;
-    }
 
-    if (HAL_ADC_Start(&hadc1) != HAL_OK)
-    {
-        return -273.0f;
-    }
-    if (HAL_ADC_PollForConversion(&hadc1, 100) == HAL_OK)
-    {
-        raw_temp_sensor = HAL_ADC_GetValue(&hadc1);
-    }
-    HAL_ADC_Stop(&hadc1);
+    return HAL_ADC_ConfigChannel(&hadc1, &sConfig) == HAL_OK;
+}
 
+static float Converter_Para_Celsius(uint32_t raw_temp_sensor)
+{
     if (raw_temp_sensor == 0)
     {
         return -273.0f;
@@ -76,4 +78,94 @@ float TempSensor_GetTemperature(void)
     float temperature_celsius = ((vsense_voltage - v30_calibrated) / AVG_SLOPE_TYP) + TEMP_CAL_P1_TEMP;
 
     return temperature_celsius;
-}
\ No newline at end of file
+}
+
+//==============================================================================
+// Implementao das Funes Pblicas
+//==============================================================================
+
+//L a temperatura do sensor interno do MCU usando calibrao de fbrica.
+float TempSensor_GetTemperature(void)
+{
+    uint32_t raw_temp_sensor = 0;
+
+    if (s_em_conversao)
+    {
+        HAL_ADC_Stop(&hadc1); // A leitura bloqueante toma o lugar da converso em curso
+        s_em_conversao = false;
+    }
+
+    if (!Configurar_Canal())
+    {
+        return -273.0f;
+    }
+
+    if (HAL_ADC_Start(&hadc1) != HAL_OK)
+    {
+        return -273.0f;
+    }
+    if (HAL_ADC_PollForConversion(&hadc1, 100) == HAL_OK)
+    {
+        raw_temp_sensor = HAL_ADC_GetValue(&hadc1);
+    }
+    HAL_ADC_Stop(&hadc1);
+
+    s_ultima_temperatura = Converter_Para_Celsius(raw_temp_sensor);
+    return s_ultima_temperatura;
+}
+
+bool TempSensor_Iniciar_Conversao(void)
+{
+    if (s_em_conversao)
+    {
+        return true; // A converso em curso j serve ao pedido
+    }
+    if (!Configurar_Canal() || HAL_ADC_Start(&hadc1) != HAL_OK)
+    {
+        return false;
+    }
+    s_em_conversao = true;
+    s_inicio_ms = HAL_GetTick();
+    return true;
+}
+
+bool TempSensor_Em_Conversao(void)
+{
+    return s_em_conversao;
+}
+
+bool TempSensor_Process(void)
+{
+    if (!s_em_conversao)
+    {
+        return false;
+    }
+
+    if (!__HAL_ADC_GET_FLAG(&hadc1, ADC_FLAG_EOC))
+    {
+        if ((HAL_GetTick() - s_inicio_ms) > TEMP_TIMEOUT_CONVERSAO_MS)
+        {
+            HAL_ADC_Stop(&hadc1);
+            s_em_conversao = false; // Desiste; o prximo pedido tenta de novo
+        }
+        return false;
+    }
+
+    uint32_t raw_temp_sensor = HAL_ADC_GetValue(&hadc1); // Limpa o EOC
+    HAL_ADC_Stop(&hadc1);
+    s_em_conversao = false;
+
+    s_ultima_temperatura = Converter_Para_Celsius(raw_temp_sensor);
+    s_contador++;
+    return true;
+}
+
+float TempSensor_Get_Ultima(void)
+{
+    return s_ultima_temperatura;
+}
+
+uint32_t TempSensor_Get_Contador(void)
+{
+    return s_contador;
+}
@@ -0,0 +1,208 @@
+/*******************************************************************************
+ * @file        calculo_umidade.c
+ * @brief       Motor de clculo de umidade pelas curvas do Produto[] (GXXX_Equacoes).
+ * @version     1.2 (Curva direto sobre a Escala A)
+ * @details     Cadeia de clculo (s inteiros no caminho por medio):
+ * 1. Escala A = 396.85 - 0.00014955 * f, com o ajuste de campo Cal_A.
+ * 2. x = Escala A: as curvas foram levantadas com a massa padro (Peso_Pad),
+ *    que  a massa que o ciclo dosa. A correo x = Escala A * Peso_Pad / peso
+ *    s existe atrs de UMID_CORRECAO_PESO (desligada, no validada).
+ * 3. Um = ((Fat_A * x + Fat_B) * x + Fat_C) * x + Fat_D  (Horner, Q32 com x em Q16).
+ * 4. Um += (T - 25) * (CT_Ganho * Um + CT_Zero).
+ * 5. Limita a [Um_Min, Um_Max]; densidade = peso / volume da cmara. O volume
+ *    vem da configurao (Gerenciador_Config_Get_Volume_Camara_ml); enquanto
+ *    no for medido (0) no h densidade e o VP DENSIDADE no  escrito.
+ * Os coeficientes float do gro (Q32) e o ajuste Cal_A (ganho Q24, zero x10000)
+ * so convertidos uma nica vez, na seleo do gro ou quando o Cal_A muda, e
+ * no a cada medio.
+ ******************************************************************************/
+
+#include "calculo_umidade.h"
+#include "GXXX_Equacoes.h"
+#include "gerenciador_configuracoes.h"
+#include "dwin_driver.h"
+#include "scale_fixed.h"
+#include <math.h>
+#include <stdio.h>
+
+//================================================================================
+// Definies
+//================================================================================
+
+#define UMID_Q              32
+#define UMID_X_Q            16
+#define UMID_X_MAX_Q16      (1000LL << UMID_X_Q)  // Limita o Horner longe do estouro de 64 bits
+
+// Coeficientes da Escala A em inteiros: 396.85 (x10000) e 0.00014955 (exato: 14955 / 1e8)
+#define ESCALA_A_ZERO_X10000   3968500L
+#define ESCALA_A_COEF_1E8      14955L
+// Ganho do Cal_A em Q24: em Q16 s o arredondamento do ganho j tira ~0.002 da Escala A
+#define CAL_A_GAIN_Q           24
+
+//================================================================================
+// Variveis Estticas
+//================================================================================
+
+static struct {
+    bool    valido;
+    uint8_t indice;
+    int64_t coef_q32[4];     // Fat_A..Fat_D
+    int64_t ct_ganho_q32;
+    int64_t ct_zero_q32;
+    int32_t um_min_x100;
+    int32_t um_max_x100;
+    int32_t peso_pad_mg;
+} s_grao;
+
+// Ajuste de campo Cal_A j em ponto fixo (padro: ganho 1, zero 0)
+static int32_t s_cal_a_gain_q24 = 1L << CAL_A_GAIN_Q;
+static int32_t s_cal_a_zero_x1e4 = 0;
+
+//================================================================================
+// Funes Privadas
+//================================================================================
+
+static int64_t Float_Para_Q32(float valor)
+{
+    return (int64_t)llround((double)valor * 4294967296.0);
+}
+
+/**
+ * @brief Polinmio cbico por Horner: Q32 nos coeficientes/acumulador, Q16 em x.
+ * O deslocamento  direita de negativos  aritmtico no armcc/armclang.
+ */
+static int64_t Avaliar_Curva_Q32(int64_t x_q16)
+{
+    int64_t acc = s_grao.coef_q32[0];
+    for (uint8_t i = 1; i < 4; i++) {
+        acc = ((acc * x_q16) >> UMID_X_Q) + s_grao.coef_q32[i];
+    }
+    return acc;
+}
+
+//================================================================================
+// Funes Pblicas
+//================================================================================
+
+void Calculo_Umidade_Atualizar_Cal_A(void)
+{
+    float gain = 1.0f;
+    float zero = 0.0f;
+    Gerenciador_Config_Get_Cal_A(&gain, &zero);
+    s_cal_a_gain_q24 = (int32_t)lrintf(gain * (float)(1L << CAL_A_GAIN_Q));
+    s_cal_a_zero_x1e4 = (int32_t)lrintf(zero * 10000.0f);
+}
+
+bool Calculo_Umidade_Selecionar_Grao(uint8_t indice)
+{
+    Calculo_Umidade_Atualizar_Cal_A();
+
+    if (indice >= NR_CEREAIS) {
+        s_grao.valido = false;
+        return false;
+    }
+
+    const struct Produtos_ROM* p = &Produto[indice];
+    s_grao.indice = indice;
+    s_grao.coef_q32[0] = Float_Para_Q32(p->Fat_A);
+    s_grao.coef_q32[1] = Float_Para_Q32(p->Fat_B);
+    s_grao.coef_q32[2] = Float_Para_Q32(p->Fat_C);
+    s_grao.coef_q32[3] = Float_Para_Q32(p->Fat_D);
+    s_grao.ct_ganho_q32 = Float_Para_Q32(p->CT_Ganho);
+    s_grao.ct_zero_q32 = Float_Para_Q32(p->CT_Zero);
+    s_grao.um_min_x100 = (int32_t)p->Um_Min * 100;
+    s_grao.um_max_x100 = (int32_t)p->Um_Max * 100;
+    s_grao.peso_pad_mg = (int32_t)p->Peso_Pad * 1000;
+    s_grao.valido = true;
+    printf("Umidade: curva %lu (%s) carregada.\r\n", (unsigned long)p->Nr_Equa, p->Nome[0]);
+    return true;
+}
+
+int32_t Calculo_Umidade_Get_Peso_Pad_mg(void)
+{
+    return s_grao.valido ? s_grao.peso_pad_mg : 0;
+}
+
+int32_t Calculo_Umidade_Escala_A_x10000(uint32_t freq_chz)
+{
+    // 0.00014955 * f(cHz) / 100, em x10000: f * 14955 / 1e6 (o Q16 do coeficiente errava at 0.0004)
+    int32_t escala = ESCALA_A_ZERO_X10000 -
+                     (int32_t)(((int64_t)freq_chz * ESCALA_A_COEF_1E8 + 500000) / 1000000);
+    return Scale_Mul_Q(escala, s_cal_a_gain_q24, CAL_A_GAIN_Q) + s_cal_a_zero_x1e4;
+}
+
+Umid_Status_t Calculo_Umidade_Calcular(uint32_t freq_chz, int32_t peso_mg, int32_t temp_x100,
+                                       Umid_Resultado_t* resultado)
+{
+    Umid_Resultado_t r = {0};
+    r.grao = s_grao.indice;
+    int32_t volume_ml = Gerenciador_Config_Get_Volume_Camara_ml();
+    r.densidade_valida = (volume_ml > 0);
+    if (r.densidade_valida && peso_mg > 0) {
+        r.densidade_x10 = (peso_mg + volume_ml / 2) / volume_ml;
+    }
+
+    if (!s_grao.valido) {
+        r.status = UMID_SEM_GRAO;
+#if UMID_CORRECAO_PESO
+    } else if (peso_mg <= 0) {
+        r.status = UMID_PESO_INVALIDO;
+#endif
+    } else {
+        r.escala_a_x10000 = Calculo_Umidade_Escala_A_x10000(freq_chz);
+
+#if UMID_CORRECAO_PESO
+        // x = Escala A * Peso_Pad / peso, em Q16
+        int64_t x_q16 = ((int64_t)r.escala_a_x10000 * (1 << UMID_X_Q) * s_grao.peso_pad_mg) /
+                        ((int64_t)10000 * peso_mg);
+#else
+        // x = Escala A, em Q16
+        int64_t x_q16 = ((int64_t)r.escala_a_x10000 * (1 << UMID_X_Q) + 5000) / 10000;
+#endif
+        if (x_q16 > UMID_X_MAX_Q16) x_q16 = UMID_X_MAX_Q16;
+        if (x_q16 < -UMID_X_MAX_Q16) x_q16 = -UMID_X_MAX_Q16;
+
+        int64_t um_q32 = Avaliar_Curva_Q32(x_q16);
+        int32_t um_x100 = (int32_t)((um_q32 * 100 + (1LL << (UMID_Q - 1))) >> UMID_Q);
+        r.umidade_bruta_x100 = um_x100;
+
+        // Correo de temperatura: (T - 25) * (CT_Ganho * Um + CT_Zero)
+        int64_t fator_q32_x100 = s_grao.ct_ganho_q32 * um_x100 + s_grao.ct_zero_q32 * 100;
+        int64_t dt_x100 = (int64_t)temp_x100 - UMID_TEMP_REF_X100;
+        um_x100 += (int32_t)(((fator_q32_x100 * dt_x100) / 100 + (1LL << (UMID_Q - 1))) >> UMID_Q);
+
+        r.status = UMID_OK;
+        if (um_x100 < s_grao.um_min_x100) {
+            um_x100 = s_grao.um_min_x100;
+            r.status = UMID_ABAIXO_FAIXA;
+        } else if (um_x100 > s_grao.um_max_x100) {
+            um_x100 = s_grao.um_max_x100;
+            r.status = UMID_ACIMA_FAIXA;
+        }
+        r.umidade_x100 = um_x100;
+    }
+
+    if (resultado != NULL) {
+        *resultado = r;
+    }
+    return r.status;
+}
+
+void Calculo_Umidade_Publicar(const Umid_Resultado_t* resultado)
+{
+    if (resultado == NULL) return;
+
+    // UMIDADE_1_CASA: uma casa decimal (12.3% -> 123)
+    int16_t umidade_x10 = (resultado->status == UMID_PESO_INVALIDO || resultado->status == UMID_SEM_GRAO)
+                          ? 0 : (int16_t)((resultado->umidade_x100 + 5) / 10);
+    DWIN_Driver_WriteInt(UMIDADE_1_CASA, umidade_x10);
+    if (resultado->densidade_valida) {
+        DWIN_Driver_WriteInt(DENSIDADE, (int16_t)resultado->densidade_x10);
+    }
+}
+
+void Calculo_Umidade_Limpar(void)
+{
+    DWIN_Driver_WriteInt(UMIDADE_1_CASA, 0);
+    DWIN_Driver_WriteInt(DENSIDADE, 0);
+}
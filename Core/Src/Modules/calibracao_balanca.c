@@ -0,0 +1,229 @@
+/*******************************************************************************
+ * @file        calibracao_balanca.c
+ * @brief       Calibrao multiponto da balana em campo (sem regravar o firmware).
+ * @version     1.0
+ * @details     FSM no-bloqueante alimentada pelas amostras do ring do ADS1232:
+ * 1. Para cada massa de referncia, o operador coloca o peso e confirma
+ *    (tecla CONFIRMA na TELA_ADJUST_SCALE ou "CAL OK" no CLI).
+ * 2. Descarta as primeiras converses (assentamento) e faz a mdia de um bloco
+ *    estvel. Se o bloco oscilar demais, a captura recomea sozinha.
+ * 3. Ao final, os pontos vo para o Config_Aplicacao_t (persistidos pela FSM
+ *    de armazenamento) e a tabela de converso  remontada em segundo plano.
+ ******************************************************************************/
+
+#include "calibracao_balanca.h"
+#include "ads1232_driver.h"
+#include "dwin_driver.h"
+#include <stdio.h>
+#include <string.h>
+
+//================================================================================
+// Definies
+//================================================================================
+
+#define CAL_AMOSTRAS_DESCARTE     8     // Converses ignoradas aps a confirmao
+#define CAL_AMOSTRAS_POR_PONTO    32    // Converses promediadas por ponto
+#define CAL_LIMIAR_ESTABILIDADE   300   // Mx-mn aceitvel no bloco (counts), igual  tara
+#define CAL_MAX_TENTATIVAS        5
+
+//================================================================================
+// Variveis Estticas
+//================================================================================
+
+static Cal_Bal_Status_t s_cal;
+static float s_massas_g[MAX_PONTOS_CAL_BALANCA];
+
+static struct {
+    uint8_t descartar;
+    uint8_t contagem;
+    uint8_t tentativas;
+    int64_t soma;
+    int32_t minimo;
+    int32_t maximo;
+} s_captura;
+
+//================================================================================
+// Funes Privadas
+//================================================================================
+
+static void Preparar_Ponto(uint8_t indice)
+{
+    s_cal.ponto_atual = indice;
+    s_cal.massa_atual_g = s_massas_g[indice];
+    s_cal.etapa = CAL_BAL_AGUARDA_PESO;
+
+    printf("CAL: Ponto %u/%u -> coloque %.2f g no prato e confirme (CAL OK).\r\n",
+           (unsigned)(indice + 1), (unsigned)s_cal.num_pontos, s_cal.massa_atual_g);
+
+    // Feedback na TELA_ADJUST_SCALE: nmero do ponto e massa esperada (0.1 g)
+    DWIN_Driver_WriteInt(FAT_CAL_BAL, (int16_t)(indice + 1));
+    DWIN_Driver_WriteInt32(PESO, (int32_t)(s_cal.massa_atual_g * 10.0f));
+}
+
+static void Reiniciar_Captura(void)
+{
+    s_captura.descartar = CAL_AMOSTRAS_DESCARTE;
+    s_captura.contagem = 0;
+    s_captura.soma = 0;
+    s_captura.minimo = INT32_MAX;
+    s_captura.maximo = INT32_MIN;
+}
+
+static void Finalizar_Pontos(void)
+{
+    CalPoint_t pontos_drv[MAX_PONTOS_CAL_BALANCA];
+
+    for (uint8_t i = 0; i < s_cal.num_pontos; i++) {
+        pontos_drv[i].grams = s_cal.pontos[i].gramas;
+        pontos_drv[i].adc_value = s_cal.pontos[i].adc;
+    }
+
+    // A validao (ADC repetido, etc.) acontece aqui; a montagem segue em segundo plano
+    if (!ADS1232_RequestCalibration(pontos_drv, s_cal.num_pontos)) {
+        printf("CAL: ERRO - pontos invalidos (ADC repetido?). Calibracao descartada.\r\n");
+        s_cal.etapa = CAL_BAL_OCIOSO;
+        return;
+    }
+    s_cal.etapa = CAL_BAL_SALVANDO;
+}
+
+//================================================================================
+// Funes Pblicas
+//================================================================================
+
+void Calibracao_Balanca_Init(void)
+{
+    Config_Ponto_Cal_t pontos_cfg[MAX_PONTOS_CAL_BALANCA];
+    CalPoint_t pontos_drv[MAX_PONTOS_CAL_BALANCA];
+
+    memset(&s_cal, 0, sizeof(s_cal));
+    s_cal.etapa = CAL_BAL_OCIOSO;
+
+    uint8_t n = Gerenciador_Config_Get_Cal_Balanca(pontos_cfg, MAX_PONTOS_CAL_BALANCA);
+    for (uint8_t i = 0; i < n; i++) {
+        pontos_drv[i].grams = pontos_cfg[i].gramas;
+        pontos_drv[i].adc_value = pontos_cfg[i].adc;
+    }
+
+    if (n >= 2 && ADS1232_SetCalibration(pontos_drv, n)) {
+        printf("CAL: Calibracao da EEPROM aplicada (%u pontos).\r\n", (unsigned)n);
+    } else {
+        printf("CAL: Calibracao da EEPROM invalida. Usando tabela de fabrica.\r\n");
+    }
+}
+
+bool Calibracao_Balanca_Iniciar(const float* massas_g, uint8_t n)
+{
+    if (s_cal.etapa == CAL_BAL_SALVANDO) return false;
+
+    if (massas_g == NULL) {
+        // Reutiliza as massas da calibrao atual (o caso comum em campo)
+        Config_Ponto_Cal_t atuais[MAX_PONTOS_CAL_BALANCA];
+        n = Gerenciador_Config_Get_Cal_Balanca(atuais, MAX_PONTOS_CAL_BALANCA);
+        for (uint8_t i = 0; i < n; i++) {
+            s_massas_g[i] = atuais[i].gramas;
+        }
+    } else {
+        if (n > MAX_PONTOS_CAL_BALANCA) return false;
+        memcpy(s_massas_g, massas_g, n * sizeof(float));
+    }
+    if (n < 2) return false;
+
+    memset(s_cal.pontos, 0, sizeof(s_cal.pontos));
+    s_cal.num_pontos = n;
+    printf("CAL: Calibracao guiada iniciada com %u pontos.\r\n", (unsigned)n);
+    Preparar_Ponto(0);
+    return true;
+}
+
+bool Calibracao_Balanca_Confirmar_Ponto(void)
+{
+    if (s_cal.etapa != CAL_BAL_AGUARDA_PESO) return false;
+
+    Reiniciar_Captura();
+    s_captura.tentativas = 0;
+    s_cal.etapa = CAL_BAL_CAPTURANDO;
+    printf("CAL: Capturando ponto %u...\r\n", (unsigned)(s_cal.ponto_atual + 1));
+    return true;
+}
+
+void Calibracao_Balanca_Cancelar(void)
+{
+    if (s_cal.etapa == CAL_BAL_AGUARDA_PESO || s_cal.etapa == CAL_BAL_CAPTURANDO) {
+        s_cal.etapa = CAL_BAL_OCIOSO;
+        printf("CAL: Calibracao cancelada. Tabela anterior mantida.\r\n");
+    }
+}
+
+/**
+ * @brief (Superloop) Chamada para cada converso drenada do ring do ADS1232.
+ */
+void Calibracao_Balanca_Nova_Amostra(int32_t raw)
+{
+    if (s_cal.etapa != CAL_BAL_CAPTURANDO) return;
+
+    if (s_captura.descartar > 0) {
+        s_captura.descartar--;
+        return;
+    }
+
+    s_captura.soma += raw;
+    if (raw < s_captura.minimo) s_captura.minimo = raw;
+    if (raw > s_captura.maximo) s_captura.maximo = raw;
+    s_captura.contagem++;
+
+    if (s_captura.contagem < CAL_AMOSTRAS_POR_PONTO) return;
+
+    int32_t espalhamento = s_captura.maximo - s_captura.minimo;
+    if (espalhamento >= CAL_LIMIAR_ESTABILIDADE) {
+        s_captura.tentativas++;
+        if (s_captura.tentativas >= CAL_MAX_TENTATIVAS) {
+            printf("CAL: Ponto %u instavel (diff: %ld). Verifique a massa e confirme novamente.\r\n",
+                   (unsigned)(s_cal.ponto_atual + 1), (long)espalhamento);
+            s_cal.etapa = CAL_BAL_AGUARDA_PESO;
+        } else {
+            printf("CAL: Leituras instaveis (diff: %ld). Repetindo captura...\r\n", (long)espalhamento);
+            Reiniciar_Captura();
+        }
+        return;
+    }
+
+    Config_Ponto_Cal_t* p = &s_cal.pontos[s_cal.ponto_atual];
+    p->gramas = s_cal.massa_atual_g;
+    p->adc = (int32_t)(s_captura.soma / CAL_AMOSTRAS_POR_PONTO);
+    printf("CAL: Ponto %u OK: %.2f g = %ld counts\r\n",
+           (unsigned)(s_cal.ponto_atual + 1), p->gramas, (long)p->adc);
+    DWIN_Driver_WriteInt32(AD_BALANCA, p->adc);
+
+    if (s_cal.ponto_atual + 1 < s_cal.num_pontos) {
+        Preparar_Ponto(s_cal.ponto_atual + 1);
+    } else {
+        Finalizar_Pontos();
+    }
+}
+
+void Calibracao_Balanca_Process(void)
+{
+    // Remontagem da tabela em segundo plano (um segmento por chamada)
+    ADS1232_Calibration_Process();
+
+    if (s_cal.etapa == CAL_BAL_SALVANDO) {
+        // O gerenciador recusa escritas enquanto salva; tenta de novo na prxima volta
+        if (Gerenciador_Config_Set_Cal_Balanca(s_cal.pontos, s_cal.num_pontos)) {
+            printf("CAL: Calibracao concluida. Pontos enviados para a EEPROM.\r\n");
+            s_cal.etapa = CAL_BAL_OCIOSO;
+        }
+    }
+}
+
+bool Calibracao_Balanca_Pendente(void)
+{
+    return ADS1232_Calibration_IsBusy() || (s_cal.etapa == CAL_BAL_SALVANDO);
+}
+
+void Calibracao_Balanca_Get_Status(Cal_Bal_Status_t* status)
+{
+    if (status != NULL) {
+        *status = s_cal;
+    }
+}
@@ -0,0 +1,429 @@
+/*******************************************************************************
+ * @file        ciclo_medicao.c
+ * @brief       Orquestrador do ciclo de medio (enchimento, nivelamento, medio).
+ * @version     1.4 (Roda a sequncia de passos da configurao)
+ * @details     Os servos seguem a sequncia da configurao
+ * (Config_Passo_Servo_t, CLI "SEQ"), rodada pelo servo_controle. Este mdulo
+ * responde s esperas por condio dos passos com os sensores e muda de fase
+ * conforme os passos terminam. A sequncia de fbrica:
+ * 1. ENCHENDO (funil aberto, espera DOSAGEM): a vazo (mg/s) sai de uma regresso linear
+ *    sobre as ltimas amostras: 200 ms, no mnimo CICLO_VAZAO_MIN_AMOSTRAS
+ *    (600 ms a 10 SPS). O funil fecha quando peso + vazo * antecipao
+ *    alcana o Peso_Pad do gro. O plat (cmara cheia antes do alvo) e o
+ *    limite de tempo continuam como reserva.
+ * 2. NIVELANDO (funil fechado, espera QUEDA; raspador aberto, espera
+ *    PESO_ESTAVEL): a mdia sincronizada da frequncia e a converso de
+ *    temperatura comeam no fim da dosagem. Quando a massa em queda
+ *    assenta, o erro da dosagem corrige a antecipao (aprendizado por
+ *    ciclo); o raspador fica aberto at o peso voltar a ficar estvel.
+ * 3. MEDINDO (raspador fechado, espera MEDICAO): mdia da frequncia, peso
+ *    estvel e temperatura nova disponveis; no fim da sequncia o ciclo
+ *    calcula a umidade e s a publica se as trs entradas fecharam (seno
+ *    zera umidade e densidade no display).
+ * O "peso estvel" tambm  aceito pela previso do assentamento
+ * (ScaleSettle) quando ela converge antes do teste de estabilidade: o ciclo
+ * segue com o peso previsto enquanto o prato oscila.
+ * ngulos, ordem, limites e mnimos de cada passo vm da tabela, copiada na
+ * partida; os tempos medidos de cada fase ficam no status para o CLI. Os
+ * eventos dos passos (EV_SERVOS_SEQUENCE_*) saem do servo_controle.
+ ******************************************************************************/
+
+#include "ciclo_medicao.h"
+#include "servo_controle.h"
+#include "medicao_frequencia.h"
+#include "temp_sensor.h"
+#include "ads1232_driver.h"
+#include "gerenciador_configuracoes.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+//================================================================================
+// Variveis Estticas
+//================================================================================
+
+_Static_assert(CICLO_VAZAO_MIN_AMOSTRAS <= CICLO_PESO_AMOSTRAS,
+               "CICLO_PESO_AMOSTRAS nao cobre a regressao da vazao");
+
+static Ciclo_Status_t s_status;
+
+static struct {
+    int32_t  peso_mg[CICLO_PESO_AMOSTRAS];
+    uint32_t tick_ms[CICLO_PESO_AMOSTRAS];
+    uint8_t  idx;
+    uint8_t  cont;
+    int32_t  ultimo_mg;
+    bool     estavel;
+    bool     previsto;          // Previso do assentamento convergida
+    int32_t  previsto_mg;
+    int32_t  incerteza_mg;
+} s_peso;
+
+static uint32_t s_inicio_ciclo_ms = 0;
+static uint32_t s_inicio_fase_ms = 0;
+static uint32_t s_temp_contador_ref = 0;   // Converses concludas antes do pedido do ciclo
+static uint32_t s_antecipacao_ms = CICLO_ANTECIPACAO_PADRAO_MS;
+static bool     s_aquisicao_iniciada = false; // Frequncia e temperatura pedidas neste ciclo
+static bool     s_massa_assentada = false;   // Fim da queda (ou raspador j em ao)
+static bool     s_alvo_previsto = false;     // A espera DOSAGEM foi atendida pela dosagem
+
+//================================================================================
+// Funes Privadas
+//================================================================================
+
+static void Entrar_Fase(Ciclo_Fase_t fase)
+{
+    s_status.fase = fase;
+    s_inicio_fase_ms = HAL_GetTick();
+}
+
+/**
+ * @brief Peso utilizvel: estvel de fato ou previsto com incerteza aceitvel.
+ */
+static bool Peso_Pronto(void)
+{
+    return s_peso.estavel || s_peso.previsto;
+}
+
+/**
+ * @brief Amostras que cobrem janela_ms na taxa do ADS1232.
+ */
+static uint8_t Amostras_Na_Janela(uint32_t janela_ms)
+{
+    uint32_t n = (janela_ms * ADS1232_SPS) / 1000u;
+    return (n > CICLO_PESO_AMOSTRAS) ? CICLO_PESO_AMOSTRAS : (uint8_t)n;
+}
+
+/**
+ * @brief ndice da i-sima amostra mais recente (0 = ltima).
+ */
+static uint8_t Indice_Recente(uint8_t i)
+{
+    return (uint8_t)((s_peso.idx + CICLO_PESO_AMOSTRAS - 1 - i) % CICLO_PESO_AMOSTRAS);
+}
+
+/**
+ * @brief Variao (mx - mn) nos ltimos CICLO_PLATO_JANELA_MS
+ * (no mnimo CICLO_PLATO_MIN_AMOSTRAS amostras).
+ */
+static bool Janela_Estavel(void)
+{
+    uint8_t n = Amostras_Na_Janela(CICLO_PLATO_JANELA_MS);
+    if (n < CICLO_PLATO_MIN_AMOSTRAS) n = CICLO_PLATO_MIN_AMOSTRAS;
+    if (s_peso.cont < n) return false;
+
+    int32_t minimo = INT32_MAX;
+    int32_t maximo = INT32_MIN;
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t k = Indice_Recente(i);
+        if (s_peso.peso_mg[k] < minimo) minimo = s_peso.peso_mg[k];
+        if (s_peso.peso_mg[k] > maximo) maximo = s_peso.peso_mg[k];
+    }
+    return (maximo - minimo) <= CICLO_PLATO_MG;
+}
+
+/**
+ * @brief Cmara cheia: janela estvel e peso plausvel para o gro.
+ */
+static bool Peso_Em_Plato(void)
+{
+    int32_t minimo_cheio = (s_status.alvo_mg / 100) * CICLO_CHEIO_MIN_PCT;
+    return Janela_Estavel() && (minimo_cheio > 0) && (s_peso.ultimo_mg >= minimo_cheio);
+}
+
+/**
+ * @brief Vazo em mg/s pela inclinao de mnimos quadrados (peso x tick da amostra)
+ * sobre os ltimos CICLO_VAZAO_JANELA_MS (no mnimo CICLO_VAZAO_MIN_AMOSTRAS amostras).
+ * @return 0 enquanto a janela no estiver completa.
+ */
+static int32_t Estimar_Vazao_mg_s(void)
+{
+    uint8_t n = Amostras_Na_Janela(CICLO_VAZAO_JANELA_MS);
+    if (n < CICLO_VAZAO_MIN_AMOSTRAS) n = CICLO_VAZAO_MIN_AMOSTRAS;
+    if (s_peso.cont < n) return 0;
+
+    uint32_t t0 = s_peso.tick_ms[Indice_Recente((uint8_t)(n - 1))]; // Amostra mais antiga da janela
+    int64_t soma_p = 0;
+    int64_t soma_t = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t k = Indice_Recente(i);
+        soma_p += s_peso.peso_mg[k];
+        soma_t += (int64_t)(s_peso.tick_ms[k] - t0);
+    }
+    int64_t cov = 0;
+    int64_t var_t = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t k = Indice_Recente(i);
+        int64_t dt = (int64_t)(s_peso.tick_ms[k] - t0) * n - soma_t;
+        int64_t dp = (int64_t)s_peso.peso_mg[k] * n - soma_p;
+        cov   += dt * dp;
+        var_t += dt * dt;
+    }
+    return (var_t > 0) ? (int32_t)((cov * 1000) / var_t) : 0; // mg/ms -> mg/s
+}
+
+/**
+ * @brief Dosagem: a massa ainda em queda aps o comando (vazo * antecipao)
+ * completa o alvo.
+ */
+static bool Alvo_Previsto(void)
+{
+    if (s_status.alvo_mg <= 0) return false;
+    int32_t vazao = Estimar_Vazao_mg_s();
+    if (vazao <= 0) return false;
+
+    int64_t previsto = (int64_t)s_peso.ultimo_mg + ((int64_t)vazao * s_antecipacao_ms) / 1000;
+    if (previsto < s_status.alvo_mg) return false;
+    s_status.vazao_mg_s = vazao;
+    return true;
+}
+
+/**
+ * @brief Mdia sincronizada da frequncia e converso de temperatura (uma vez por ciclo).
+ */
+static void Iniciar_Aquisicao(void)
+{
+    if (s_aquisicao_iniciada) return;
+    Medicao_Freq_Iniciar_Media(MED_FREQ_MEDIA_SEQ_JANELAS);
+    s_temp_contador_ref = TempSensor_Get_Contador();
+    TempSensor_Iniciar_Conversao();
+    s_aquisicao_iniciada = true;
+}
+
+/**
+ * @brief Fim da espera DOSAGEM: o passo seguinte da tabela fecha o funil.
+ */
+static void Encerrar_Enchimento(bool por_tempo, bool por_dosagem)
+{
+    // A frequncia e a temperatura correm durante o nivelamento
+    Iniciar_Aquisicao();
+
+    if (!por_dosagem) {
+        s_status.vazao_mg_s = Estimar_Vazao_mg_s();
+    }
+    s_status.enchimento_por_tempo = por_tempo;
+    s_status.fechou_por_dosagem = por_dosagem;
+    s_status.peso_fechamento_mg = s_peso.ultimo_mg;
+    s_status.antecipacao_ms = s_antecipacao_ms;
+    s_status.t_enchimento_ms = HAL_GetTick() - s_inicio_fase_ms;
+    s_peso.cont = 0; // A janela do assentamento comea no fechamento
+    Entrar_Fase(CICLO_NIVELANDO);
+}
+
+/**
+ * @brief A massa em queda assentou: corrige a antecipao.
+ * Antecipao ideal = massa que ainda caiu / vazo no fechamento.
+ */
+static void Registrar_Massa_Dosada(void)
+{
+    s_status.massa_dosada_mg = s_peso.ultimo_mg;
+
+    if (s_status.fechou_por_dosagem && s_status.vazao_mg_s > 0) {
+        int32_t queda_mg = s_status.massa_dosada_mg - s_status.peso_fechamento_mg;
+        int32_t ideal_ms = (int32_t)(((int64_t)queda_mg * 1000) / s_status.vazao_mg_s);
+        if (ideal_ms < CICLO_ANTECIPACAO_MIN_MS) ideal_ms = CICLO_ANTECIPACAO_MIN_MS;
+        if (ideal_ms > CICLO_ANTECIPACAO_MAX_MS) ideal_ms = CICLO_ANTECIPACAO_MAX_MS;
+        s_antecipacao_ms = (uint32_t)((int32_t)s_antecipacao_ms +
+                                      ((ideal_ms - (int32_t)s_antecipacao_ms) >> CICLO_ANTECIPACAO_SHIFT));
+    }
+    s_massa_assentada = true;
+}
+
+static void Concluir(void)
+{
+    Med_Freq_Media_t media;
+    bool freq_pronta = Medicao_Freq_Get_Media(&media);
+    bool temp_nova = s_aquisicao_iniciada && (TempSensor_Get_Contador() != s_temp_contador_ref);
+
+    uint32_t agora = HAL_GetTick();
+    s_status.t_medicao_ms = (s_status.fase == CICLO_MEDINDO) ? agora - s_inicio_fase_ms : 0;
+    s_status.t_total_ms = agora - s_inicio_ciclo_ms;
+    s_status.peso_por_previsao = !s_peso.estavel && s_peso.previsto;
+    s_status.peso_mg = s_status.peso_por_previsao ? s_peso.previsto_mg : s_peso.ultimo_mg;
+    s_status.incerteza_mg = s_status.peso_por_previsao ? s_peso.incerteza_mg : 0;
+    s_status.freq_chz = freq_pronta ? media.media_chz : 0;
+    s_status.temp_x100 = (int32_t)lrintf(TempSensor_Get_Ultima() * 100.0f);
+    s_status.resultado_valido = freq_pronta && Peso_Pronto() && temp_nova;
+
+    if (freq_pronta) {
+        Calculo_Umidade_Calcular(s_status.freq_chz, s_status.peso_mg, s_status.temp_x100, &s_status.umidade);
+    }
+    // Um resultado incompleto fica s no status (CLI): o display no mostra umidade velha nem parcial
+    if (s_status.resultado_valido) {
+        Calculo_Umidade_Publicar(&s_status.umidade);
+    } else {
+        Calculo_Umidade_Limpar();
+    }
+    s_status.ciclos++;
+    Entrar_Fase(CICLO_CONCLUIDO);
+
+    printf("CICLO: concluido em %lu ms (enche %lu, nivela %lu, mede %lu)%s\r\n",
+           (unsigned long)s_status.t_total_ms, (unsigned long)s_status.t_enchimento_ms,
+           (unsigned long)s_status.t_nivelamento_ms, (unsigned long)s_status.t_medicao_ms,
+           s_status.resultado_valido ? "" : " [INCOMPLETO]");
+}
+
+/**
+ * @brief Esperas por condio dos passos (Funcao_Condicao_Seq_t). O servo_controle
+ * s consulta depois do minimo_ms do passo e encerra pelo limite.
+ */
+static bool Condicao_Passo(Servo_Seq_Espera_t espera)
+{
+    switch (espera)
+    {
+        case SERVO_SEQ_DOSAGEM:
+            if (Alvo_Previsto()) {
+                s_alvo_previsto = true;
+                return true;
+            }
+            return Peso_Em_Plato();
+        case SERVO_SEQ_QUEDA:
+            return Janela_Estavel();
+        case SERVO_SEQ_PESO_ESTAVEL:
+            return Peso_Pronto();
+        case SERVO_SEQ_MEDICAO:
+            // Depois do ltimo movimento: o retorno do servo mexe no prato
+            return !Servos_Em_Movimento() && Medicao_Freq_Get_Media(NULL) && Peso_Pronto() &&
+                   s_aquisicao_iniciada && TempSensor_Get_Contador() != s_temp_contador_ref;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Efeitos da entrada no passo atual da sequncia.
+ */
+static void Entrar_Passo(void)
+{
+    Servo_Seq_Status_t seq;
+    Servos_Get_Status_Sequencia(&seq);
+    if (!seq.ativa) return;
+
+    if (seq.servo != SERVO_SEQ_NENHUM) {
+        s_peso.estavel = false; // Servo em movimento mexe no prato: exige nova estabilidade
+        s_peso.previsto = false;
+    }
+    if (seq.servo == SERVO_SEQ_RASPADOR) {
+        s_massa_assentada = true; // A queda no  mais medida
+    }
+    if (seq.espera == SERVO_SEQ_MEDICAO && s_status.fase != CICLO_MEDINDO) {
+        Iniciar_Aquisicao();
+        if (s_status.fase == CICLO_NIVELANDO) {
+            s_status.t_nivelamento_ms = HAL_GetTick() - s_inicio_fase_ms;
+        }
+        Entrar_Fase(CICLO_MEDINDO);
+    }
+}
+
+/**
+ * @brief Um passo terminou: registra o que a espera dele significa para o ciclo.
+ */
+static void Fim_Passo(const Servo_Seq_Transicao_t* t)
+{
+    switch (t->espera)
+    {
+        case SERVO_SEQ_DOSAGEM:
+            if (s_status.fase == CICLO_ENCHENDO) {
+                Encerrar_Enchimento(t->por_limite, s_alvo_previsto);
+            }
+            break;
+        case SERVO_SEQ_QUEDA:
+            if (s_status.fase == CICLO_NIVELANDO && !s_massa_assentada) {
+                Registrar_Massa_Dosada();
+            }
+            break;
+        case SERVO_SEQ_PESO_ESTAVEL:
+            if (s_status.fase == CICLO_NIVELANDO && t->por_limite) {
+                s_status.nivelamento_por_tempo = true;
+            }
+            break;
+        case SERVO_SEQ_MEDICAO:
+            s_status.medicao_por_tempo = t->por_limite;
+            break;
+        default:
+            break;
+    }
+
+    if (t->fim) {
+        Concluir();
+    } else {
+        Entrar_Passo();
+    }
+}
+
+//================================================================================
+// Funes Pblicas
+//================================================================================
+
+bool Ciclo_Medicao_Iniciar(void)
+{
+    if (s_status.fase == CICLO_ENCHENDO || s_status.fase == CICLO_NIVELANDO ||
+        s_status.fase == CICLO_MEDINDO) {
+        return false;
+    }
+
+    uint32_t ciclos = s_status.ciclos;
+    memset(&s_status, 0, sizeof(s_status));
+    memset(&s_peso, 0, sizeof(s_peso));
+    s_status.ciclos = ciclos;
+    s_status.alvo_mg = Calculo_Umidade_Get_Peso_Pad_mg();
+    s_aquisicao_iniciada = false;
+    s_massa_assentada = false;
+    s_alvo_previsto = false;
+
+    s_inicio_ciclo_ms = HAL_GetTick();
+    Entrar_Fase(CICLO_ENCHENDO);
+    if (!Servos_Start_Sequence(Condicao_Passo)) {
+        s_status.fase = CICLO_OCIOSO;
+        return false;
+    }
+    Entrar_Passo();
+    return true;
+}
+
+void Ciclo_Medicao_Process(void)
+{
+    if (s_status.fase != CICLO_ENCHENDO && s_status.fase != CICLO_NIVELANDO &&
+        s_status.fase != CICLO_MEDINDO) {
+        return;
+    }
+
+    Servo_Seq_Transicao_t transicao;
+    if (Servos_Sequence_Process(&transicao)) {
+        Fim_Passo(&transicao);
+    }
+}
+
+void Ciclo_Medicao_Nova_Amostra_Peso(int32_t peso_mg, uint32_t tick_ms, bool estavel)
+{
+    s_peso.peso_mg[s_peso.idx] = peso_mg;
+    s_peso.tick_ms[s_peso.idx] = tick_ms;
+    s_peso.idx = (uint8_t)((s_peso.idx + 1) % CICLO_PESO_AMOSTRAS);
+    if (s_peso.cont < CICLO_PESO_AMOSTRAS) s_peso.cont++;
+    s_peso.ultimo_mg = peso_mg;
+    s_peso.estavel = estavel;
+}
+
+void Ciclo_Medicao_Nova_Previsao_Peso(bool convergiu, int32_t previsto_mg, int32_t incerteza_mg)
+{
+    s_peso.previsto = convergiu;
+    s_peso.previsto_mg = previsto_mg;
+    s_peso.incerteza_mg = incerteza_mg;
+}
+
+uint32_t Ciclo_Medicao_Get_Antecipacao_ms(void)
+{
+    return s_antecipacao_ms;
+}
+
+Ciclo_Fase_t Ciclo_Medicao_Get_Fase(void)
+{
+    return s_status.fase;
+}
+
+void Ciclo_Medicao_Get_Status(Ciclo_Status_t* status)
+{
+    if (status != NULL) {
+        *status = s_status;
+    }
+}
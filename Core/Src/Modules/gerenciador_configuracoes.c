@@ -7,11 +7,16 @@
  * 1. Funes 'Set' apenas atualizam o cache da RAM e definem um flag 'dirty'.
  * 2. A FSM (Run_FSM) detecta o flag e inicia a escrita NO-BLOQUEANTE (DMA).
  * 3. Mantm a lgica robusta de 3 cpias (Primria, BKP1, BKP2) + CRC32 HW.
+ * 4. Um bloco V1 (firmware original)  migrado no boot.
  ******************************************************************************/
 
 #include "gerenciador_configuracoes.h"
 #include "eeprom_driver.h" 
 #include "GXXX_Equacoes.h"
+#include "ads1232_driver.h"   // Calibrao de fbrica da balana (padro)
+#include "scale_filter.h"     // Tipos de estgio do filtro padro
+#include "ciclo_medicao.h"    // Tempos da sequncia de fbrica
+#include "servo_controle.h"   // Servos, ngulos e esperas dos passos
 #include "retarget.h"
 #include <string.h>
 #include <stdio.h>
@@ -56,6 +61,35 @@ static struct {
 } s_storage_fsm = { FSM_STORE_IDLE, false, false, 0 }; 
 ;
 
+//================================================================================
+// Layout V1 do Bloco (Migrao no Boot)
+//================================================================================
+
+typedef struct {                    // V1: firmware original (o nico layout gravado em campo)
+    uint32_t versao_struct;
+    uint8_t indice_idioma_selecionado;
+    uint8_t indice_grao_ativo;
+    uint8_t preenchimento[2];       // Hoje num_repeticoes e servo_rampa_10ms (0 = padro)
+    char senha_sistema[MAX_SENHA_LEN + 2];
+    float fat_cal_a_gain;
+    float fat_cal_a_zero;
+    Config_Grao_t graos[MAX_GRAOS];
+    uint32_t crc;
+} Config_V1_t;
+
+#define EEPROM_V1_BLOCK_SPACING ((((uint16_t)sizeof(Config_V1_t) / EEPROM_PAGE_SIZE) + 1) * EEPROM_PAGE_SIZE)
+
+// Tamanho gravado em campo: se mudar, a migrao leria lixo
+_Static_assert(sizeof(Config_V1_t) == 284, "layout V1 alterado");
+_Static_assert(EEPROM_V1_BLOCK_SPACING == 288, "espacamento das copias V1 alterado");
+// A migrao converte no prprio cache: o cabealho no muda de lugar
+_Static_assert(offsetof(Config_V1_t, graos) == offsetof(Config_Aplicacao_t, cal_bal_num_pontos),
+               "cabecalho do bloco atual diverge do V1");
+_Static_assert(sizeof(Config_V1_t) <= sizeof(Config_Aplicacao_t), "bloco V1 nao cabe no cache");
+// Mapa das trs cpias (comentrios de CONFIG_PAGES_NEEDED / EEPROM_CONFIG_BLOCK_SPACING)
+_Static_assert(sizeof(Config_Aplicacao_t) == 484, "layout V2 alterado: atualize o mapa no .h");
+_Static_assert(EEPROM_CONFIG_BLOCK_SPACING == 512, "espacamento das copias alterado");
+
 
 //================================================================================
 // Prottipos Privados
@@ -65,6 +99,9 @@ static void Recalcular_E_Atualizar_CRC_Cache(void);
 static bool Tentar_Carregar_De_Endereco(uint16_t address, Config_Aplicacao_t* config);
 static bool Carregar_Primeira_Config_Valida(Config_Aplicacao_t* config_out);
 static void Carregar_Configuracao_Padrao(void);
+static void Carregar_Sequencia_Padrao(void);
+static void Carregar_Campos_V2_Padrao(void);
+static bool Migrar_Configuracao_V1(void);
 
 
 //================================================================================
@@ -79,6 +116,14 @@ void Gerenciador_Config_Init(CRC_HandleTypeDef* hcrc)
     s_storage_fsm.is_saving = false;
 }
 
+/**
+ * @brief Consulta do agendador: a FSM s precisa rodar com algo a gravar.
+ */
+bool Gerenciador_Config_Pendente(void)
+{
+    return s_storage_fsm.dirty || s_storage_fsm.is_saving;
+}
+
 /**
  * @brief (V8.2) FSM de Armazenamento - CHAMADA NO SUPERLOOP (por app_manager.c)
  * Executa a lgica de salvamento assncrona.
@@ -267,6 +312,12 @@ bool Gerenciador_Config_Validar_e_Restaurar(void)
         return true;
     }
 
+    if (Migrar_Configuracao_V1())
+    {
+        s_storage_fsm.dirty = true; // Regrava as 3 cpias no layout atual
+        return true;
+    }
+
     printf("EEPROM Manager: ERRO FATAL! Todas as copias corrompidas. Carregando Fabrica.\n");
     Carregar_Configuracao_Padrao(); // Carrega padres na s_config_cache RAM
     s_storage_fsm.dirty = true;   // Marca para salvar os padres na EEPROM
@@ -280,12 +331,14 @@ static void Carregar_Configuracao_Padrao(void)
 {
     memset(&s_config_cache, 0, sizeof(Config_Aplicacao_t));
 
-    s_config_cache.versao_struct = 1;
+    s_config_cache.versao_struct = CONFIG_VERSAO_STRUCT;
     s_config_cache.indice_idioma_selecionado = 0;
     strncpy(s_config_cache.senha_sistema, "senha", MAX_SENHA_LEN);
     s_config_cache.senha_sistema[MAX_SENHA_LEN] = '\0';
     s_config_cache.fat_cal_a_gain = 1.0f;
     s_config_cache.fat_cal_a_zero = 0.0f;
+
+    Carregar_Campos_V2_Padrao();
 		
     for (int i = 0; i < MAX_GRAOS; i++)
     {
@@ -300,6 +353,72 @@ static void Carregar_Configuracao_Padrao(void)
     // O CRC ser calculado pela FSM antes de salvar.
 }
 
+/**
+ * @brief Padres dos campos que o V1 no tinha: os dois bytes de preenchimento
+ * do cabealho e tudo entre o cabealho e os gros. No mexe no resto do cache.
+ */
+static void Carregar_Campos_V2_Padrao(void)
+{
+    memset(&s_config_cache.cal_bal_num_pontos, 0,
+           offsetof(Config_Aplicacao_t, graos) - offsetof(Config_Aplicacao_t, cal_bal_num_pontos));
+    s_config_cache.num_repeticoes = REPETICOES_PADRAO;
+    s_config_cache.servo_rampa_10ms = SERVO_RAMPA_PADRAO_MS / 10;
+
+    s_config_cache.cal_bal_num_pontos = ADS1232_CAL_PADRAO_PONTOS;
+    for (int i = 0; i < ADS1232_CAL_PADRAO_PONTOS; i++)
+    {
+        s_config_cache.cal_bal_pontos[i].gramas = ADS1232_CAL_PADRAO[i].grams;
+        s_config_cache.cal_bal_pontos[i].adc = ADS1232_CAL_PADRAO[i].adc_value;
+    }
+
+    // Filtro padro: mediana de 5 + mdia mvel de 8 amostras, fast-settle acima de 0.3 g
+    s_config_cache.filtro_mediana_janela = MEDIANA_BALANCA_PADRAO;
+    s_config_cache.filtro_num_estagios = 1;
+    s_config_cache.filtro_degrau_mg = 300;
+    s_config_cache.filtro_estagios[0].tipo = SF_STAGE_MOVING_AVG;
+    s_config_cache.filtro_estagios[0].janela = 8;
+
+    Carregar_Sequencia_Padrao();
+}
+
+/**
+ * @brief Sequncia de fbrica do ciclo de medio: funil aberto at a dosagem,
+ * queda da massa, raspador aberto at o peso estvel e fechado durante a
+ * medio. Os tempos so os CICLO_*_MS do ciclo_medicao.h.
+ */
+static const Config_Passo_Servo_t s_sequencia_padrao[] = {
+    { SERVO_SEQ_FUNIL,    SERVO_ANGULO_FUNIL_ABRE, SERVO_SEQ_DOSAGEM,      0, CICLO_ENCHIMENTO_MAX_MS, CICLO_ENCHIMENTO_MIN_MS },
+    { SERVO_SEQ_FUNIL,    SERVO_ANGULO_FECHADO,    SERVO_SEQ_QUEDA,        0, CICLO_QUEDA_MAX_MS,      0 },
+    { SERVO_SEQ_RASPADOR, SERVO_ANGULO_SCRAP_ABRE, SERVO_SEQ_PESO_ESTAVEL, 0, CICLO_RASPAGEM_MAX_MS,   CICLO_RASPAGEM_MIN_MS },
+    { SERVO_SEQ_RASPADOR, SERVO_ANGULO_FECHADO,    SERVO_SEQ_MEDICAO,      0, CICLO_MEDICAO_MAX_MS,    0 },
+};
+#define NUM_PASSOS_SEQUENCIA_PADRAO (sizeof(s_sequencia_padrao) / sizeof(s_sequencia_padrao[0]))
+
+static void Carregar_Sequencia_Padrao(void)
+{
+    memset(s_config_cache.seq_passos, 0, sizeof(s_config_cache.seq_passos));
+    memcpy(s_config_cache.seq_passos, s_sequencia_padrao, sizeof(s_sequencia_padrao));
+    s_config_cache.seq_num_passos = NUM_PASSOS_SEQUENCIA_PADRAO;
+}
+
+/**
+ * @brief Uma espera por condio do ciclo sem limite travaria o ciclo: o
+ * limite  obrigatrio e o mnimo no pode passar dele.
+ */
+static bool Sequencia_Valida(const Config_Passo_Servo_t* passos, uint8_t num_passos)
+{
+    if (num_passos == 0 || num_passos > MAX_PASSOS_SEQUENCIA) return false;
+    for (uint8_t i = 0; i < num_passos; i++)
+    {
+        const Config_Passo_Servo_t* p = &passos[i];
+        if (p->servo > SERVO_SEQ_RASPADOR || p->angulo > SERVO_ANGULO_MAX) return false;
+        if (p->espera >= SERVO_SEQ_NUM_ESPERAS || p->duracao_ms > CICLO_TEMPO_MAX_MS) return false;
+        if (p->espera >= SERVO_SEQ_PESO_ESTAVEL && p->duracao_ms == 0) return false;
+        if (p->duracao_ms > 0 && p->minimo_ms > p->duracao_ms) return false;
+    }
+    return true;
+}
+
 // (Removida: Gerenciador_Config_Forcar_Restauracao_Padrao(). Substituda pela lgica acima).
 
 //================================================================================
@@ -346,6 +465,94 @@ bool Gerenciador_Config_Set_Cal_A(float gain, float zero)
     return true;
 }
 
+bool Gerenciador_Config_Set_Cal_Balanca(const Config_Ponto_Cal_t* pontos, uint8_t num_pontos)
+{
+    if (pontos == NULL || num_pontos < 2 || num_pontos > MAX_PONTOS_CAL_BALANCA) return false;
+    if (s_storage_fsm.is_saving) return false; 
+
+    memset(s_config_cache.cal_bal_pontos, 0, sizeof(s_config_cache.cal_bal_pontos));
+    memcpy(s_config_cache.cal_bal_pontos, pontos, num_pontos * sizeof(Config_Ponto_Cal_t));
+    s_config_cache.cal_bal_num_pontos = num_pontos;
+    s_storage_fsm.dirty = true;
+    return true;
+}
+
+bool Gerenciador_Config_Set_Filtro_Balanca(const Config_Estagio_Filtro_t* estagios, uint8_t num_estagios, uint16_t degrau_mg)
+{
+    if (num_estagios > MAX_ESTAGIOS_FILTRO_BALANCA) return false;
+    if (num_estagios > 0 && estagios == NULL) return false;
+    if (s_storage_fsm.is_saving) return false; 
+
+    memset(s_config_cache.filtro_estagios, 0, sizeof(s_config_cache.filtro_estagios));
+    if (num_estagios > 0) {
+        memcpy(s_config_cache.filtro_estagios, estagios, num_estagios * sizeof(Config_Estagio_Filtro_t));
+    }
+    s_config_cache.filtro_num_estagios = num_estagios;
+    s_config_cache.filtro_degrau_mg = degrau_mg;
+    s_storage_fsm.dirty = true;
+    return true;
+}
+
+bool Gerenciador_Config_Set_Mediana_Balanca(uint8_t janela)
+{
+    if (janela < SF_MEDIAN_WIN_MIN || janela > SF_MEDIAN_WIN_MAX || (janela & 1u) == 0) return false;
+    if (s_storage_fsm.is_saving) return false; 
+
+    s_config_cache.filtro_mediana_janela = janela;
+    s_storage_fsm.dirty = true;
+    return true;
+}
+
+bool Gerenciador_Config_Set_Repeticoes(uint8_t repeticoes)
+{
+    if (repeticoes == 0 || repeticoes > MAX_REPETICOES) return false;
+    if (s_storage_fsm.is_saving) return false; 
+
+    s_config_cache.num_repeticoes = repeticoes;
+    s_storage_fsm.dirty = true;
+    return true;
+}
+
+bool Gerenciador_Config_Set_Servo_Rampa_ms(uint32_t duracao_ms)
+{
+    if (duracao_ms < SERVO_RAMPA_MIN_MS || duracao_ms > SERVO_RAMPA_MAX_MS) return false;
+    if (s_storage_fsm.is_saving) return false; 
+
+    s_config_cache.servo_rampa_10ms = (uint8_t)((duracao_ms + 5) / 10);
+    s_storage_fsm.dirty = true;
+    return true;
+}
+
+bool Gerenciador_Config_Set_Sequencia_Servos(const Config_Passo_Servo_t* passos, uint8_t num_passos)
+{
+    if (passos == NULL || !Sequencia_Valida(passos, num_passos)) return false;
+    if (s_storage_fsm.is_saving) return false; 
+
+    memset(s_config_cache.seq_passos, 0, sizeof(s_config_cache.seq_passos));
+    memcpy(s_config_cache.seq_passos, passos, num_passos * sizeof(Config_Passo_Servo_t));
+    s_config_cache.seq_num_passos = num_passos;
+    s_storage_fsm.dirty = true;
+    return true;
+}
+
+bool Gerenciador_Config_Restaurar_Sequencia_Servos(void)
+{
+    if (s_storage_fsm.is_saving) return false; 
+
+    Carregar_Sequencia_Padrao();
+    s_storage_fsm.dirty = true;
+    return true;
+}
+
+bool Gerenciador_Config_Set_Volume_Camara_ml(uint16_t volume_ml)
+{
+    if (volume_ml > VOLUME_CAMARA_MAX_ML) return false;
+    if (s_storage_fsm.is_saving) return false; 
+
+    s_config_cache.volume_camara_ml = volume_ml;
+    s_storage_fsm.dirty = true;
+    return true;
+}
 
 //================================================================================
 // FUNES "GET" (REFATORADAS V8.2) - Agora leem do Cache RAM (instantneo)
@@ -398,6 +605,74 @@ bool Gerenciador_Config_Get_Cal_A(float* gain, float* zero)
     return true;
 }
 
+/**
+ * @brief Copia os pontos de calibrao da balana. Retorna quantos foram copiados
+ * (0 se a tabela salva for invlida).
+ */
+uint8_t Gerenciador_Config_Get_Cal_Balanca(Config_Ponto_Cal_t* pontos, uint8_t max_pontos)
+{
+    uint8_t n = s_config_cache.cal_bal_num_pontos;
+    if (pontos == NULL || n < 2 || n > MAX_PONTOS_CAL_BALANCA || n > max_pontos) return 0;
+    memcpy(pontos, s_config_cache.cal_bal_pontos, n * sizeof(Config_Ponto_Cal_t));
+    return n;
+}
+
+/**
+ * @brief Copia a cadeia de filtros da balana. Retorna o nmero de estgios.
+ */
+uint8_t Gerenciador_Config_Get_Filtro_Balanca(Config_Estagio_Filtro_t* estagios, uint8_t max_estagios, uint16_t* degrau_mg)
+{
+    uint8_t n = s_config_cache.filtro_num_estagios;
+    if (estagios == NULL || n > MAX_ESTAGIOS_FILTRO_BALANCA || n > max_estagios) return 0;
+    memcpy(estagios, s_config_cache.filtro_estagios, n * sizeof(Config_Estagio_Filtro_t));
+    if (degrau_mg != NULL) *degrau_mg = s_config_cache.filtro_degrau_mg;
+    return n;
+}
+
+uint8_t Gerenciador_Config_Get_Mediana_Balanca(void)
+{
+    uint8_t janela = s_config_cache.filtro_mediana_janela;
+    // Janelas abaixo do mnimo (ou 0) valem o padro
+    return (janela < SF_MEDIAN_WIN_MIN) ? MEDIANA_BALANCA_PADRAO : janela;
+}
+
+uint8_t Gerenciador_Config_Get_Repeticoes(void)
+{
+    uint8_t n = s_config_cache.num_repeticoes;
+    return (n == 0 || n > MAX_REPETICOES) ? REPETICOES_PADRAO : n; // 0: bloco V1
+}
+
+uint32_t Gerenciador_Config_Get_Servo_Rampa_ms(void)
+{
+    uint32_t ms = (uint32_t)s_config_cache.servo_rampa_10ms * 10u;
+    return (ms < SERVO_RAMPA_MIN_MS) ? SERVO_RAMPA_PADRAO_MS : ms; // 0: bloco V1
+}
+
+uint16_t Gerenciador_Config_Get_Volume_Camara_ml(void)
+{
+    uint16_t ml = s_config_cache.volume_camara_ml;
+    return (ml > VOLUME_CAMARA_MAX_ML) ? 0 : ml; // Sem padro de fbrica: a cmara no foi medida
+}
+
+/**
+ * @brief Copia os passos da sequncia dos servos (os de fbrica se os salvos
+ * forem invlidos). Retorna quantos foram copiados.
+ */
+uint8_t Gerenciador_Config_Get_Sequencia_Servos(Config_Passo_Servo_t* passos, uint8_t max_passos)
+{
+    if (passos == NULL) return 0;
+
+    uint8_t n = s_config_cache.seq_num_passos;
+    const Config_Passo_Servo_t* origem = s_config_cache.seq_passos;
+    if (!Sequencia_Valida(origem, n))
+    {
+        n = NUM_PASSOS_SEQUENCIA_PADRAO;
+        origem = s_sequencia_padrao;
+    }
+    if (n > max_passos) return 0;
+    memcpy(passos, origem, n * sizeof(Config_Passo_Servo_t));
+    return n;
+}
 
 //================================================================================
 // Funes Internas de CRC e Carregamento (Usadas apenas no Boot)
@@ -431,6 +706,13 @@ static bool Tentar_Carregar_De_Endereco(uint16_t address, Config_Aplicacao_t* co
         return false; 
     }
     
+    if (config_out->versao_struct != CONFIG_VERSAO_STRUCT)
+    {
+        printf("EEPROM Check: Versao %lu no endereco 0x%X (esperada %u)\r\n",
+               (unsigned long)config_out->versao_struct, address, CONFIG_VERSAO_STRUCT);
+        return false;
+    }
+
     uint32_t crc_armazenado = config_out->crc;
     
     // Calcula o CRC esperado
@@ -458,5 +740,33 @@ static bool Carregar_Primeira_Config_Valida(Config_Aplicacao_t* config_out)
     return false;
 }
 
+/**
+ * @brief (Funo BLOQUEANTE de Boot) Procura uma cpia vlida do bloco V1 e a
+ * converte para o layout atual no prprio cache (sem buffer extra): o
+ * cabealho fica onde est, os gros vo para o fim do bloco novo e os
+ * campos novos recebem o padro de fbrica.
+ */
+static bool Migrar_Configuracao_V1(void)
+{
+    const Config_V1_t* v1 = (const Config_V1_t*)&s_config_cache;
+
+    for (uint8_t copia = 0; copia < 3; copia++)
+    {
+        uint16_t address = (uint16_t)(ADDR_CONFIG_PRIMARY + copia * EEPROM_V1_BLOCK_SPACING);
+        if (!EEPROM_Driver_Read_Blocking(address, (uint8_t*)&s_config_cache, sizeof(Config_V1_t))) continue;
+        if (v1->versao_struct != 1) continue;
+        if (HAL_CRC_Calculate(s_crc_handle, (uint32_t*)&s_config_cache, offsetof(Config_V1_t, crc) / 4) != v1->crc) continue;
+
+        memmove(s_config_cache.graos, v1->graos, sizeof(s_config_cache.graos));
+        Carregar_Campos_V2_Padrao();
+        s_config_cache.versao_struct = CONFIG_VERSAO_STRUCT;
+        s_config_cache.senha_sistema[MAX_SENHA_LEN] = '\0';
+
+        printf("EEPROM Manager: Bloco V1 (endereco 0x%X) migrado para V%u.\n", address, CONFIG_VERSAO_STRUCT);
+        return true;
+    }
+    return false;
+}
+
 // (Removida: Salvar_Configuracao_Completa. Substituda pela FSM Run().)
 // (Removida: Carregar_Primeira_Config_Valida (agora usada apenas internamente no boot)).
\ No newline at end of file
@@ -0,0 +1,201 @@
+/*******************************************************************************
+ * @file        medicao_frequencia.c
+ * @brief       Aquisio e estatstica da frequncia do sensor capacitivo.
+ * @version     1.0
+ * @details     Camada entre o pcb_frequency (hardware) e a aplicao:
+ * 1. A janela de medio tem configurao prpria (50 ms a 2 s); antes ela
+ *    era o prprio DISPLAY_UPDATE_INTERVAL_MS do app_manager.
+ * 2. Cada resultado entra num histrico circular com mdia, sigma e deriva
+ *    (inclinao por mnimos quadrados contra o tick de chegada). No
+ *    recproco entra s a janela mais recente (Frequency_Get_Janela_cHz):
+ *    a soma deslizante repetiria janelas entre resultados e o sigma sairia
+ *    menor que o real.
+ * 3. Mdia sincronizada: a aplicao pede N janelas num ponto fixo da
+ *    sequncia; s entram resultados medidos inteiramente aps o pedido.
+ * Tudo em inteiros (centsimos de Hz), sem float no caminho.
+ ******************************************************************************/
+
+#include "medicao_frequencia.h"
+#include "scale_fixed.h"
+#include <string.h>
+
+//================================================================================
+// Variveis Estticas
+//================================================================================
+
+static struct {
+    uint32_t valor_chz[MED_FREQ_HISTORICO];
+    uint32_t tick_ms[MED_FREQ_HISTORICO];
+    uint8_t  idx;
+    uint8_t  cont;
+} s_hist;
+
+static Med_Freq_Stats_t s_stats;
+
+static struct {
+    Med_Freq_Media_t pub;
+    uint8_t  descartar;      // Resultados que ainda misturam janelas de antes do pedido
+    uint32_t referencia;     // Primeiro valor: soma dos desvios fica pequena
+    int64_t  soma;
+    int64_t  soma_quad;
+} s_media;
+
+//================================================================================
+// Funes Privadas
+//================================================================================
+
+static void Limpar_Historico(void)
+{
+    memset(&s_hist, 0, sizeof(s_hist));
+    s_stats.ultima_chz = 0;
+    s_stats.media_chz = 0;
+    s_stats.sigma_chz = 0;
+    s_stats.deriva_chz_s = 0;
+    s_stats.amostras = 0;
+
+    Frequency_Stats_t fs;
+    Frequency_Get_Stats(&fs);
+    s_stats.janela_ms = fs.janela_ms;
+
+    // Uma mdia sincronizada em curso perderia a referncia de tempo
+    if (s_media.pub.estado == MED_FREQ_MEDIA_COLETANDO) {
+        s_media.pub.estado = MED_FREQ_MEDIA_OCIOSA;
+    }
+}
+
+/**
+ * @brief Recalcula mdia, sigma e deriva sobre o histrico (at 32 pontos).
+ */
+static void Atualizar_Estatisticas(void)
+{
+    uint8_t n = s_hist.cont;
+    int64_t soma_v = 0;
+    int64_t soma_t = 0;
+    uint32_t t0 = s_hist.tick_ms[(s_hist.idx + MED_FREQ_HISTORICO - n) % MED_FREQ_HISTORICO];
+
+    for (uint8_t i = 0; i < n; i++) {
+        soma_v += s_hist.valor_chz[i];
+        soma_t += (int64_t)(s_hist.tick_ms[i] - t0);
+    }
+    int64_t media_v = soma_v / n;
+    int64_t media_t = soma_t / n;
+
+    uint64_t var = 0;
+    int64_t  cov = 0;
+    int64_t  var_t = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        int64_t dv = (int64_t)s_hist.valor_chz[i] - media_v;
+        int64_t dt = (int64_t)(s_hist.tick_ms[i] - t0) - media_t;
+        var   += (uint64_t)(dv * dv);
+        cov   += dv * dt;
+        var_t += dt * dt;
+    }
+
+    s_stats.media_chz = (uint32_t)media_v;
+    s_stats.sigma_chz = Scale_Isqrt64(var / n);
+    s_stats.deriva_chz_s = (var_t > 0) ? (int32_t)((cov * 1000) / var_t) : 0; // cHz/ms -> cHz/s
+    s_stats.amostras = n;
+}
+
+static void Acumular_Media(uint32_t valor_chz)
+{
+    if (s_media.pub.estado != MED_FREQ_MEDIA_COLETANDO) return;
+
+    if (s_media.descartar > 0) {
+        s_media.descartar--;
+        return;
+    }
+
+    if (s_media.pub.janelas == 0) {
+        s_media.referencia = valor_chz;
+    }
+    int64_t d = (int64_t)valor_chz - s_media.referencia;
+    s_media.soma += d;
+    s_media.soma_quad += d * d;
+    s_media.pub.janelas++;
+
+    if (s_media.pub.janelas < s_media.pub.janelas_alvo) return;
+
+    int64_t n = s_media.pub.janelas;
+    int64_t var = (s_media.soma_quad - (s_media.soma * s_media.soma) / n) / n;
+    s_media.pub.media_chz = (uint32_t)((int64_t)s_media.referencia + s_media.soma / n);
+    s_media.pub.sigma_chz = Scale_Isqrt64((uint64_t)(var > 0 ? var : 0));
+    s_media.pub.estado = MED_FREQ_MEDIA_PRONTA;
+}
+
+//================================================================================
+// Funes Pblicas
+//================================================================================
+
+void Medicao_Freq_Init(void)
+{
+    Frequency_Init();
+    memset(&s_media, 0, sizeof(s_media));
+    s_media.pub.estado = MED_FREQ_MEDIA_OCIOSA;
+    Limpar_Historico();
+}
+
+bool Medicao_Freq_Process(void)
+{
+    if (!Frequency_Process(NULL)) {
+        return false;
+    }
+
+    uint32_t valor = Frequency_Get_Janela_cHz(); // Resultados independentes entre si
+    s_hist.valor_chz[s_hist.idx] = valor;
+    s_hist.tick_ms[s_hist.idx] = HAL_GetTick();
+    s_hist.idx = (uint8_t)((s_hist.idx + 1) % MED_FREQ_HISTORICO);
+    if (s_hist.cont < MED_FREQ_HISTORICO) s_hist.cont++;
+
+    s_stats.ultima_chz = Frequency_Get_Freq_cHz();
+    Atualizar_Estatisticas();
+    Acumular_Media(valor);
+    return true;
+}
+
+bool Medicao_Freq_Set_Janela_ms(uint32_t janela_ms)
+{
+    if (!Frequency_Set_Janela_ms(janela_ms)) {
+        return false;
+    }
+    Limpar_Historico();
+    return true;
+}
+
+void Medicao_Freq_Set_Modo(Freq_Modo_t modo)
+{
+    Frequency_Set_Modo(modo);
+    Limpar_Historico();
+}
+
+uint32_t Medicao_Freq_Get_Ultima_cHz(void)
+{
+    return s_stats.ultima_chz;
+}
+
+void Medicao_Freq_Get_Stats(Med_Freq_Stats_t* stats)
+{
+    if (stats != NULL) {
+        *stats = s_stats;
+    }
+}
+
+void Medicao_Freq_Iniciar_Media(uint8_t janelas)
+{
+    if (janelas == 0) janelas = 1;
+    if (janelas > MED_FREQ_MEDIA_MAX_JANELAS) janelas = MED_FREQ_MEDIA_MAX_JANELAS;
+
+    memset(&s_media, 0, sizeof(s_media));
+    s_media.pub.janelas_alvo = janelas;
+    // A janela em curso comeou antes do pedido
+    s_media.descartar = 1;
+    s_media.pub.estado = MED_FREQ_MEDIA_COLETANDO;
+}
+
+bool Medicao_Freq_Get_Media(Med_Freq_Media_t* media)
+{
+    if (media != NULL) {
+        *media = s_media.pub;
+    }
+    return s_media.pub.estado == MED_FREQ_MEDIA_PRONTA;
+}
@@ -0,0 +1,194 @@
+/*******************************************************************************
+ * @file        repeticao_medicao.c
+ * @brief       Modo repetio: N ciclos de medio com estatstica corrente.
+ * @version     1.0
+ * @details     Cada ciclo concludo do ciclo_medicao entra num lote:
+ * 1. Teste de outlier pela mediana e MAD das medies j aceitas
+ *    (|x - mediana| > 3 * 1.4826 * MAD), vlido a partir da 3a aceita.
+ * 2. As aceitas atualizam mdia e varincia pelo algoritmo de Welford
+ *    (ponto fixo Q16 sobre % x100), sem guardar somas que crescem.
+ * 3. A mdia corrente vai para o display a cada repetio, com o nmero
+ *    de amostras em AMOSTRAS, sem esperar o fim do lote.
+ ******************************************************************************/
+
+#include "repeticao_medicao.h"
+#include "ciclo_medicao.h"
+#include "calculo_umidade.h"
+#include "dwin_driver.h"
+#include "scale_fixed.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//================================================================================
+// Variveis Estticas
+//================================================================================
+
+static Repet_Status_t s_status;
+
+static struct {
+    int32_t  aceitas_x100[MAX_REPETICOES];
+    int64_t  media_q16;         // Mdia de Welford (% x100, Q16)
+    int64_t  m2_q16;            // Soma dos quadrados dos desvios ((% x100), Q16)
+    int32_t  soma_densidade_x10;
+    uint32_t ciclo_ref;         // Contador do ciclo_medicao j consumido
+} s_acc;
+
+//================================================================================
+// Funes Privadas
+//================================================================================
+
+static int32_t Mediana(int32_t* v, uint8_t n)
+{
+    // Insero: no mximo MAX_REPETICOES elementos
+    for (uint8_t i = 1; i < n; i++) {
+        int32_t x = v[i];
+        int8_t j = (int8_t)(i - 1);
+        while (j >= 0 && v[j] > x) {
+            v[j + 1] = v[j];
+            j--;
+        }
+        v[j + 1] = x;
+    }
+    return (n & 1u) ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+static void Atualizar_Mediana_MAD(void)
+{
+    int32_t tmp[MAX_REPETICOES];
+    uint8_t n = s_status.aceitas;
+
+    memcpy(tmp, s_acc.aceitas_x100, n * sizeof(int32_t));
+    int32_t med = Mediana(tmp, n);
+    for (uint8_t i = 0; i < n; i++) {
+        tmp[i] = abs(s_acc.aceitas_x100[i] - med);
+    }
+    s_status.mediana_x100 = med;
+    s_status.mad_x100 = Mediana(tmp, n);
+}
+
+static bool Eh_Outlier(int32_t x100)
+{
+    if (s_status.aceitas < REPET_MAD_MIN_AMOSTRAS) return false;
+
+    int32_t mad = (s_status.mad_x100 < REPET_MAD_MIN_X100) ? REPET_MAD_MIN_X100 : s_status.mad_x100;
+    // |x - med| * 10 * 10000 > K_x10 * 14826 * MAD
+    int64_t desvio = (int64_t)abs(x100 - s_status.mediana_x100) * 100000;
+    return desvio > (int64_t)REPET_MAD_K_X10 * 14826 * mad;
+}
+
+static void Aceitar(int32_t x100, int32_t densidade_x10)
+{
+    s_acc.aceitas_x100[s_status.aceitas++] = x100;
+    s_acc.soma_densidade_x10 += densidade_x10;
+
+    // Welford: media += d / n; M2 += d * (x - media nova)
+    int64_t n = s_status.aceitas;
+    int64_t x_q16 = (int64_t)x100 << 16;
+    int64_t delta = x_q16 - s_acc.media_q16;
+    s_acc.media_q16 += delta / n;
+    s_acc.m2_q16 += (delta * (x_q16 - s_acc.media_q16)) >> 16;
+
+    s_status.media_x100 = (int32_t)((s_acc.media_q16 + (1 << 15)) >> 16);
+    if (n > 1 && s_acc.m2_q16 > 0) {
+        uint64_t var_q16 = (uint64_t)(s_acc.m2_q16 / (n - 1));
+        s_status.desvio_x100 = (int32_t)((Scale_Isqrt64(var_q16) + 128u) >> 8);
+    } else {
+        s_status.desvio_x100 = 0;
+    }
+    s_status.densidade_x10 = s_acc.soma_densidade_x10 / (int32_t)n;
+    Atualizar_Mediana_MAD();
+}
+
+/**
+ * @brief Resultado corrente no display: mdia das aceitas e repetio atual.
+ */
+static void Publicar(const Umid_Resultado_t* ultimo)
+{
+    if (s_status.aceitas > 0) {
+        Umid_Resultado_t r = *ultimo;
+        r.status = UMID_OK;
+        r.umidade_x100 = s_status.media_x100;
+        r.densidade_x10 = s_status.densidade_x10;
+        Calculo_Umidade_Publicar(&r);
+    }
+    DWIN_Driver_WriteInt(AMOSTRAS, (int16_t)s_status.executadas);
+}
+
+//================================================================================
+// Funes Pblicas
+//================================================================================
+
+bool Repeticao_Medicao_Iniciar(uint8_t repeticoes)
+{
+    if (repeticoes == 0 || repeticoes > MAX_REPETICOES || s_status.estado == REPET_MEDINDO) {
+        return false;
+    }
+
+    Ciclo_Status_t ciclo;
+    Ciclo_Medicao_Get_Status(&ciclo);
+    if (!Ciclo_Medicao_Iniciar()) {
+        return false;
+    }
+
+    memset(&s_status, 0, sizeof(s_status));
+    memset(&s_acc, 0, sizeof(s_acc));
+    s_acc.ciclo_ref = ciclo.ciclos;
+    s_status.alvo = repeticoes;
+    s_status.estado = REPET_MEDINDO;
+    return true;
+}
+
+void Repeticao_Medicao_Process(void)
+{
+    if (s_status.estado != REPET_MEDINDO) return;
+
+    Ciclo_Status_t ciclo;
+    Ciclo_Medicao_Get_Status(&ciclo);
+    if (ciclo.fase != CICLO_CONCLUIDO || ciclo.ciclos == s_acc.ciclo_ref) {
+        return;
+    }
+    s_acc.ciclo_ref = ciclo.ciclos;
+    s_status.executadas++;
+
+    const char* marca = "";
+    s_status.ultima_x100 = ciclo.umidade.umidade_x100;
+    bool valida = ciclo.resultado_valido &&
+                  ciclo.umidade.status != UMID_PESO_INVALIDO && ciclo.umidade.status != UMID_SEM_GRAO;
+    if (!valida) {
+        s_status.invalidas++;
+        marca = " [INVALIDA]";
+    } else if (Eh_Outlier(s_status.ultima_x100)) {
+        s_status.rejeitadas++;
+        marca = " [REJEITADA]";
+    } else {
+        Aceitar(s_status.ultima_x100, ciclo.umidade.densidade_x10);
+    }
+    Publicar(&ciclo.umidade);
+
+    printf("REPET: %u/%u umidade %ld.%02ld %%%s -> media %ld.%02ld %% (s %ld.%02ld, n %u)\r\n",
+           (unsigned)s_status.executadas, (unsigned)s_status.alvo,
+           (long)(s_status.ultima_x100 / 100), (long)abs(s_status.ultima_x100 % 100), marca,
+           (long)(s_status.media_x100 / 100), (long)abs(s_status.media_x100 % 100),
+           (long)(s_status.desvio_x100 / 100), (long)(s_status.desvio_x100 % 100),
+           (unsigned)s_status.aceitas);
+
+    if (s_status.executadas >= s_status.alvo || !Ciclo_Medicao_Iniciar()) {
+        s_status.estado = REPET_CONCLUIDA;
+    }
+}
+
+void Repeticao_Medicao_Cancelar(void)
+{
+    // O ciclo em curso termina normalmente; s no dispara o prximo
+    if (s_status.estado == REPET_MEDINDO) {
+        s_status.estado = REPET_CONCLUIDA;
+    }
+}
+
+void Repeticao_Medicao_Get_Status(Repet_Status_t* status)
+{
+    if (status != NULL) {
+        *status = s_status;
+    }
+}
@@ -1,19 +1,23 @@
 #include "scale_filter.h"
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 #include "ads1232_driver.h"  // para usar ADS1232_ConvertToGrams()
 
-// ganho local (gramas por count) estimado por diferena finita
-static float local_g_per_count(int32_t counts_centro)
+// Constantes da regresso sobre x = 0..N-1 (fixas para a janela)
+#define SF_N        ((int64_t)SCALE_FILTER_WIN_SIZE)
+#define SF_SUM_X    ((SF_N * (SF_N - 1)) / 2)                 // soma(i)
+#define SF_DEN_X    ((SF_N * (SF_N * SF_N - 1)) / 12)         // N*soma(i^2) - soma(i)^2, dividido por N
+
+// Move a referncia das somas para 'ref + c' sem percorrer o buffer:
+//   soma(d-c) = S1 - N*c ; soma((d-c)^2) = S2 - 2c*S1 + N*c^2 ; soma(i*(d-c)) = Sxy - c*soma(i)
+static void rebase_sums(ScaleFilter* sf, int32_t c)
 {
-    // passo pequeno em counts; aproveita sua curva para estimar o ganho local
-    float g1 = ADS1232_ConvertToGrams(counts_centro);
-    float g2 = ADS1232_ConvertToGrams(counts_centro + 64);
-    float dg = g2 - g1;
-    if (dg <= 0.0f) {
-        // fallback conservador se algo estranho acontecer
-        return 1.0f / 6200.0f;
-    }
-    return dg / 64.0f;
+    int64_t c64 = c;
+    sf->sum_d2 += (SF_N * c64 - 2 * sf->sum_d) * c64;
+    sf->sum_d  -= SF_N * c64;
+    sf->sum_id -= SF_SUM_X * c64;
+    sf->ref    += c;
 }
 
 void ScaleFilter_Init(ScaleFilter* sf, int32_t initial_counts)
@@ -23,12 +27,19 @@ void ScaleFilter_Init(ScaleFilter* sf, int32_t initial_counts)
     for (int i = 0; i < SCALE_FILTER_WIN_SIZE; i++) {
         sf->buffer[i] = initial_counts;
     }
+    // somas incrementais relativas a 'ref': com o buffer uniforme, todas comeam em zero
+    sf->ref    = initial_counts;
+    sf->sum_d  = 0;
+    sf->sum_d2 = 0;
+    sf->sum_id = 0;
     // valores default razoveis (voc pode sobrescrever com SetThresholds)
-    sf->stability_sigma_g = 0.020f;
-    sf->stability_slope_g = 0.003f;
-    sf->step_threshold_g  = 0.30f;
+    ScaleFilter_SetThresholds(sf, 0.020f, 0.003f, 0.30f);
     sf->first_avg = 1;
+#if SCALE_FIXED_POINT
+    sf->prev_avg_mg = 0;
+#else
     sf->prev_avg_g = 0.0f;
+#endif
 }
 
 void ScaleFilter_ResetWithOffset(ScaleFilter* sf, int32_t new_offset_counts)
@@ -41,52 +52,115 @@ void ScaleFilter_SetThresholds(ScaleFilter* sf,
                                float slope_g_thr,
                                float step_thr_g)
 {
+#if SCALE_FIXED_POINT
+    // converso nica (configurao) para as unidades inteiras do Push
+    sf->stability_sigma_ug = (int32_t)(sigma_g_thr * 1000000.0f + 0.5f);
+    sf->stability_slope_ug = (int32_t)(slope_g_thr * 1000000.0f + 0.5f);
+    sf->step_threshold_mg  = (int32_t)(step_thr_g * 1000.0f + 0.5f);
+#else
     sf->stability_sigma_g = sigma_g_thr;
     sf->stability_slope_g = slope_g_thr;
     sf->step_threshold_g  = step_thr_g;
+#endif
+}
+
+#if SCALE_FIXED_POINT
+// counts (Q8) * mg/count (Q24) -> g, sem estourar 64 bits
+static int32_t counts_q8_to_ug(int64_t counts_q8, int32_t gpc_q24)
+{
+    int64_t mg_q18 = (counts_q8 * gpc_q24) / (1LL << 14);
+    int64_t ug = (mg_q18 * 1000) / (1LL << 18);
+    if (ug > INT32_MAX) return INT32_MAX;
+    if (ug < -INT32_MAX) return -INT32_MAX;
+    return (int32_t)ug;
 }
+#endif
 
 void ScaleFilter_Push(ScaleFilter* sf, int32_t new_counts, ScaleFilterOut* out)
 {
-    // insere no buffer circular
+    // insere no buffer circular; a posio 'idx' guarda a amostra mais antiga
+    int32_t d_old = sf->buffer[sf->idx] - sf->ref;
+    int32_t d_new = new_counts - sf->ref;
     sf->buffer[sf->idx] = new_counts;
-    sf->idx = (sf->idx + 1) % SCALE_FILTER_WIN_SIZE;
+    sf->idx = (uint16_t)((sf->idx + 1) % SCALE_FILTER_WIN_SIZE);
     // como o Init j preencheu tudo, "filled" fica 1 desde o comeo
 
-    // clculo de mdia (counts)
-    long long sum = 0;
-    for (int i = 0; i < SCALE_FILTER_WIN_SIZE; i++) {
-        sum += sf->buffer[i];
+    // atualizao O(1): todas as amostras "andam" uma posio para trs (i -> i-1),
+    // a mais antiga sai (posio 0) e a nova entra na posio N-1
+    sf->sum_id += (int64_t)d_old - sf->sum_d + (SF_N - 1) * d_new;
+    sf->sum_d  += (int64_t)d_new - d_old;
+    sf->sum_d2 += (int64_t)d_new * d_new - (int64_t)d_old * d_old;
+
+    // mantm a referncia sobre a mdia para que S1 fique pequeno e a varincia no perca preciso
+    int32_t c = (int32_t)(sf->sum_d / SF_N);
+    if (c != 0) {
+        rebase_sums(sf, c);
     }
-    float avg_counts = (float)((double)sum / (double)SCALE_FILTER_WIN_SIZE);
 
-    // desvio padro (counts)
-    long long sum_sq_diff = 0;
-    for (int i = 0; i < SCALE_FILTER_WIN_SIZE; i++) {
-        long long diff = sf->buffer[i] - (long long)avg_counts;
-        sum_sq_diff += diff * diff;
+#if SCALE_FIXED_POINT
+    // mdia (counts, Q8)
+    int32_t mean_q8    = (int32_t)((sf->sum_d * 256) / SF_N);
+    int32_t avg_counts = sf->ref + ((mean_q8 + 128) >> 8);
+
+    // desvio padro (counts, Q8): sqrt(E[d] - E[d]) em Q16 antes da raiz
+    int64_t var_q16;
+    if (sf->sum_d2 > (INT64_MAX >> 16)) {
+        var_q16 = INT64_MAX; // degrau enorme na janela: certamente instvel
+    } else {
+        var_q16 = ((sf->sum_d2 * 65536) / SF_N) - (int64_t)mean_q8 * mean_q8;
+        if (var_q16 < 0) var_q16 = 0;
+    }
+    uint32_t sigma_q8_u = Scale_Isqrt64((uint64_t)var_q16);
+    int32_t sigma_counts_q8 = (sigma_q8_u > INT32_MAX) ? INT32_MAX : (int32_t)sigma_q8_u;
+
+    // regresso linear simples (slope em counts por amostra, Q8)
+    int64_t num = SF_N * sf->sum_id - SF_SUM_X * sf->sum_d;
+    int32_t slope_counts_q8 = (int32_t)((num * 256) / (SF_N * SF_DEN_X));
+
+    // converses para mg/g (uma nica interpolao na curva)
+    int32_t avg_mg   = ADS1232_ConvertToMilligrams(avg_counts);
+    int32_t gpc_q24  = ADS1232_GetMgPerCount_Q24(avg_counts);
+    int32_t sigma_ug = counts_q8_to_ug(sigma_counts_q8, gpc_q24);
+    int32_t slope_ug = counts_q8_to_ug(slope_counts_q8, gpc_q24);
+
+    // estabilidade e deteco de degrau
+    uint8_t is_stable = (sigma_ug < sf->stability_sigma_ug) &&
+                        (abs(slope_ug) < sf->stability_slope_ug);
+
+    uint8_t step = 0;
+    if (sf->first_avg) {
+        sf->first_avg = 0;
+    } else if (abs(avg_mg - sf->prev_avg_mg) > sf->step_threshold_mg) {
+        step = 1;
     }
-    float sigma_counts = sqrtf((float)((double)sum_sq_diff / (double)SCALE_FILTER_WIN_SIZE));
+    sf->prev_avg_mg = avg_mg;
+
+    // sada
+    out->avg_counts      = avg_counts;
+    out->avg_mg          = avg_mg;
+    out->sigma_counts_q8 = sigma_counts_q8;
+    out->sigma_ug        = sigma_ug;
+    out->slope_counts_q8 = slope_counts_q8;
+    out->slope_ug        = slope_ug;
+    out->is_stable       = is_stable;
+    out->step_detected   = step;
+#else
+    // mdia (counts)
+    float mean_d     = (float)sf->sum_d / (float)SCALE_FILTER_WIN_SIZE;
+    float avg_counts = (float)sf->ref + mean_d;
+
+    // desvio padro (counts): E[d] - E[d], com |E[d]| < 1 aps o rebase
+    float var_counts = ((float)sf->sum_d2 / (float)SCALE_FILTER_WIN_SIZE) - (mean_d * mean_d);
+    float sigma_counts = (var_counts > 0.0f) ? sqrtf(var_counts) : 0.0f;
 
     // regresso linear simples (slope em counts por amostra)
-    long long sum_xy = 0, sum_x = 0, sum_y = 0, sum_x2 = 0;
-    for (int i = 0; i < SCALE_FILTER_WIN_SIZE; i++) {
-        sum_xy += (long long)i * sf->buffer[i];
-        sum_x  += i;
-        sum_y  += sf->buffer[i];
-        sum_x2 += (long long)i * i;
-    }
-    long long N = SCALE_FILTER_WIN_SIZE;
-    long long num = (N * sum_xy - sum_x * sum_y);
-    long long den = (N * sum_x2 - sum_x * sum_x);
-    float slope_counts = 0.0f;
-    if (den != 0) {
-        slope_counts = (float)((double)num / (double)den);
-    }
-
-    // converses para gramas
-    float gpc = local_g_per_count((int32_t)avg_counts);  // g/count
-    float avg_grams   = ADS1232_ConvertToGrams((int32_t)avg_counts);
+    int64_t num = SF_N * sf->sum_id - SF_SUM_X * sf->sum_d;
+    float slope_counts = (float)num / (float)(SF_N * SF_DEN_X);
+
+    // converses para gramas (uma nica interpolao na curva)
+    int32_t avg_i     = sf->ref + (int32_t)lrintf(mean_d);
+    float avg_grams   = ADS1232_ConvertToGrams(avg_i);
+    float gpc         = ADS1232_GetGramsPerCount(avg_i);  // g/count do segmento
     float sigma_grams = sigma_counts * gpc;
     float slope_grams = slope_counts * gpc;
 
@@ -114,4 +188,385 @@ void ScaleFilter_Push(ScaleFilter* sf, int32_t new_counts, ScaleFilterOut* out)
     out->slope_grams  = slope_grams;
     out->is_stable    = is_stable;
     out->step_detected= step;
+#endif
+}
+
+//==============================================================================
+// Estabilidade simples
+//==============================================================================
+
+void ScaleStability_Init(ScaleStability* st, float threshold_g, uint8_t target)
+{
+    memset(st, 0, sizeof(*st));
+#if SCALE_FIXED_POINT
+    st->threshold_mg = (int32_t)(threshold_g * 1000.0f + 0.5f);
+#else
+    st->threshold_g = threshold_g;
+#endif
+    st->target = target;
+}
+
+#if SCALE_FIXED_POINT
+uint8_t ScaleStability_Push(ScaleStability* st, int32_t new_mg)
+{
+    if (abs(new_mg - st->ref_mg) < st->threshold_mg) {
+#else
+uint8_t ScaleStability_Push(ScaleStability* st, float new_grams)
+{
+    if (fabsf(new_grams - st->ref_g) < st->threshold_g) {
+#endif
+        if (st->count < st->target) st->count++;
+        return (st->count >= st->target);
+    }
+    // fora da faixa: a leitura atual vira a nova referncia
+    st->count = 0;
+#if SCALE_FIXED_POINT
+    st->ref_mg = new_mg;
+#else
+    st->ref_g = new_grams;
+#endif
+    return 0;
+}
+
+//==============================================================================
+// Mediana deslizante incremental
+//==============================================================================
+
+void ScaleMedian_Init(ScaleMedian* m, uint8_t window)
+{
+    if (window < SF_MEDIAN_WIN_MIN) window = SF_MEDIAN_WIN_MIN;
+    if (window > SF_MEDIAN_WIN_MAX) window = SF_MEDIAN_WIN_MAX;
+    m->window = (uint8_t)(window | 1u);   // mpar: a mediana  sempre uma amostra real
+    m->count  = 0;
+    m->idx    = 0;
+}
+
+void ScaleMedian_Reset(ScaleMedian* m, int32_t counts)
+{
+    m->ring[0]   = counts;
+    m->sorted[0] = counts;
+    m->count     = 1;
+    m->idx       = 1;
+}
+
+// primeira posio de 'sorted' com valor >= v (busca binria)
+static uint8_t median_lower_bound(const int32_t* sorted, uint8_t n, int32_t v)
+{
+    uint8_t lo = 0, hi = n;
+    while (lo < hi) {
+        uint8_t mid = (uint8_t)((lo + hi) >> 1);
+        if (sorted[mid] < v) lo = (uint8_t)(mid + 1);
+        else hi = mid;
+    }
+    return lo;
+}
+
+int32_t ScaleMedian_Push(ScaleMedian* m, int32_t z)
+{
+    uint8_t i;
+
+    if (m->count < m->window) {
+        // janela enchendo: insero simples na posio ordenada
+        i = median_lower_bound(m->sorted, m->count, z);
+        for (uint8_t k = m->count; k > i; k--) {
+            m->sorted[k] = m->sorted[k - 1];
+        }
+        m->count++;
+    } else {
+        // janela cheia: o valor que sai abre uma lacuna que desliza at a posio do novo
+        int32_t velho = m->ring[m->idx];
+        i = median_lower_bound(m->sorted, m->count, velho);
+        if (z > velho) {
+            while (i + 1u < m->count && m->sorted[i + 1u] < z) { m->sorted[i] = m->sorted[i + 1u]; i++; }
+        } else {
+            while (i > 0 && m->sorted[i - 1u] > z) { m->sorted[i] = m->sorted[i - 1u]; i--; }
+        }
+    }
+    m->sorted[i] = z;
+
+    m->ring[m->idx] = z;
+    m->idx = (uint8_t)((m->idx + 1u) % m->window);
+    return m->sorted[m->count >> 1];
+}
+
+//==============================================================================
+// Cadeia de filtros configurvel
+//==============================================================================
+
+static int32_t chain_counts_to_mg(int32_t counts)
+{
+#if SCALE_FIXED_POINT
+    return ADS1232_ConvertToMilligrams(counts);
+#else
+    return (int32_t)lrintf(ADS1232_ConvertToGrams(counts) * 1000.0f);
+#endif
+}
+
+// diviso com arredondamento para o inteiro mais prximo (tambm para negativos)
+static int32_t div_round(int64_t num, int32_t den)
+{
+    return (int32_t)((num >= 0) ? (num + den / 2) / den : (num - den / 2) / den);
+}
+
+static uint8_t stage_cfg_valid(const ScaleFilterStageCfg* c)
+{
+    switch (c->type) {
+        case SF_STAGE_MOVING_AVG: return (c->window >= 2 && c->window <= SF_STAGE_WIN_MAX);
+        case SF_STAGE_MEDIAN:     return (c->window >= SF_MEDIAN_WIN_MIN && c->window <= SF_MEDIAN_WIN_MAX && (c->window & 1u));
+        case SF_STAGE_EMA:        return (c->param_a > 0);
+        case SF_STAGE_KALMAN:     return (c->param_b > 0);
+        default:                  return 0;
+    }
+}
+
+static void stage_flush(ScaleFilterStage* st, int32_t counts)
+{
+    if (st->cfg.type == SF_STAGE_MEDIAN) {
+        ScaleMedian_Reset(&st->u.median, counts);
+        return;
+    }
+
+    st->u.lin.buffer[0] = counts;
+    st->u.lin.idx   = (st->cfg.window > 1) ? 1 : 0;
+    st->u.lin.count = 1;
+    switch (st->cfg.type) {
+        case SF_STAGE_MOVING_AVG:
+            st->u.lin.acc = counts;
+            break;
+        case SF_STAGE_EMA:
+            st->u.lin.acc = (int64_t)counts << 16;
+            break;
+        case SF_STAGE_KALMAN:
+            // incerteza inicial = rudo de medida: as primeiras amostras pesam bastante
+            st->u.lin.acc   = (int64_t)counts << 16;
+            st->u.lin.p_q16 = (int64_t)st->cfg.param_b << 16;
+            break;
+        default:
+            break;
+    }
+}
+
+static int32_t stage_push(ScaleFilterStage* st, int32_t z)
+{
+    switch (st->cfg.type) {
+        case SF_STAGE_MOVING_AVG: {
+            if (st->u.lin.count == st->cfg.window) {
+                st->u.lin.acc -= st->u.lin.buffer[st->u.lin.idx];
+            } else {
+                st->u.lin.count++;
+            }
+            st->u.lin.buffer[st->u.lin.idx] = z;
+            st->u.lin.acc += z;
+            st->u.lin.idx = (uint8_t)((st->u.lin.idx + 1) % st->cfg.window);
+            return div_round(st->u.lin.acc, st->u.lin.count);
+        }
+
+        case SF_STAGE_MEDIAN:
+            return ScaleMedian_Push(&st->u.median, z);
+
+        case SF_STAGE_EMA: {
+            int64_t z_q16 = (int64_t)z << 16;
+            st->u.lin.acc += ((z_q16 - st->u.lin.acc) * st->cfg.param_a) >> 16;
+            return (int32_t)((st->u.lin.acc + 32768) >> 16);
+        }
+
+        case SF_STAGE_KALMAN: {
+            // modelo de peso constante: predio s aumenta a incerteza
+            int64_t r_q16 = (int64_t)st->cfg.param_b << 16;
+            st->u.lin.p_q16 += (int64_t)st->cfg.param_a << 8;
+            int64_t k_q16 = (st->u.lin.p_q16 << 16) / (st->u.lin.p_q16 + r_q16);
+            int64_t z_q16 = (int64_t)z << 16;
+            st->u.lin.acc   += ((z_q16 - st->u.lin.acc) * k_q16) >> 16;
+            st->u.lin.p_q16  = ((65536 - k_q16) * st->u.lin.p_q16) >> 16;
+            return (int32_t)((st->u.lin.acc + 32768) >> 16);
+        }
+
+        default:
+            return z;
+    }
+}
+
+void ScaleFilterChain_Init(ScaleFilterChain* ch, const ScaleFilterStageCfg* cfg, uint8_t n,
+                           int32_t step_threshold_mg)
+{
+    memset(ch, 0, sizeof(*ch));
+    ch->step_threshold_mg = step_threshold_mg;
+    for (uint8_t i = 0; i < n && ch->n_stages < SF_CHAIN_MAX_STAGES; i++) {
+        if (stage_cfg_valid(&cfg[i])) {
+            ScaleFilterStage* st = &ch->stages[ch->n_stages++];
+            st->cfg = cfg[i];
+            if (st->cfg.type == SF_STAGE_MEDIAN) {
+                ScaleMedian_Init(&st->u.median, st->cfg.window);
+            }
+        }
+    }
+}
+
+void ScaleFilterChain_Flush(ScaleFilterChain* ch, int32_t counts)
+{
+    for (uint8_t i = 0; i < ch->n_stages; i++) {
+        stage_flush(&ch->stages[i], counts);
+    }
+    ch->last_out    = counts;
+    ch->last_out_mg = chain_counts_to_mg(counts);
+    ch->step_count  = 0;
+    ch->primed      = 1;
+}
+
+int32_t ScaleFilterChain_Push(ScaleFilterChain* ch, int32_t new_counts, uint8_t* step_detected)
+{
+    uint8_t step = 0;
+
+    if (!ch->primed) {
+        ScaleFilterChain_Flush(ch, new_counts);
+        if (step_detected != NULL) *step_detected = 0;
+        return new_counts;
+    }
+
+    // fast-settle: um degrau confirmado descarta o histrico em vez de esperar a janela inteira
+    if (ch->step_threshold_mg > 0) {
+        if (abs(chain_counts_to_mg(new_counts) - ch->last_out_mg) > ch->step_threshold_mg) {
+            if (++ch->step_count >= SF_STEP_CONFIRM) {
+                ScaleFilterChain_Flush(ch, new_counts);
+                step = 1;
+            }
+        } else {
+            ch->step_count = 0;
+        }
+    }
+
+    if (!step) {
+        int32_t y = new_counts;
+        for (uint8_t i = 0; i < ch->n_stages; i++) {
+            y = stage_push(&ch->stages[i], y);
+        }
+        ch->last_out    = y;
+        ch->last_out_mg = chain_counts_to_mg(y);
+    }
+
+    if (step_detected != NULL) *step_detected = step;
+    return ch->last_out;
+}
+
+//==============================================================================
+// Previso do peso assentado (modelo de 2a ordem sobre as diferenas)
+//==============================================================================
+
+void ScaleSettle_Init(ScaleSettle* s, uint8_t window, int32_t bound_max_mg)
+{
+    if (window < SF_SETTLE_WIN_MIN) window = SF_SETTLE_WIN_MIN;
+    if (window > SF_SETTLE_WIN_MAX) window = SF_SETTLE_WIN_MAX;
+    s->window       = window;
+    s->bound_max_mg = bound_max_mg;
+    ScaleSettle_Reset(s);
+}
+
+void ScaleSettle_Reset(ScaleSettle* s)
+{
+    s->idx       = 0;
+    s->count     = 0;
+    s->n_preds   = 0;
+    s->a1_q16    = 0;
+    s->a2_q16    = 0;
+    s->pred_mg   = 0;
+    s->bound_mg  = INT32_MAX;
+    s->converged = 0;
+}
+
+static void settle_invalidate(ScaleSettle* s)
+{
+    s->n_preds   = 0;
+    s->bound_mg  = INT32_MAX;
+    s->converged = 0;
+}
+
+uint8_t ScaleSettle_Push(ScaleSettle* s, int32_t new_mg)
+{
+    s->ring[s->idx] = new_mg;
+    s->idx = (uint8_t)((s->idx + 1) % s->window);
+    if (s->count < s->window) s->count++;
+    // Ajusta a partir de SF_SETTLE_WIN_MIN amostras; a janela cresce at 'window'
+    if (s->count < SF_SETTLE_WIN_MIN) {
+        return 0;
+    }
+
+    // Diferenas em ordem cronolgica (a mais antiga em d[0])
+    int32_t d[SF_SETTLE_WIN_MAX - 1];
+    uint8_t nd = (uint8_t)(s->count - 1);
+    uint8_t ini = (uint8_t)((s->idx + s->window - s->count) % s->window);
+    int32_t prev = s->ring[ini];
+    for (uint8_t i = 0; i < nd; i++) {
+        int32_t y = s->ring[(ini + 1 + i) % s->window];
+        d[i] = y - prev;
+        prev = y;
+    }
+    int32_t d1 = d[nd - 1];   // ltimo passo
+    int32_t d2 = d[nd - 2];
+
+    // Mnimos quadrados de d[k] sobre (d[k-1], d[k-2])
+    int64_t suu = 0, svv = 0, suv = 0, seu = 0, sev = 0, see = 0;
+    for (uint8_t k = 2; k < nd; k++) {
+        int64_t e = d[k], u = d[k - 1], v = d[k - 2];
+        suu += u * u; svv += v * v; suv += u * v;
+        seu += e * u; sev += e * v; see += e * e;
+    }
+    uint8_t n = (uint8_t)(nd - 2);
+
+    int32_t tail;
+    int64_t res_var;   // varincia do resduo (mg)
+    int32_t ruido = s->bound_max_mg / 4;
+
+    if (suu <= (int64_t)n * ruido * ruido) {
+        // J plano: as diferenas so s rudo, nada a extrapolar
+        tail = 0;
+        res_var = see / n;
+        s->a1_q16 = 0;
+        s->a2_q16 = 0;
+    } else {
+        // Mantm os produtos abaixo de 2^62
+        uint8_t sh = 0;
+        while ((suu >> sh) > (1LL << 30) || (svv >> sh) > (1LL << 30)) sh++;
+        int64_t uu = suu >> sh, vv = svv >> sh, uv = suv >> sh, eu = seu >> sh, ev = sev >> sh;
+        int64_t det = uu * vv - uv * uv;
+        if ((det >> 16) == 0) { settle_invalidate(s); return 0; }
+
+        int64_t a1 = (eu * vv - ev * uv) / (det >> 16);
+        int64_t a2 = (uu * ev - uv * eu) / (det >> 16);
+        int64_t margem = 65536 - a1 - a2;
+        // Estvel: |a2| < 1 e a2 - a1 < 1, com folga no polo em 1
+        if (margem < SF_SETTLE_MARGIN_Q16 || a2 >= 65536 || a2 <= -65536 || (a2 - a1) >= 65536) {
+            settle_invalidate(s);
+            return 0;
+        }
+        s->a1_q16 = (int32_t)a1;
+        s->a2_q16 = (int32_t)a2;
+
+        // Soma das diferenas futuras: ((a1 + a2) * d1 + a2 * d2) / (1 - a1 - a2)
+        tail = (int32_t)(((a1 + a2) * d1 + a2 * d2) / margem);
+        res_var = (see - ((a1 * seu + a2 * sev) >> 16)) / n;
+        if (res_var < 0) res_var = 0;
+    }
+
+    int32_t pred = new_mg + tail;
+    for (uint8_t i = SF_SETTLE_CONFIRM - 1; i > 0; i--) s->preds[i] = s->preds[i - 1];
+    s->preds[0] = pred;
+    if (s->n_preds < SF_SETTLE_CONFIRM) s->n_preds++;
+    s->pred_mg = pred;
+
+    if (s->n_preds < SF_SETTLE_CONFIRM) {
+        s->bound_mg = INT32_MAX;
+        s->converged = 0;
+        return 0;
+    }
+
+    // Incerteza: disperso das ltimas previses + desvio do resduo
+    // + parte da cauda ainda extrapolada (erro de modelo)
+    int32_t mn = s->preds[0], mx = s->preds[0];
+    for (uint8_t i = 1; i < SF_SETTLE_CONFIRM; i++) {
+        if (s->preds[i] < mn) mn = s->preds[i];
+        if (s->preds[i] > mx) mx = s->preds[i];
+    }
+    s->bound_mg  = (mx - mn) + (int32_t)Scale_Isqrt64((uint64_t)res_var) + abs(tail) / SF_SETTLE_TAIL_DIV;
+    s->converged = (s->bound_mg <= s->bound_max_mg);
+    return s->converged;
 }
@@ -1,14 +1,33 @@
 /*******************************************************************************
  * @file        servo_controle.c
  * @brief       Mdulo de alto nvel para controle da sequncia de servos.
- * @version     2.1 (Corrigido para usar TIM16 e TIM17)
+ * @version     3.2 (Sequncia da configurao rodada pelo ciclo de medio)
+ * @details     Cada mudana de posio vira um movimento com a durao
+ * configurada (Gerenciador_Config_Get_Servo_Rampa_ms), executado pelo DMA
+ * no pwm_servo_driver. O canal de DMA  nico: se os dois servos mudarem
+ * juntos, o funil vai primeiro e o raspador comea quando ele terminar.
+ *
+ * A sequncia  uma lista de passos da configurao (Config_Passo_Servo_t):
+ * cada passo leva um servo a um ngulo e segue por tempo, pelo fim do
+ * movimento ou por uma condio de quem a iniciou (o ciclo_medicao: dosagem,
+ * queda, peso estvel, medio), sempre com limite de tempo. O ciclo avana
+ * a sequncia (Servos_Sequence_Process) e recebe cada passo que termina.
+ * A troca de passo e o fim so avisados ao handler registrado
+ * (EV_SERVOS_SEQUENCE_*). Os tempos vm do HAL_GetTick(): sem gancho de 1 ms.
+ *
+ * Os ngulos viram pulsos (us) uma vez: o repouso no Init e os passos na
+ * partida da sequncia. O Servos_Process() s compara inteiros e chama o
+ * driver quando o pulso pedido muda.
  ******************************************************************************/
 
 #include "servo_controle.h"
 #include "pwm_servo_driver.h"
+#include "gerenciador_configuracoes.h"
 #include "app_eventos.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
+#include <string.h>
 
 //================================================================================
 // Definies da Mquina de Estados
@@ -16,24 +35,19 @@
 
 #define ESTADO_OCIOSO 0xFF
 
-typedef void (*Funcao_Acao_t)(void);
-
 typedef struct
 {
-    ServoStep_t id_passo;
-    Funcao_Acao_t acao;
-    uint32_t duracao_ms;
-    uint8_t indice_proximo_estado;
+    Config_Passo_Servo_t cfg;
+    ServoStep_t id_passo;       // Servo exposto nos eventos (passos de espera herdam)
+    uint16_t pulso_us;          // cfg.angulo j convertido para o servo do passo
 } Passo_Processo_t;
 
 //================================================================================
 // Variveis de Estado do Mdulo
 //================================================================================
 
-static volatile uint32_t s_timer_funil = 0;
-static volatile uint32_t s_timer_scrap = 0;
-static volatile uint8_t s_indice_estado_atual = ESTADO_OCIOSO;
-static volatile uint32_t s_timer_estado_ms = 0;
+static uint8_t s_indice_estado_atual = ESTADO_OCIOSO;
+static uint32_t s_inicio_passo_ms = 0;
 
 // --- CORRIGIDO: Configurao dos Servos para TIM16 e TIM17 ---
 // O linker procura estas variveis, que so definidas em tim.c
@@ -44,99 +58,234 @@ extern TIM_HandleTypeDef htim17;
 static Servo_t s_servo_funil   = {.htim = &htim17, .channel = TIM_CHANNEL_1, .min_pulse_us = 700, .max_pulse_us = 2300};
 static Servo_t s_servo_scrap   = {.htim = &htim16, .channel = TIM_CHANNEL_1, .min_pulse_us = 650, .max_pulse_us = 2400};
 
+// Pulso do repouso (Servos_Init). O ltimo destino entregue ao driver fica em
+// Servo_t.pulse_us: um movimento s  disparado na mudana
+static uint16_t s_pulso_fechado_funil;
+static uint16_t s_pulso_fechado_scrap;
 
-#define ANGULO_FECHADO      0.0f
-#define ANGULO_FUNIL_ABRE   75.0f
-#define ANGULO_SCRAP_ABRE   90.0f
-
-static void Acao_Abrir_Funil(void);
-static void Acao_Varrer_Scrap(void);
-static void Acao_Finalizar(void);
-
-static const Passo_Processo_t s_fluxo_processo[] =
-{
-    { SERVO_STEP_FUNNEL,   Acao_Abrir_Funil,  2000, 1 },
-    { SERVO_STEP_FUNNEL,   NULL,              500,  2 },
-    { SERVO_STEP_SCRAPER,  Acao_Varrer_Scrap, 2000, 3 },
-    { SERVO_STEP_SCRAPER,  NULL,              500,  4 },
-    { SERVO_STEP_FINISHED, Acao_Finalizar,    1,    ESTADO_OCIOSO },
-};
-#define NUM_PASSOS_PROCESSO (sizeof(s_fluxo_processo) / sizeof(s_fluxo_processo[0]))
+// Sequncia carregada na partida (cpia: a configurao pode mudar no meio)
+static Passo_Processo_t s_fluxo_processo[MAX_PASSOS_SEQUENCIA];
+static uint8_t s_num_passos = 0;
+static uint16_t s_pulso_seq_funil = 0;   // Posio pedida pela sequncia
+static uint16_t s_pulso_seq_scrap = 0;
+static uint8_t s_limites_esgotados = 0;
+static uint32_t s_execucoes = 0;
+static Funcao_Condicao_Seq_t s_condicao = NULL;
+static Funcao_Handler_Evento_t s_handler_evento = NULL;
 
 static void Entrar_No_Estado(uint8_t indice_estado);
+static void Encerrar_Sequencia(void);
 
 //================================================================================
-// Implementao
+// Funes Privadas
 //================================================================================
 
-void Servos_Tick_ms(void)
+static void Notificar(Tipo_Evento_t tipo, uint8_t indice, ServoStep_t passo)
+{
+    if (s_handler_evento == NULL) return;
+
+    ServoSeqPayload_t payload = {
+        .indice = indice,
+        .total = s_num_passos,
+        .passo = passo,
+        .limites_esgotados = s_limites_esgotados,
+    };
+    Evento_t evento = { .type = tipo, .payload = &payload };
+    s_handler_evento(evento);
+}
+
+/**
+ * @brief Copia a tabela da configurao (j validada pelo gerenciador) e
+ * converte os ngulos. Passos de espera herdam o servo do passo anterior
+ * (ou do primeiro servo da tabela, no comeo) para os eventos.
+ */
+static void Carregar_Sequencia(void)
+{
+    Config_Passo_Servo_t passos[MAX_PASSOS_SEQUENCIA];
+    uint8_t n = Gerenciador_Config_Get_Sequencia_Servos(passos, MAX_PASSOS_SEQUENCIA);
+
+    ServoStep_t atual = SERVO_STEP_IDLE;
+    for (uint8_t i = 0; i < n && atual == SERVO_STEP_IDLE; i++)
+    {
+        if (passos[i].servo == SERVO_SEQ_FUNIL) atual = SERVO_STEP_FUNNEL;
+        else if (passos[i].servo == SERVO_SEQ_RASPADOR) atual = SERVO_STEP_SCRAPER;
+    }
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        uint16_t pulso = 0;
+        if (passos[i].servo == SERVO_SEQ_FUNIL)
+        {
+            atual = SERVO_STEP_FUNNEL;
+            pulso = PWM_Servo_Angle_To_Pulse(&s_servo_funil, passos[i].angulo);
+        }
+        else if (passos[i].servo == SERVO_SEQ_RASPADOR)
+        {
+            atual = SERVO_STEP_SCRAPER;
+            pulso = PWM_Servo_Angle_To_Pulse(&s_servo_scrap, passos[i].angulo);
+        }
+        s_fluxo_processo[i].cfg = passos[i];
+        s_fluxo_processo[i].id_passo = atual;
+        s_fluxo_processo[i].pulso_us = pulso;
+    }
+    s_num_passos = n;
+}
+
+/**
+ * @brief Condio de sada do passo atual (sem o limite de tempo).
+ */
+static bool Condicao_Atendida(const Config_Passo_Servo_t* cfg, uint32_t decorrido)
 {
-    if (s_timer_estado_ms > 0) s_timer_estado_ms--;
-    if (s_timer_funil > 0) s_timer_funil--;
-    if (s_timer_scrap > 0) s_timer_scrap--;
+    switch (cfg->espera)
+    {
+        case SERVO_SEQ_TEMPO:
+            return decorrido >= cfg->duracao_ms;
+        case SERVO_SEQ_MOVIMENTO:
+            return !Servos_Em_Movimento();
+        case SERVO_SEQ_PESO_ESTAVEL:
+            if (Servos_Em_Movimento()) return false; // A balana s conta depois que o servo para
+            /* fallthrough */
+        default:
+            if (decorrido < cfg->minimo_ms || s_condicao == NULL) return false;
+            return s_condicao((Servo_Seq_Espera_t)cfg->espera);
+    }
 }
 
+//================================================================================
+// Implementao
+//================================================================================
+
 void Servos_Init(void)
 {
-    PWM_Servo_Init(&s_servo_scrap);
-    PWM_Servo_Init(&s_servo_funil);
+    HAL_StatusTypeDef st_scrap = PWM_Servo_Init(&s_servo_scrap);
+    HAL_StatusTypeDef st_funil = PWM_Servo_Init(&s_servo_funil);
+    if (st_scrap != HAL_OK || st_funil != HAL_OK) {
+        printf("SERVO: TIM16/TIM17 fora da base de 1 us / 20 ms (ver .ioc)\r\n");
+    }
+
+    s_pulso_fechado_funil = PWM_Servo_Angle_To_Pulse(&s_servo_funil, SERVO_ANGULO_FECHADO);
+    s_pulso_fechado_scrap = PWM_Servo_Angle_To_Pulse(&s_servo_scrap, SERVO_ANGULO_FECHADO);
+    s_pulso_seq_funil = s_pulso_fechado_funil;
+    s_pulso_seq_scrap = s_pulso_fechado_scrap;
+
+    // Posio de partida conhecida: as rampas seguintes comeam daqui
+    PWM_Servo_SetPulse(&s_servo_funil, s_pulso_fechado_funil);
+    PWM_Servo_SetPulse(&s_servo_scrap, s_pulso_fechado_scrap);
     s_indice_estado_atual = ESTADO_OCIOSO;
 }
 
 void Servos_Process(void)
 {
-    uint32_t timer_snapshot;
+    // PWM_Servo_Move_Pulse() recusa enquanto o DMA serve o outro servo (pulse_us
+    // no muda): tenta de novo no prximo loop
+    if (s_pulso_seq_funil != s_servo_funil.pulse_us)
+    {
+        PWM_Servo_Move_Pulse(&s_servo_funil, s_pulso_seq_funil, Gerenciador_Config_Get_Servo_Rampa_ms());
+    }
+    if (s_pulso_seq_scrap != s_servo_scrap.pulse_us)
+    {
+        PWM_Servo_Move_Pulse(&s_servo_scrap, s_pulso_seq_scrap, Gerenciador_Config_Get_Servo_Rampa_ms());
+    }
+}
+
+bool Servos_Pendente(void)
+{
+    return (s_servo_funil.pulse_us != s_pulso_seq_funil) || (s_servo_scrap.pulse_us != s_pulso_seq_scrap);
+}
 
-    __disable_irq();
-    timer_snapshot = s_timer_estado_ms;
-    __enable_irq();
+bool Servos_Em_Movimento(void)
+{
+    return Servos_Pendente() || PWM_Servo_Is_Moving();
+}
 
-    if (s_indice_estado_atual != ESTADO_OCIOSO && timer_snapshot == 0)
+bool Servos_Start_Sequence(Funcao_Condicao_Seq_t condicao)
+{
+    if (s_indice_estado_atual != ESTADO_OCIOSO)
     {
-        uint8_t proximo_indice = s_fluxo_processo[s_indice_estado_atual].indice_proximo_estado;
-        Entrar_No_Estado(proximo_indice);
+        return false;
     }
-
-    PWM_Servo_SetAngle(&s_servo_funil, (s_timer_funil > 0) ? ANGULO_FUNIL_ABRE : ANGULO_FECHADO);
-    PWM_Servo_SetAngle(&s_servo_scrap, (s_timer_scrap > 0) ? ANGULO_SCRAP_ABRE : ANGULO_FECHADO);
+    Carregar_Sequencia();
+    s_condicao = condicao;
+    s_limites_esgotados = 0;
+    Entrar_No_Estado(0);
+    return true;
 }
 
-void Servos_Start_Sequence(void)
+bool Servos_Sequence_Process(Servo_Seq_Transicao_t* transicao)
 {
-    if (s_indice_estado_atual == ESTADO_OCIOSO)
+    uint8_t indice = s_indice_estado_atual;
+    if (indice == ESTADO_OCIOSO) return false;
+
+    const Config_Passo_Servo_t* cfg = &s_fluxo_processo[indice].cfg;
+    uint32_t decorrido = HAL_GetTick() - s_inicio_passo_ms;
+    bool por_limite = false;
+
+    if (!Condicao_Atendida(cfg, decorrido))
     {
-        Entrar_No_Estado(0);
+        if (cfg->espera == SERVO_SEQ_TEMPO || cfg->duracao_ms == 0 || decorrido < cfg->duracao_ms)
+        {
+            return false;
+        }
+        por_limite = true;
+        if (s_limites_esgotados < UINT8_MAX) s_limites_esgotados++;
+        printf("SERVOS: passo %u encerrado pelo limite de %u ms\r\n",
+               (unsigned)(indice + 1), (unsigned)cfg->duracao_ms);
     }
+
+    if (transicao != NULL)
+    {
+        transicao->espera = (Servo_Seq_Espera_t)cfg->espera;
+        transicao->por_limite = por_limite;
+        transicao->fim = (indice + 1u >= s_num_passos);
+    }
+    Entrar_No_Estado(indice + 1);
+    return true;
+}
+
+void Servos_Registrar_Handler_Evento(Funcao_Handler_Evento_t handler)
+{
+    s_handler_evento = handler;
+}
+
+void Servos_Get_Status_Sequencia(Servo_Seq_Status_t* status)
+{
+    if (status == NULL) return;
+    uint8_t indice = s_indice_estado_atual;
+    status->ativa = (indice != ESTADO_OCIOSO);
+    status->indice = status->ativa ? indice : 0;
+    status->total = s_num_passos;
+    status->servo = status->ativa ? (Servo_Seq_Alvo_t)s_fluxo_processo[indice].cfg.servo : SERVO_SEQ_NENHUM;
+    status->espera = status->ativa ? (Servo_Seq_Espera_t)s_fluxo_processo[indice].cfg.espera : SERVO_SEQ_TEMPO;
+    status->limites_esgotados = s_limites_esgotados;
+    status->execucoes = s_execucoes;
 }
 
 static void Entrar_No_Estado(uint8_t indice_estado)
 {
-    if (indice_estado >= NUM_PASSOS_PROCESSO)
+    if (indice_estado >= s_num_passos)
     {
-        s_indice_estado_atual = ESTADO_OCIOSO;
+        s_execucoes++;
+        Encerrar_Sequencia();
         return;
     }
 
     s_indice_estado_atual = indice_estado;
     const Passo_Processo_t* passo = &s_fluxo_processo[indice_estado];
 
-    // Aqui, futuramente, chamaremos uma funo do app_manager para notificar a UI
-    // Ex: App_Manager_On_Servo_Step_Changed(passo->id_passo);
-
-    if (passo->acao != NULL)
-    {
-        passo->acao();
-    }
+    if (passo->cfg.servo == SERVO_SEQ_FUNIL) s_pulso_seq_funil = passo->pulso_us;
+    else if (passo->cfg.servo == SERVO_SEQ_RASPADOR) s_pulso_seq_scrap = passo->pulso_us;
 
-    s_timer_estado_ms = passo->duracao_ms;
+    s_inicio_passo_ms = HAL_GetTick();
 
-    if (passo->id_passo == SERVO_STEP_FINISHED)
-    {
-       // Aqui, futuramente, chamaremos uma funo do app_manager para notificar o fim
-       // Ex: App_Manager_On_Servo_Sequence_Finished();
-    }
+    Notificar(EV_SERVOS_SEQUENCE_STEP_CHANGED, indice_estado, passo->id_passo);
 }
 
-static void Acao_Abrir_Funil(void) { s_timer_funil = 2000; }
-static void Acao_Varrer_Scrap(void) { s_timer_scrap = 2000; }
-static void Acao_Finalizar(void) {}
\ No newline at end of file
+static void Encerrar_Sequencia(void)
+{
+    // Uma tabela que termine com algo aberto no deixa o servo parado aberto
+    s_indice_estado_atual = ESTADO_OCIOSO;
+    s_pulso_seq_funil = s_pulso_fechado_funil;
+    s_pulso_seq_scrap = s_pulso_fechado_scrap;
+
+    Notificar(EV_SERVOS_SEQUENCE_FINISHED, s_num_passos, SERVO_STEP_FINISHED);
+}
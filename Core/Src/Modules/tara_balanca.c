@@ -0,0 +1,189 @@
+/*******************************************************************************
+ * @file        tara_balanca.c
+ * @brief       Tara assncrona e rastreamento de auto-zero da balana.
+ * @version     1.0
+ * @details     Substitui o ADS1232_Tare() bloqueante (at 10 x 32 x (3 leituras +
+ * 10 ms) no boot). As amostras chegam pelo mesmo fluxo de Task_Handle_Scale:
+ * 1. TARA: blocos de TARA_AMOSTRAS leituras; se o espalhamento do bloco for
+ *    menor que o limiar, a mdia vira o novo offset. Seno, nova tentativa.
+ * 2. AUTO-ZERO: com o prato vazio (|peso| dentro da janela) e estvel, a mdia
+ *    de um bloco puxa o offset lentamente (passo limitado) para seguir a deriva
+ *    de zero. A correo total  limitada para no "tarar" uma amostra real.
+ ******************************************************************************/
+
+#include "tara_balanca.h"
+#include "ads1232_driver.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//================================================================================
+// Definies
+//================================================================================
+
+// --- Tara (mesmos critrios do antigo ADS1232_Tare) ---
+#define TARA_DESCARTE             4      // Leituras ignoradas logo aps o pedido
+#define TARA_AMOSTRAS             32
+#define TARA_LIMIAR_ESTABILIDADE  300    // Mx-mn aceitvel no bloco (counts)
+#define TARA_MAX_TENTATIVAS       10
+
+// --- Auto-zero ---
+#define AZ_JANELA_MG              500    // S rastreia com |peso| <= 0.5 g
+#define AZ_AMOSTRAS               16     // Bloco promediado por correo
+#define AZ_FRACAO_SHIFT           2      // Aplica 1/4 do erro por bloco (seguimento lento)
+#define AZ_PASSO_MAX_COUNTS       32     // Limite por correo (~5 mg)
+#define AZ_LIMITE_TOTAL_COUNTS    12400  // Correo mxima desde a ltima tara (~2 g)
+
+//================================================================================
+// Variveis Estticas
+//================================================================================
+
+static Tara_Status_t s_status;
+
+static struct {
+    uint8_t descartar;
+    uint8_t contagem;
+    int64_t soma;
+    int32_t minimo;
+    int32_t maximo;
+} s_tara;
+
+static struct {
+    uint8_t contagem;
+    int64_t soma;
+} s_az;
+
+//================================================================================
+// Funes Privadas
+//================================================================================
+
+static void Reiniciar_Bloco_Tara(void)
+{
+    s_tara.contagem = 0;
+    s_tara.soma = 0;
+    s_tara.minimo = INT32_MAX;
+    s_tara.maximo = INT32_MIN;
+    s_status.progresso_pct = 0;
+}
+
+static void Processar_Tara(int32_t raw)
+{
+    if (s_tara.descartar > 0) {
+        s_tara.descartar--;
+        return;
+    }
+
+    s_tara.soma += raw;
+    if (raw < s_tara.minimo) s_tara.minimo = raw;
+    if (raw > s_tara.maximo) s_tara.maximo = raw;
+    s_tara.contagem++;
+    s_status.progresso_pct = (uint8_t)((s_tara.contagem * 100u) / TARA_AMOSTRAS);
+
+    if (s_tara.contagem < TARA_AMOSTRAS) return;
+
+    int32_t espalhamento = s_tara.maximo - s_tara.minimo;
+    if (espalhamento < TARA_LIMIAR_ESTABILIDADE) {
+        ADS1232_SetOffset((int32_t)(s_tara.soma / TARA_AMOSTRAS));
+        s_status.offset = ADS1232_GetOffset();
+        s_status.auto_zero_correcao = 0; // Nova referncia para o limite do auto-zero
+        s_status.estado = TARA_CONCLUIDA;
+        s_az.contagem = 0;
+        s_az.soma = 0;
+        printf("Tara estavel concluida! Offset = %ld\r\n", (long)s_status.offset);
+        return;
+    }
+
+    if (s_status.tentativa >= TARA_MAX_TENTATIVAS) {
+        s_status.estado = TARA_FALHOU;
+        printf("AVISO: Balanca nao estabilizou. Offset anterior mantido.\r\n");
+        return;
+    }
+    s_status.tentativa++;
+    printf("Leituras instaveis (diff: %ld). Tentativa %u...\r\n", (long)espalhamento, (unsigned)s_status.tentativa);
+    Reiniciar_Bloco_Tara();
+}
+
+static void Processar_Auto_Zero(int32_t raw, int32_t peso_mg, bool estavel)
+{
+    if (!s_status.auto_zero_ativo || !estavel || abs(peso_mg) > AZ_JANELA_MG) {
+        s_az.contagem = 0; // Qualquer carga/movimento recomea o bloco
+        s_az.soma = 0;
+        return;
+    }
+
+    s_az.soma += raw;
+    s_az.contagem++;
+    if (s_az.contagem < AZ_AMOSTRAS) return;
+
+    int32_t media = (int32_t)(s_az.soma / AZ_AMOSTRAS);
+    s_az.contagem = 0;
+    s_az.soma = 0;
+
+    int32_t passo = (media - ADS1232_GetOffset()) >> AZ_FRACAO_SHIFT;
+    if (passo > AZ_PASSO_MAX_COUNTS) passo = AZ_PASSO_MAX_COUNTS;
+    if (passo < -AZ_PASSO_MAX_COUNTS) passo = -AZ_PASSO_MAX_COUNTS;
+    if (passo == 0) return;
+
+    int32_t nova_correcao = s_status.auto_zero_correcao + passo;
+    if (abs(nova_correcao) > AZ_LIMITE_TOTAL_COUNTS) {
+        return; // Deriva grande demais para ser "zero": exige uma tara explcita
+    }
+
+    s_status.auto_zero_correcao = nova_correcao;
+    s_status.auto_zero_ajustes++;
+    ADS1232_SetOffset(ADS1232_GetOffset() + passo);
+    s_status.offset = ADS1232_GetOffset();
+}
+
+//================================================================================
+// Funes Pblicas
+//================================================================================
+
+void Tara_Balanca_Init(void)
+{
+    memset(&s_status, 0, sizeof(s_status));
+    memset(&s_az, 0, sizeof(s_az));
+    s_status.estado = TARA_OCIOSA;
+    s_status.auto_zero_ativo = true;
+    s_status.offset = ADS1232_GetOffset();
+}
+
+void Tara_Balanca_Solicitar(void)
+{
+    printf("Tarando... Aguarde estabilidade.\r\n");
+    s_tara.descartar = TARA_DESCARTE;
+    s_status.tentativa = 1;
+    Reiniciar_Bloco_Tara();
+    s_status.estado = TARA_COLETANDO;
+}
+
+/**
+ * @brief (Superloop) Chamada por Task_Handle_Scale para cada leitura nova.
+ */
+void Tara_Balanca_Nova_Amostra(int32_t raw, int32_t peso_mg, bool estavel)
+{
+    if (s_status.estado == TARA_COLETANDO) {
+        Processar_Tara(raw);
+    } else {
+        Processar_Auto_Zero(raw, peso_mg, estavel);
+    }
+}
+
+bool Tara_Balanca_Em_Andamento(void)
+{
+    return s_status.estado == TARA_COLETANDO;
+}
+
+void Tara_Balanca_Set_Auto_Zero(bool ativo)
+{
+    s_status.auto_zero_ativo = ativo;
+    s_az.contagem = 0;
+    s_az.soma = 0;
+}
+
+void Tara_Balanca_Get_Status(Tara_Status_t* status)
+{
+    if (status != NULL) {
+        *status = s_status;
+    }
+}
@@ -108,6 +108,7 @@ int main(void)
   MX_USB_PCD_Init();
   MX_TIM2_Init();
   MX_TIM14_Init();
+  MX_TIM3_Init();
   /* USER CODE BEGIN 2 */
 	Retarget_Init(&huart1, &huart2); 
 	App_Manager_Init();
@@ -23,6 +23,8 @@
 #include "dwin_driver.h"
 #include "cli_driver.h"
 #include "servo_controle.h"
+#include "pwm_servo_driver.h"
+#include "agendador.h"
 #include "ads1232_driver.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
@@ -59,9 +61,9 @@
 /* USER CODE END 0 */
 
 /* External variables --------------------------------------------------------*/
+extern TIM_HandleTypeDef htim3;
 extern TIM_HandleTypeDef htim14;
 extern DMA_HandleTypeDef hdma_usart1_tx;
-extern DMA_HandleTypeDef hdma_usart1_rx;
 extern DMA_HandleTypeDef hdma_usart2_rx;
 extern DMA_HandleTypeDef hdma_usart2_tx;
 extern UART_HandleTypeDef huart1;
@@ -168,9 +170,8 @@ void DMA1_Channel1_IRQHandler(void)
 void DMA1_Channel2_3_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Channel2_3_IRQn 0 */
-
+  PWM_Servo_DMA_IRQHandler(); // Canal 2: rampas dos servos (TIM16/17_UP)
   /* USER CODE END DMA1_Channel2_3_IRQn 0 */
-  HAL_DMA_IRQHandler(&hdma_usart1_rx);
   HAL_DMA_IRQHandler(&hdma_usart2_rx);
   /* USER CODE BEGIN DMA1_Channel2_3_IRQn 1 */
 
@@ -191,6 +192,20 @@ void DMAMUX1_DMA1_CH4_5_IRQHandler(void)
   /* USER CODE END DMAMUX1_DMA1_CH4_5_IRQn 1 */
 }
 
+/**
+  * @brief This function handles TIM3 global interrupt.
+  */
+void TIM3_IRQHandler(void)
+{
+  /* USER CODE BEGIN TIM3_IRQn 0 */
+
+  /* USER CODE END TIM3_IRQn 0 */
+  HAL_TIM_IRQHandler(&htim3);
+  /* USER CODE BEGIN TIM3_IRQn 1 */
+
+  /* USER CODE END TIM3_IRQn 1 */
+}
+
 /**
   * @brief This function handles TIM14 global interrupt.
   */
@@ -253,9 +268,15 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 
     // Esta  a nossa substituio de 1ms para a tarefa do superloop.
     // Agora ela roda em alta prioridade de hardware, de forma determinstica.
-    Servos_Tick_ms(); 
+    // Base do Agendador_Micros() e do HAL_GetTick(); chama os ganchos de 1 ms
+    // (Eventos_Tick_1ms) uma vez por ms, inclusive os dormidos.
+    Agendador_TIM14_Update();
 
   }
+  else if (htim->Instance == TIM3) {
+    // Meia-borda de SCLK do motor de aquisio do ADS1232.
+    Drv_ADS1232_SCLK_Callback();
+  }
 }
 
 void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
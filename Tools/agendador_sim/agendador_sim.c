@@ -0,0 +1,297 @@
+/*******************************************************************************
+ * @file        agendador_sim.c
+ * @brief       Simulao no PC (Linux) do agendador com sono sem tick.
+ * @version     1.0
+ * @details     Roda o agendador.c do firmware sobre um TIM14 simulado em 1 us
+ * (CNT, ARR e UIF; ARPE = 0: o ARR escrito vale j para o perodo em curso e,
+ * se ficar abaixo do CNT, o contador vai at 0xFFFF e volta antes do update),
+ * com PRIMASK, __WFI() (1 us de latncia no despertar) e uma IRQ externa em
+ * instantes aleatrios (amostra da balana). As tarefas s consomem tempo
+ * simulado.
+ *
+ * Tarefas (cenrio 1, a carga do app_manager):
+ * - "balanca": condicional de 1 ms, ativa com amostra pendente (300 us);
+ * - "servos":  condicional de 1 ms, ativa por 20 ms depois de cada amostra,
+ *              como um movimento dos servos (60 us);
+ * - "freq":    peridica de 5 ms (40 us);
+ * - "eventos": por evento, sinalizada pela IRQ (20 us);
+ * - "display": peridica de 1 s (2,5 ms).
+ * O cenrio 2 tira "freq" e "display": sonos longos, s IRQs e "servos".
+ * O cenrio 3  o 1 com as IRQs nos ltimos 15 us de um ms (dentro da
+ * margem do ARR) e 3 amostras por IRQ, drenadas uma por execuo: a
+ * "balanca" segue ativa e tem prazo antes da fronteira seguinte.
+ *
+ * Verificaes (qualquer falha faz o programa sair com 1):
+ * - Agendador_Micros() igual ao tempo simulado dentro das tarefas;
+ * - uwTick e ganchos de 1 ms: um por ms, inclusive os dormidos;
+ * - ARR escrito abaixo do CNT (o update s viria aps o estouro em 0xFFFF);
+ * - peridicas atrasadas alm do perodo mais ATRASO_TOLERADO_US (um
+ *   despertar perdido atrasa dezenas de ms).
+ *
+ * Compilao (a partir da raiz do repositrio):
+ *   gcc -O2 -std=gnu11 -ITools/agendador_sim/inc -ICore/Inc/Application \
+ *       Tools/agendador_sim/agendador_sim.c Core/Src/Application/agendador.c \
+ *       -o agendador_sim
+ *   (o inc/main.h daqui substitui o Core/Inc/main.h: TIM14, PRIMASK e __WFI())
+ *
+ * Uso:
+ *   ./agendador_sim [-c 1|2|3] [-s semente] [-t segundos]
+ ******************************************************************************/
+
+#include "agendador.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//================================================================================
+// Definies
+//================================================================================
+
+#define TIM14_CONTAGEM      0x10000ull  // Contador de 16 bits
+#define LATENCIA_WFI_US     1u
+#define IRQ_MIN_US          2000u       // Intervalo entre amostras (aleatrio)
+#define IRQ_FAIXA_US        97000u
+#define IRQ_FIM_DE_MS_US    985u        // Cenrio 3: IRQ a 15 us ou menos da fronteira
+#define SERVOS_ATIVO_US     20000u
+#define ATRASO_TOLERADO_US  3600u       // Maior tarefa ("display", 2,5 ms) + 1,1 ms
+
+//================================================================================
+// TIM14, PRIMASK e IRQs simulados
+//================================================================================
+
+Sim_TIM_t sim_tim14 = { 0, 999, 0 };
+
+static uint64_t s_t = 0;                // Tempo simulado (us)
+static uint64_t s_zero_cnt = 0;         // Instante em que o CNT passou por 0
+static bool     s_arr_abaixo = false;   // J contado neste perodo
+static int      s_primask = 0;
+static int      s_pend_tim14 = 0;
+static int      s_pend_ext = 0;
+static uint64_t s_proxima_irq = 3700;
+static int      s_cenario = 1;
+static bool     s_tick_suspenso = false;
+static uint32_t s_uwtick = 0;
+
+static struct {
+    uint32_t erros;
+    uint32_t arr_abaixo_cnt;
+    uint32_t micros_errado;
+    uint32_t uwtick_errado;
+    uint32_t wfi;
+    uint32_t ganchos;
+} s_sim;
+
+void HAL_IncTick(void)     { s_uwtick++; }
+void HAL_SuspendTick(void) { s_tick_suspenso = true; }
+
+static void Sincronizar_CNT(void)
+{
+    sim_tim14.CNT = (uint32_t)((s_t - s_zero_cnt) % TIM14_CONTAGEM);
+}
+
+/**
+ * @brief Instante do prximo update. ARR abaixo do CNT: o contador s volta
+ * a 0 no estouro dos 16 bits e o update vem um ARR depois (erro de reprogramao).
+ */
+static uint64_t Proximo_Update(void)
+{
+    uint64_t cnt = s_t - s_zero_cnt;
+    if (cnt > sim_tim14.ARR) {
+        if (!s_arr_abaixo) {
+            s_arr_abaixo = true;
+            s_sim.arr_abaixo_cnt++;
+            s_sim.erros++;
+            printf("ERRO: ARR %u abaixo do CNT %llu em t=%llu us\n", (unsigned)sim_tim14.ARR,
+                   (unsigned long long)cnt, (unsigned long long)s_t);
+        }
+        return s_zero_cnt + TIM14_CONTAGEM + sim_tim14.ARR + 1u;
+    }
+    return s_zero_cnt + sim_tim14.ARR + 1u;
+}
+
+static void Sinalizar_IRQ_Externa(void);
+
+static void Atender_Pendentes(void)
+{
+    while (!s_primask && (s_pend_tim14 || s_pend_ext)) {
+        if (s_pend_tim14) {
+            s_pend_tim14 = 0;
+            sim_tim14.SR &= ~TIM_SR_UIF;
+            Agendador_TIM14_Update();
+            if (s_tick_suspenso && s_uwtick != (uint32_t)(s_t / 1000u)) {
+                printf("ERRO: uwTick %u em t=%llu us\n", (unsigned)s_uwtick, (unsigned long long)s_t);
+                s_sim.uwtick_errado++;
+                s_sim.erros++;
+            }
+        }
+        if (s_pend_ext) {
+            s_pend_ext = 0;
+            Sinalizar_IRQ_Externa();
+        }
+    }
+}
+
+/**
+ * @brief Avana o tempo at 'ate', gerando os updates do TIM14 e as IRQs
+ * externas no caminho (atendidas na hora, salvo com PRIMASK).
+ */
+static void Avancar(uint64_t ate)
+{
+    for (;;) {
+        uint64_t update = Proximo_Update();
+        uint64_t proximo = (update < s_proxima_irq) ? update : s_proxima_irq;
+        if (proximo > ate) break;
+
+        s_t = proximo;
+        if (proximo == update) {
+            s_zero_cnt = update;
+            s_arr_abaixo = false;
+            sim_tim14.SR |= TIM_SR_UIF;
+            s_pend_tim14 = 1;
+        } else {
+            s_pend_ext = 1;
+            s_proxima_irq += IRQ_MIN_US + (uint64_t)(rand() % IRQ_FAIXA_US);
+            if (s_cenario == 3) {
+                s_proxima_irq = (s_proxima_irq / 1000u) * 1000u + IRQ_FIM_DE_MS_US + (uint64_t)(rand() % 15);
+            }
+        }
+        Sincronizar_CNT();
+        Atender_Pendentes();
+    }
+    s_t = ate;
+    Sincronizar_CNT();
+}
+
+void __disable_irq(void) { s_primask = 1; }
+void __enable_irq(void)  { s_primask = 0; Atender_Pendentes(); }
+
+void __WFI(void)
+{
+    s_sim.wfi++;
+    if (s_pend_tim14 || s_pend_ext) return;
+    uint64_t update = Proximo_Update();
+    uint64_t proximo = (update < s_proxima_irq) ? update : s_proxima_irq;
+    Avancar(proximo + LATENCIA_WFI_US);
+}
+
+//================================================================================
+// Tarefas simuladas
+//================================================================================
+
+typedef struct {
+    uint32_t execucoes;
+    uint32_t atrasos;
+    uint64_t ultima;
+} Sim_Tarefa_t;
+
+static uint8_t      s_id_eventos = AGENDADOR_ID_INVALIDO;
+static uint32_t     s_amostras = 0;     // No ring, esperando a "balanca"
+static uint64_t     s_servos_ate = 0;
+static Sim_Tarefa_t s_balanca, s_servos, s_freq, s_eventos, s_display;
+
+static void Sinalizar_IRQ_Externa(void)
+{
+    s_amostras += (s_cenario == 3) ? 3u : 1u;
+    s_servos_ate = s_t + SERVOS_ATIVO_US;
+    Agendador_Sinalizar(s_id_eventos);
+}
+
+static void Conferir_Micros(const char* tarefa)
+{
+    uint32_t micros = Agendador_Micros();
+    if (micros != (uint32_t)s_t) {
+        printf("ERRO: %s: Agendador_Micros() %u, t=%llu us\n", tarefa, (unsigned)micros,
+               (unsigned long long)s_t);
+        s_sim.micros_errado++;
+        s_sim.erros++;
+    }
+}
+
+static void Rodar(Sim_Tarefa_t* t, const char* nome, uint32_t periodo_us, uint32_t duracao_us)
+{
+    Conferir_Micros(nome);
+    if (periodo_us > 0 && t->ultima != 0 && (s_t - t->ultima) > periodo_us + ATRASO_TOLERADO_US) {
+        t->atrasos++;
+    }
+    t->ultima = s_t;
+    t->execucoes++;
+    Avancar(s_t + duracao_us);
+}
+
+static bool Balanca_Pendente(void) { return s_amostras > 0u; }
+static bool Servos_Pendente(void)  { return s_t < s_servos_ate; }
+
+static void Task_Balanca(void) { s_amostras--; Rodar(&s_balanca, "balanca", 0, 300); }
+static void Task_Servos(void)  { Rodar(&s_servos, "servos", 0, 60); }
+static void Task_Freq(void)    { Rodar(&s_freq, "freq", 5000, 40); }
+static void Task_Eventos(void) { Rodar(&s_eventos, "eventos", 0, 20); }
+static void Task_Display(void) { Rodar(&s_display, "display", 1000000, 2500); }
+
+static void Gancho_1ms(void) { s_sim.ganchos++; }
+
+//================================================================================
+// Programa
+//================================================================================
+
+int main(int argc, char** argv)
+{
+    unsigned semente = 1;
+    uint32_t segundos = 20;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) s_cenario = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) semente = (unsigned)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) segundos = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else {
+            fprintf(stderr, "Uso: %s [-c 1|2|3] [-s semente] [-t segundos]\n", argv[0]);
+            return 2;
+        }
+    }
+    srand(semente);
+
+    Agendador_Init();
+    Agendador_Registrar_Tick(Gancho_1ms);
+    Agendador_Registrar_Periodica_Condicional("balanca", Task_Balanca, Balanca_Pendente, 1, AGENDADOR_PRIO_ALTA);
+    if (s_cenario != 2) {
+        Agendador_Registrar_Periodica("freq", Task_Freq, 5, AGENDADOR_PRIO_ALTA);
+    }
+    Agendador_Registrar_Periodica_Condicional("servos", Task_Servos, Servos_Pendente, 1, AGENDADOR_PRIO_ALTA);
+    s_id_eventos = Agendador_Registrar_Evento("eventos", Task_Eventos, NULL, 5, AGENDADOR_PRIO_MEDIA);
+    if (s_cenario != 2) {
+        Agendador_Registrar_Periodica("display", Task_Display, 1000, AGENDADOR_PRIO_BAIXA);
+    }
+
+    uint64_t fim = (uint64_t)segundos * 1000000u;
+    while (s_t < fim) {
+        Agendador_Executar();
+        Avancar(s_t + 2u); // Custo da passagem do lao
+    }
+
+    uint32_t ms = (uint32_t)(s_t / 1000u);
+    if (s_sim.ganchos != ms || s_uwtick != ms) {
+        printf("ERRO: %u ms simulados, %u ganchos, uwTick %u\n", (unsigned)ms, (unsigned)s_sim.ganchos,
+               (unsigned)s_uwtick);
+        s_sim.erros++;
+    }
+    uint32_t atrasos = s_freq.atrasos + s_display.atrasos;
+    s_sim.erros += atrasos;
+
+    Agendador_Stats_t g;
+    Agendador_Get_Stats(&g);
+    printf("Cenario %d, semente %u: %u ms, %u WFI, ocioso %u ms\n", s_cenario, semente, (unsigned)ms,
+           (unsigned)s_sim.wfi, (unsigned)g.ocioso_ms);
+    printf("  sono sem tick %u (maior %u ms), despertar prazo %u / irq %u, latencia %u/%u us\n",
+           (unsigned)g.sonos_sem_tick, (unsigned)g.maior_sono_ms, (unsigned)g.despertares_prazo,
+           (unsigned)g.despertares_irq, (unsigned)g.latencia_despertar_media_us,
+           (unsigned)g.latencia_despertar_max_us);
+    for (uint8_t i = 0; i < Agendador_Get_Num_Tarefas(); i++) {
+        Agendador_Stats_Tarefa_t s;
+        Agendador_Get_Stats_Tarefa(i, &s);
+        printf("  %-8s exec %7u  perdas %u  atraso max %u us\n", s.nome, (unsigned)s.execucoes,
+               (unsigned)s.perdas_prazo, (unsigned)s.latencia_max_us);
+    }
+    printf("Erros: %u (ARR abaixo do CNT %u, Micros %u, uwTick %u, periodicas atrasadas %u)\n",
+           (unsigned)s_sim.erros, (unsigned)s_sim.arr_abaixo_cnt, (unsigned)s_sim.micros_errado,
+           (unsigned)s_sim.uwtick_errado, (unsigned)atrasos);
+    return (s_sim.erros != 0u) ? 1 : 0;
+}
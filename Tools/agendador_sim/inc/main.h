@@ -0,0 +1,32 @@
+/*******************************************************************************
+ * @file        main.h (agendador_sim)
+ * @brief       Substitui o Core/Inc/main.h na simulao do agendador no PC.
+ * @details     O agendador.c s usa do HAL/CMSIS os registradores CNT, ARR e
+ * SR do TIM14, o PRIMASK, o __WFI() e o uwTick. Aqui eles viram um TIM14
+ * simulado e funes implementadas em agendador_sim.c.
+ ******************************************************************************/
+
+#ifndef AGENDADOR_SIM_MAIN_H
+#define AGENDADOR_SIM_MAIN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    volatile uint32_t CNT;
+    volatile uint32_t ARR;
+    volatile uint32_t SR;
+} Sim_TIM_t;
+
+extern Sim_TIM_t sim_tim14;
+
+#define TIM14       (&sim_tim14)
+#define TIM_SR_UIF  1u
+
+void __disable_irq(void);
+void __enable_irq(void);
+void __WFI(void);
+void HAL_IncTick(void);
+void HAL_SuspendTick(void);
+
+#endif // AGENDADOR_SIM_MAIN_H
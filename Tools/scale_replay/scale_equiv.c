@@ -0,0 +1,295 @@
+/*******************************************************************************
+ * @file        scale_equiv.c
+ * @brief       Teste de equivalncia no PC: caminho de ponto fixo x referncia float.
+ * @version     1.0
+ * @details     Roda o cdigo do firmware compilado com SCALE_FIXED_POINT=1 e
+ * compara cada etapa com a mesma conta feita em double no prprio teste:
+ * - ADS1232_ConvertToMilligrams(): curva de calibrao por segmentos + tara.
+ * - ScaleFilter_Push(): mdia, sigma e inclinao da janela.
+ * - ScaleStability_Push(): deciso "estvel" amostra a amostra.
+ * - Calculo_Umidade_Escala_A_x10000(): Escala A com o ajuste Cal_A.
+ * - Calculo_Umidade_Calcular(): curvas do Produto[] com correo de temperatura.
+ * Sai com cdigo != 0 se alguma etapa passar da tolerncia.
+ *
+ * Compilao (a partir da raiz do repositrio):
+ *   gcc -O2 -std=gnu11 -DUSE_HAL_DRIVER -DSTM32C071xx -DSCALE_FIXED_POINT=1 \
+ *       -ICore/Inc -ICore/Inc/Drivers -ICore/Inc/Modules \
+ *       -IDrivers/STM32C0xx_HAL_Driver/Inc -IDrivers/CMSIS/Device/ST/STM32C0xx/Include \
+ *       -IDrivers/CMSIS/Include \
+ *       Tools/scale_replay/scale_equiv.c Core/Src/Drivers/ads1232_driver.c \
+ *       Core/Src/Modules/scale_filter.c Core/Src/Modules/calculo_umidade.c \
+ *       Core/Src/Modules/GXXX_Equacoes.c -lm -o scale_equiv
+ *   ./scale_equiv
+ ******************************************************************************/
+
+#include "ads1232_driver.h"
+#include "scale_filter.h"
+#include "calculo_umidade.h"
+#include "GXXX_Equacoes.h"
+#include "tim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#if !SCALE_FIXED_POINT
+#error "scale_equiv testa o caminho de ponto fixo: compile com -DSCALE_FIXED_POINT=1"
+#endif
+
+//================================================================================
+// Stubs do HAL e dos mdulos vizinhos (o ISR e o display no rodam aqui)
+//================================================================================
+
+TIM_HandleTypeDef htim3;
+void HAL_GPIO_WritePin(GPIO_TypeDef* p, uint16_t pin, GPIO_PinState s) { (void)p; (void)pin; (void)s; }
+GPIO_PinState HAL_GPIO_ReadPin(const GPIO_TypeDef* p, uint16_t pin) { (void)p; (void)pin; return GPIO_PIN_RESET; }
+void HAL_Delay(uint32_t d) { (void)d; }
+uint32_t HAL_GetTick(void) { return 0; }
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef* h) { (void)h; return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef* h) { (void)h; return HAL_OK; }
+void HAL_NVIC_DisableIRQ(IRQn_Type i) { (void)i; }
+void HAL_NVIC_EnableIRQ(IRQn_Type i) { (void)i; }
+void HAL_NVIC_ClearPendingIRQ(IRQn_Type i) { (void)i; }
+void DWIN_Driver_WriteInt(uint16_t vp, int16_t valor) { (void)vp; (void)valor; }
+
+static float s_cal_a_gain = 1.0f;
+static float s_cal_a_zero = 0.0f;
+
+bool Gerenciador_Config_Get_Cal_A(float* gain, float* zero)
+{
+    *gain = s_cal_a_gain;
+    *zero = s_cal_a_zero;
+    return true;
+}
+
+uint16_t Gerenciador_Config_Get_Volume_Camara_ml(void) { return 0; } // A densidade no entra no teste
+
+//================================================================================
+// Definies
+//================================================================================
+
+#define TOL_MG              1       // Converso e mdia: arredondamento de 1 mg
+#define TOL_SIGMA_UG        2       // + 0.5 % do valor (raiz inteira e Q8)
+#define TOL_ESCALA_X10000   2
+#define TOL_UMIDADE_X100    2
+#define STAB_LIMIAR_G       0.05f   // mesmo critrio do app_manager
+#define STAB_ALVO           3
+#define AMOSTRAS_FILTRO     20000
+
+typedef struct {
+    const char* nome;
+    uint32_t casos;
+    uint32_t falhas;
+    double   pior;
+} Resultado_t;
+
+static CalPoint_t s_cal[ADS1232_CAL_MAX_POINTS];
+static uint8_t    s_num_cal;
+static double     s_adc_zero;   // ADC de 0 g da curva (a tara reancora nele)
+static int32_t    s_offset;
+
+//================================================================================
+// Referncias em double
+//================================================================================
+
+static void Registrar(Resultado_t* r, double erro, double tol)
+{
+    r->casos++;
+    if (fabs(erro) > r->pior) r->pior = fabs(erro);
+    if (fabs(erro) > tol) r->falhas++;
+}
+
+static double Ref_Gramas(int32_t raw)
+{
+    double x = (double)raw - s_offset + s_adc_zero;
+    uint8_t i = 0;
+    while (i + 2u < s_num_cal && x >= s_cal[i + 1].adc_value) i++;
+    double m = (double)(s_cal[i + 1].grams - s_cal[i].grams) / (s_cal[i + 1].adc_value - s_cal[i].adc_value);
+    return s_cal[i].grams + m * (x - s_cal[i].adc_value);
+}
+
+static double Ref_Gramas_Por_Count(int32_t raw)
+{
+    return Ref_Gramas(raw + 1) - Ref_Gramas(raw);
+}
+
+static double Ref_Escala_A(uint32_t freq_chz)
+{
+    double escala = 396.85 - 0.00014955 * ((double)freq_chz / 100.0);
+    return escala * s_cal_a_gain + s_cal_a_zero;
+}
+
+static double Ref_Umidade_x100(const struct Produtos_ROM* p, uint32_t freq_chz, int32_t peso_mg, int32_t temp_x100)
+{
+#if UMID_CORRECAO_PESO
+    double x = Ref_Escala_A(freq_chz) * (p->Peso_Pad * 1000.0) / peso_mg;
+#else
+    double x = Ref_Escala_A(freq_chz);
+    (void)peso_mg;
+#endif
+    if (x > 1000.0) x = 1000.0;
+    double um = ((p->Fat_A * x + p->Fat_B) * x + p->Fat_C) * x + p->Fat_D;
+    um += ((temp_x100 - UMID_TEMP_REF_X100) / 100.0) * (p->CT_Ganho * um + p->CT_Zero);
+    if (um < p->Um_Min) um = p->Um_Min;
+    if (um > p->Um_Max) um = p->Um_Max;
+    return um * 100.0;
+}
+
+//================================================================================
+// Etapas
+//================================================================================
+
+static void Testar_Conversao(Resultado_t* r)
+{
+    for (int32_t raw = 0; raw <= 2000000; raw += 37) {
+        Registrar(r, ADS1232_ConvertToMilligrams(raw) - 1000.0 * Ref_Gramas(raw), TOL_MG);
+    }
+}
+
+static void Testar_Filtro(Resultado_t* r_media, Resultado_t* r_sigma, Resultado_t* r_slope)
+{
+    static ScaleFilter sf;
+    static int32_t janela[SCALE_FILTER_WIN_SIZE];
+    ScaleFilterOut out;
+    int32_t nivel = s_offset;
+
+    ScaleFilter_Init(&sf, nivel);
+    for (int k = 0; k < SCALE_FILTER_WIN_SIZE; k++) janela[k] = nivel;
+
+    srand(1234);
+    for (uint32_t n = 0; n < AMOSTRAS_FILTRO; n++) {
+        if (n % 500u == 0u) nivel = s_offset + (rand() % 1200000);          // degrau de carga
+        int32_t amostra = nivel + (int32_t)(n % 64u) * 3 + (rand() % 41) - 20; // rampa + rudo
+        ScaleFilter_Push(&sf, amostra, &out);
+        janela[n % SCALE_FILTER_WIN_SIZE] = amostra;
+        if (n < SCALE_FILTER_WIN_SIZE) continue;
+
+        double soma = 0.0, soma2 = 0.0, soma_ix = 0.0;
+        for (int k = 0; k < SCALE_FILTER_WIN_SIZE; k++) {
+            double v = janela[(n + 1u + (uint32_t)k) % SCALE_FILTER_WIN_SIZE]; // k = 0: mais antiga
+            soma += v;
+            soma2 += v * v;
+            soma_ix += k * v;
+        }
+        const double N = SCALE_FILTER_WIN_SIZE;
+        double media = soma / N;
+        double sigma = sqrt(fmax(soma2 / N - media * media, 0.0));
+        double sx = N * (N - 1.0) / 2.0, sxx = (N - 1.0) * N * (2.0 * N - 1.0) / 6.0;
+        double slope = (N * soma_ix - sx * soma) / (N * sxx - sx * sx);
+        double gpc_ug = 1.0e6 * Ref_Gramas_Por_Count((int32_t)lround(media));
+
+        Registrar(r_media, out.avg_mg - 1000.0 * Ref_Gramas((int32_t)lround(media)), TOL_MG);
+        Registrar(r_sigma, out.sigma_ug - sigma * gpc_ug, TOL_SIGMA_UG + 0.005 * sigma * gpc_ug);
+        Registrar(r_slope, out.slope_ug - slope * gpc_ug, TOL_SIGMA_UG + 0.005 * fabs(slope * gpc_ug));
+    }
+}
+
+static void Testar_Estabilidade(Resultado_t* r)
+{
+    ScaleStability fixo;
+    double ref_g = 0.0;
+    uint8_t contagem = 0;
+
+    ScaleStability_Init(&fixo, STAB_LIMIAR_G, STAB_ALVO);
+    srand(99);
+    int32_t nivel = 50001;
+    for (uint32_t n = 0; n < AMOSTRAS_FILTRO; n++) {
+        // Mltiplos de 3 mg: nenhuma diferena cai exatamente no limiar (50 mg),
+        // onde float e inteiro arredondam cada um para um lado
+        if (n % 40u == 0u) nivel = 3 * (rand() % 66667);
+        int32_t mg = nivel + 3 * ((rand() % 41) - 20);
+
+        // Mesma regra do caminho float (ScaleStability_Push com gramas)
+        uint8_t estavel_ref;
+        if (fabs(mg / 1000.0 - ref_g) < STAB_LIMIAR_G) {
+            if (contagem < STAB_ALVO) contagem++;
+            estavel_ref = (contagem >= STAB_ALVO);
+        } else {
+            contagem = 0;
+            ref_g = mg / 1000.0;
+            estavel_ref = 0;
+        }
+        Registrar(r, (double)(ScaleStability_Push(&fixo, mg) != estavel_ref), 0.0);
+    }
+}
+
+static void Testar_Escala_A(Resultado_t* r)
+{
+    static const float ganhos[] = { 1.0f, 0.98765f, 1.0213f };
+    static const float zeros[]  = { 0.0f, -1.234f, 2.5f };
+
+    for (unsigned g = 0; g < sizeof(ganhos) / sizeof(ganhos[0]); g++) {
+        for (unsigned z = 0; z < sizeof(zeros) / sizeof(zeros[0]); z++) {
+            s_cal_a_gain = ganhos[g];
+            s_cal_a_zero = zeros[z];
+            Calculo_Umidade_Atualizar_Cal_A(); // Como o firmware: converte uma vez por ajuste
+            for (uint32_t f = 150000000u; f <= 265000000u; f += 12345u) {
+                Registrar(r, Calculo_Umidade_Escala_A_x10000(f) - 10000.0 * Ref_Escala_A(f), TOL_ESCALA_X10000);
+            }
+        }
+    }
+    s_cal_a_gain = 1.0f;
+    s_cal_a_zero = 0.0f;
+}
+
+static void Testar_Umidade(Resultado_t* r)
+{
+    static const int32_t pesos_pct[] = { 60, 100, 125 };
+    static const int32_t temps_x100[] = { 1000, 2500, 4000 };
+
+    for (uint8_t g = 0; g < NR_CEREAIS; g++) {
+        Calculo_Umidade_Selecionar_Grao(g);
+        const struct Produtos_ROM* p = &Produto[g];
+        for (unsigned w = 0; w < sizeof(pesos_pct) / sizeof(pesos_pct[0]); w++) {
+            int32_t peso_mg = p->Peso_Pad * 10 * pesos_pct[w];
+            for (unsigned t = 0; t < sizeof(temps_x100) / sizeof(temps_x100[0]); t++) {
+                for (uint32_t f = 150000000u; f <= 265000000u; f += 50000u) {
+                    Umid_Resultado_t res;
+                    Calculo_Umidade_Calcular(f, peso_mg, temps_x100[t], &res);
+                    Registrar(r, res.umidade_x100 - Ref_Umidade_x100(p, f, peso_mg, temps_x100[t]),
+                              TOL_UMIDADE_X100);
+                }
+            }
+        }
+    }
+}
+
+//================================================================================
+// Main
+//================================================================================
+
+int main(void)
+{
+    // Calibrao de fbrica e uma tara qualquer
+    ADS1232_Init();
+    s_num_cal = ADS1232_CAL_PADRAO_PONTOS;
+    for (uint8_t i = 0; i < s_num_cal; i++) s_cal[i] = ADS1232_CAL_PADRAO[i];
+    ADS1232_CalTable_t tabela;
+    ADS1232_GetCalTable(&tabela);
+    s_adc_zero = tabela.adc_zero;
+    s_offset = 241000;
+    ADS1232_SetOffset(s_offset);
+
+    Resultado_t r[] = {
+        { "Conversao counts -> mg (mg)", 0, 0, 0.0 },
+        { "Filtro: media (mg)",          0, 0, 0.0 },
+        { "Filtro: sigma (ug)",          0, 0, 0.0 },
+        { "Filtro: inclinacao (ug)",     0, 0, 0.0 },
+        { "Estabilidade (divergencias)", 0, 0, 0.0 },
+        { "Escala A (x10000)",           0, 0, 0.0 },
+        { "Umidade (x100)",              0, 0, 0.0 },
+    };
+    Testar_Conversao(&r[0]);
+    Testar_Filtro(&r[1], &r[2], &r[3]);
+    Testar_Estabilidade(&r[4]);
+    Testar_Escala_A(&r[5]);
+    Testar_Umidade(&r[6]);
+
+    uint32_t falhas = 0;
+    for (unsigned i = 0; i < sizeof(r) / sizeof(r[0]); i++) {
+        printf("%-30s %8lu casos, pior erro %10.3f, %lu fora da tolerancia\n", r[i].nome,
+               (unsigned long)r[i].casos, r[i].pior, (unsigned long)r[i].falhas);
+        falhas += r[i].falhas;
+    }
+    printf("%s\n", falhas ? "FALHOU" : "OK: ponto fixo equivalente ao float");
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,565 @@
+/*******************************************************************************
+ * @file        scale_replay.c
+ * @brief       Replay/benchmark no PC (Linux) de capturas da clula de carga.
+ * @version     1.3 (Vazo da dosagem)
+ * @details     Reproduz uma captura feita com o comando "CAPTURA" do CLI pelo
+ * mesmo cdigo do firmware: ScaleMedian_Push(), ScaleFilterChain_Push(), ADS1232_ConvertToGrams()
+ * (tabela de calibrao da captura), a estabilidade da UI (Check_Stability ->
+ * ScaleStability_Push), a previso do assentamento (ScaleSettle_Push, com a
+ * mesma janela do app_manager) e ScaleFilter_Push() para sigma/slope.
+ *
+ * Mtricas:
+ * - Tempo de assentamento: do degrau de carga at a UI indicar "estvel".
+ * - Previso: do degrau at a primeira previso convergida, e o erro dela
+ *   contra o peso final do patamar ("fora" = erro acima de incerteza + tol).
+ * - Rudo: desvio padro (mg) na metade final de cada patamar, bruto e filtrado.
+ * - Falso-estvel: amostras "estveis" a mais de 'tol' do peso final do patamar.
+ * - Custo de CPU por amostra (no PC: serve para comparar algoritmos/builds).
+ * - Ciclo (s se a captura tiver as linhas "#FASE" gravadas durante um ciclo):
+ *   do incio do MEDINDO at peso estvel / previso convergida, com a
+ *   previso reiniciada em toda mudana de fase e com o histrico mantido de
+ *   NIVELANDO para MEDINDO (poltica do app_manager).
+ * - Dosagem (idem, em cada ENCHENDO): a regresso da vazo do ciclo_medicao,
+ *   com o mesmo nmero de amostras; tempo at chegar a 90% da vazo do fim
+ *   do enchimento e o erro (rms) da estimativa na metade final.
+ *
+ * Compilao (a partir da raiz do repositrio), uma vez para cada caminho:
+ *   gcc -O2 -std=gnu11 -DUSE_HAL_DRIVER -DSTM32C071xx -DSCALE_FIXED_POINT=1 \
+ *       -ICore/Inc -ICore/Inc/Drivers -ICore/Inc/Modules \
+ *       -IDrivers/STM32C0xx_HAL_Driver/Inc -IDrivers/CMSIS/Device/ST/STM32C0xx/Include \
+ *       -IDrivers/CMSIS/Include \
+ *       Tools/scale_replay/scale_replay.c Core/Src/Drivers/ads1232_driver.c \
+ *       Core/Src/Modules/scale_filter.c -lm -o scale_replay_fixo
+ *   (troque para -DSCALE_FIXED_POINT=0 e -o scale_replay_float para o caminho float)
+ *
+ * Uso:
+ *   ./scale_replay_fixo [-m mediana] [-f "MM:8"] [-d degrau_mg] [-e evento_g]
+ *                       [-t tol_g] [-r repeticoes] [-v] captura.log
+ * A captura pode ser o log bruto do terminal: s as linhas "#..." e "@..." so lidas
+ * (tambm aceita CSV "seq,tick,raw"; colunas a mais, como o "speed" de
+ * capturas antigas, so ignoradas).
+ ******************************************************************************/
+
+#include "ads1232_driver.h"
+#include "scale_filter.h"
+#include "ciclo_medicao.h"
+#include "tim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+//================================================================================
+// Stubs do HAL (o driver s precisa deles para compilar; o ISR no roda aqui)
+//================================================================================
+
+TIM_HandleTypeDef htim3;
+void HAL_GPIO_WritePin(GPIO_TypeDef* p, uint16_t pin, GPIO_PinState s) { (void)p; (void)pin; (void)s; }
+GPIO_PinState HAL_GPIO_ReadPin(const GPIO_TypeDef* p, uint16_t pin) { (void)p; (void)pin; return GPIO_PIN_RESET; }
+void HAL_Delay(uint32_t d) { (void)d; }
+uint32_t HAL_GetTick(void) { return 0; }
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef* h) { (void)h; return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef* h) { (void)h; return HAL_OK; }
+void HAL_NVIC_DisableIRQ(IRQn_Type i) { (void)i; }
+void HAL_NVIC_EnableIRQ(IRQn_Type i) { (void)i; }
+void HAL_NVIC_ClearPendingIRQ(IRQn_Type i) { (void)i; }
+
+//================================================================================
+// Definies
+//================================================================================
+
+#define MAX_AMOSTRAS        200000
+#define MAX_PATAMARES       4096
+#define JANELA_EVENTO       5       // mediana usada para localizar degraus
+#define FUSAO_EVENTOS_MS    1000    // degraus mais prximos que isto so um s
+#define MIN_AMOSTRAS_PAT    16      // patamares menores so ignorados nas mtricas
+#define STAB_LIMIAR_G       0.05f   // mesmo critrio do app_manager
+#define STAB_ALVO           3
+#define PREV_JANELA         16      // previso: mesmos parmetros do app_manager
+#define PREV_INCERTEZA_MG   50
+
+typedef struct {
+    uint32_t tick;
+    int32_t  raw;
+    float    g_bruto;
+    float    g_filtrado;
+    uint8_t  fase;      // Ciclo_Fase_t da ltima linha "#FASE" (OCIOSO se ausente)
+    uint8_t  estavel;
+    uint8_t  previsto;  // ScaleSettle convergido
+    int32_t  peso_mg;   // Peso entregue ao ciclo (como o app_manager)
+    float    g_previsto;
+    float    incerteza_g;
+    float    sigma_g;   // ScaleFilter_Push (janela longa)
+} Amostra_t;
+
+static Amostra_t s_am[MAX_AMOSTRAS];
+static uint32_t  s_num;
+static CalPoint_t s_cal[ADS1232_CAL_MAX_POINTS];
+static uint8_t   s_num_cal;
+static int32_t   s_offset;
+static int       s_tem_offset;
+static int       s_tem_fases;
+
+//================================================================================
+// Leitura da captura
+//================================================================================
+
+static int Carregar_Captura(const char* caminho)
+{
+    FILE* f = fopen(caminho, "r");
+    if (f == NULL) { perror(caminho); return 0; }
+
+    char linha[256];
+    uint32_t seq_anterior = 0, lacunas = 0;
+    uint8_t fase = CICLO_OCIOSO;
+    while (fgets(linha, sizeof(linha), f) != NULL && s_num < MAX_AMOSTRAS) {
+        char* p = linha;
+        while (*p == '\r' || *p == ' ') p++;
+
+        if (strncmp(p, "#OFFSET", 7) == 0) {
+            s_offset = (int32_t)strtol(p + 7, NULL, 10);
+            s_tem_offset = 1;
+            continue;
+        }
+        if (strncmp(p, "#FASE", 5) == 0) {
+            fase = (uint8_t)strtoul(p + 5, NULL, 10);
+            s_tem_fases = 1;
+            continue;
+        }
+        if (strncmp(p, "#CAL", 4) == 0 && s_num_cal < ADS1232_CAL_MAX_POINTS) {
+            char* fim;
+            s_cal[s_num_cal].grams = strtof(p + 4, &fim);
+            s_cal[s_num_cal].adc_value = (int32_t)strtol(fim, NULL, 10);
+            s_num_cal++;
+            continue;
+        }
+        if (*p == '@') p++;
+        else if (*p < '0' || *p > '9') continue;
+
+        unsigned long seq, tick;
+        long raw;
+        if (sscanf(p, "%lu,%lu,%ld", &seq, &tick, &raw) < 3) continue;
+        if (s_num > 0 && seq != seq_anterior + 1u) lacunas++;
+        seq_anterior = (uint32_t)seq;
+        s_am[s_num].tick = (uint32_t)tick;
+        s_am[s_num].raw = (int32_t)raw;
+        s_am[s_num].fase = fase;
+        s_num++;
+    }
+    fclose(f);
+    printf("Captura: %lu amostras, %lu lacuna(s) de sequencia, %u pontos de calibracao\n",
+           (unsigned long)s_num, (unsigned long)lacunas, (unsigned)s_num_cal);
+    return s_num > 0;
+}
+
+static int Parse_Filtro(char* texto, ScaleFilterStageCfg* cfg)
+{
+    int n = 0;
+    for (char* tok = strtok(texto, " "); tok != NULL && n < SF_CHAIN_MAX_STAGES; tok = strtok(NULL, " ")) {
+        unsigned a = 0, b = 0;
+        char tipo[8] = { 0 };
+        sscanf(tok, "%7[A-Za-z]:%u:%u", tipo, &a, &b);
+        memset(&cfg[n], 0, sizeof(cfg[n]));
+        if (strcasecmp(tipo, "MM") == 0)       { cfg[n].type = SF_STAGE_MOVING_AVG; cfg[n].window = (uint8_t)a; }
+        else if (strcasecmp(tipo, "MED") == 0) { cfg[n].type = SF_STAGE_MEDIAN;     cfg[n].window = (uint8_t)a; }
+        else if (strcasecmp(tipo, "EMA") == 0) { cfg[n].type = SF_STAGE_EMA;        cfg[n].param_a = (uint16_t)a; }
+        else if (strcasecmp(tipo, "KAL") == 0) { cfg[n].type = SF_STAGE_KALMAN;     cfg[n].param_a = (uint16_t)a; cfg[n].param_b = (uint16_t)b; }
+        else { fprintf(stderr, "Estagio desconhecido: %s\n", tok); exit(1); }
+        n++;
+    }
+    return n;
+}
+
+//================================================================================
+// Pipeline (igual ao Task_Handle_Scale, sem o hardware)
+//================================================================================
+
+// Mesmo critrio do Fase_Muda_Massa do app_manager (com 'manter' = 0 reinicia em toda fase)
+static int Fase_Muda_Massa(uint8_t anterior, uint8_t fase, int manter)
+{
+    if (fase == anterior) return 0;
+    return !(manter && anterior == CICLO_NIVELANDO && fase == CICLO_MEDINDO);
+}
+
+static void Rodar_Pipeline(uint8_t mediana, const ScaleFilterStageCfg* cfg, int n_cfg, int32_t degrau_mg,
+                           int manter_nivelando)
+{
+    static ScaleFilter sf; // ~300 bytes de janela: esttico como no firmware
+    ScaleMedian med;
+    ScaleFilterChain cadeia;
+    ScaleStability estab;
+    ScaleSettle prev;
+    uint8_t prev_fase = CICLO_OCIOSO;
+    ScaleFilterOut out;
+
+    ScaleMedian_Init(&med, mediana);
+    ScaleFilterChain_Init(&cadeia, cfg, (uint8_t)n_cfg, degrau_mg);
+    ScaleStability_Init(&estab, STAB_LIMIAR_G, STAB_ALVO);
+    ScaleSettle_Init(&prev, PREV_JANELA, PREV_INCERTEZA_MG);
+    ScaleFilter_Init(&sf, s_am[0].raw);
+
+    for (uint32_t i = 0; i < s_num; i++) {
+        uint8_t degrau = 0;
+        int32_t y = ScaleFilterChain_Push(&cadeia, ScaleMedian_Push(&med, s_am[i].raw), &degrau);
+        s_am[i].g_filtrado = ADS1232_ConvertToGrams(y);
+
+        if (degrau || Fase_Muda_Massa(prev_fase, s_am[i].fase, manter_nivelando)) {
+            ScaleSettle_Reset(&prev);
+        }
+        prev_fase = s_am[i].fase;
+#if SCALE_FIXED_POINT
+        int32_t peso_mg = ADS1232_ConvertToMilligrams(y);
+#else
+        int32_t peso_mg = (int32_t)lrintf(s_am[i].g_filtrado * 1000.0f); // como o app_manager
+#endif
+        s_am[i].peso_mg = peso_mg;
+        s_am[i].previsto = ScaleSettle_Push(&prev, peso_mg);
+        s_am[i].g_previsto = (float)prev.pred_mg / 1000.0f;
+        s_am[i].incerteza_g = (float)prev.bound_mg / 1000.0f;
+
+#if SCALE_FIXED_POINT
+        s_am[i].estavel = ScaleStability_Push(&estab, ADS1232_ConvertToMilligrams(y));
+        ScaleFilter_Push(&sf, y, &out);
+        s_am[i].sigma_g = (float)out.sigma_ug / 1.0e6f;
+#else
+        s_am[i].estavel = ScaleStability_Push(&estab, s_am[i].g_filtrado);
+        ScaleFilter_Push(&sf, y, &out);
+        s_am[i].sigma_g = out.sigma_grams;
+#endif
+    }
+}
+
+static double Agora_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int Cmp_Float(const void* a, const void* b)
+{
+    float fa = *(const float*)a, fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+static float Mediana(float* v, uint32_t n)
+{
+    qsort(v, n, sizeof(float), Cmp_Float);
+    return v[n / 2];
+}
+
+/**
+ * @brief Do incio de cada MEDINDO at o peso que o ciclo aceitaria
+ * (estvel ou previso convergida), como no ciclo_medicao.
+ */
+static void Relatorio_Ciclo(const char* rotulo, float tol_g)
+{
+    static float tmp[MAX_AMOSTRAS];
+    uint32_t n_med = 0, n_prev = 0, n_estab = 0, n_fora = 0;
+    double soma_prev = 0.0, soma_estab = 0.0, soma_pronto = 0.0, soma_erro = 0.0;
+
+    for (uint32_t a = 1; a < s_num; a++) {
+        if (s_am[a].fase != CICLO_MEDINDO || s_am[a - 1].fase == CICLO_MEDINDO) continue;
+        uint32_t b = a;
+        while (b < s_num && s_am[b].fase == CICLO_MEDINDO) b++;
+        if (b - a < MIN_AMOSTRAS_PAT) continue;
+
+        // Peso "verdadeiro": mediana do ltimo quarto da medio (bruto)
+        uint32_t q = a + (3u * (b - a)) / 4u, nq = 0;
+        for (uint32_t i = q; i < b; i++) tmp[nq++] = s_am[i].g_bruto;
+        float verdade = Mediana(tmp, nq);
+
+        uint32_t ie = a, ip = a;
+        while (ie < b && !s_am[ie].estavel) ie++;
+        while (ip < b && !s_am[ip].previsto) ip++;
+        n_med++;
+        if (ie < b) {
+            n_estab++;
+            soma_estab += (double)(s_am[ie].tick - s_am[a].tick);
+        }
+        if (ip < b) {
+            double erro = fabs((double)s_am[ip].g_previsto - verdade);
+            n_prev++;
+            soma_prev += (double)(s_am[ip].tick - s_am[a].tick);
+            soma_erro += erro;
+            if (erro > s_am[ip].incerteza_g + tol_g) n_fora++;
+        }
+        uint32_t pronto = (ip < ie) ? ip : ie;
+        if (pronto >= b) pronto = b - 1;
+        soma_pronto += (double)(s_am[pronto].tick - s_am[a].tick);
+    }
+    if (n_med == 0) return;
+    printf("Ciclo (%s): %lu medicoes\n", rotulo, (unsigned long)n_med);
+    printf("  estavel %.0f ms (%lu) | previsto %.0f ms (%lu, erro %.1f mg, %lu fora) | peso pronto %.0f ms\n",
+           n_estab ? soma_estab / n_estab : 0.0, (unsigned long)n_estab,
+           n_prev ? soma_prev / n_prev : 0.0, (unsigned long)n_prev,
+           n_prev ? 1000.0 * soma_erro / n_prev : 0.0, (unsigned long)n_fora,
+           soma_pronto / n_med);
+}
+
+/**
+ * @brief Amostras da regresso da vazo: mesmo clculo do Estimar_Vazao_mg_s.
+ */
+static uint32_t Amostras_Vazao(void)
+{
+    uint32_t n = (CICLO_VAZAO_JANELA_MS * ADS1232_SPS) / 1000u;
+    if (n > CICLO_PESO_AMOSTRAS) n = CICLO_PESO_AMOSTRAS;
+    if (n < CICLO_VAZAO_MIN_AMOSTRAS) n = CICLO_VAZAO_MIN_AMOSTRAS;
+    return n;
+}
+
+/**
+ * @brief Inclinao de mnimos quadrados (mg/s) das 'n' amostras que terminam em 'fim'.
+ */
+static int32_t Vazao_mg_s(uint32_t fim, uint32_t n)
+{
+    uint32_t ini = fim + 1u - n;
+    uint32_t t0 = s_am[ini].tick;
+    int64_t soma_p = 0, soma_t = 0;
+    for (uint32_t i = ini; i <= fim; i++) {
+        soma_p += s_am[i].peso_mg;
+        soma_t += (int64_t)(s_am[i].tick - t0);
+    }
+    int64_t cov = 0, var_t = 0;
+    for (uint32_t i = ini; i <= fim; i++) {
+        int64_t dt = (int64_t)(s_am[i].tick - t0) * n - soma_t;
+        int64_t dp = (int64_t)s_am[i].peso_mg * n - soma_p;
+        cov   += dt * dp;
+        var_t += dt * dt;
+    }
+    return (var_t > 0) ? (int32_t)((cov * 1000) / var_t) : 0;
+}
+
+/**
+ * @brief Vazo estimada em cada ENCHENDO, como no ciclo_medicao (o histrico
+ * do peso atravessa o incio da fase). A referncia  a inclinao da metade
+ * final do enchimento, onde o fluxo j  constante.
+ */
+static void Relatorio_Dosagem(void)
+{
+    uint32_t n = Amostras_Vazao();
+    uint32_t n_ench = 0, n_resp = 0, n_erro = 0;
+    double soma_ref = 0.0, soma_resp = 0.0, soma_erro2 = 0.0;
+
+    for (uint32_t a = 1; a < s_num; a++) {
+        if (s_am[a].fase != CICLO_ENCHENDO || s_am[a - 1].fase == CICLO_ENCHENDO) continue;
+        uint32_t b = a;
+        while (b < s_num && s_am[b].fase == CICLO_ENCHENDO) b++;
+        uint32_t meio = a + (b - a) / 2u;
+        if (b - meio < 3u || a + 1u < n) continue;
+
+        double ref = (double)Vazao_mg_s(b - 1u, b - meio);
+        if (ref <= 0.0) continue;
+        n_ench++;
+        soma_ref += ref;
+
+        uint32_t i = a;
+        while (i < b && (double)Vazao_mg_s(i, n) < 0.9 * ref) i++;
+        if (i < b) {
+            n_resp++;
+            soma_resp += (double)(s_am[i].tick - s_am[a].tick);
+        }
+        for (i = meio; i < b; i++) {
+            double e = (double)Vazao_mg_s(i, n) - ref;
+            soma_erro2 += e * e;
+            n_erro++;
+        }
+    }
+    if (n_ench == 0) return;
+    printf("Dosagem: %lu enchimentos, regressao de %lu amostras (%lu ms a %u SPS)\n",
+           (unsigned long)n_ench, (unsigned long)n, (unsigned long)(n * 1000u / ADS1232_SPS), (unsigned)ADS1232_SPS);
+    printf("  vazao %.2f g/s | 90%% da vazao em %.0f ms (%lu) | erro rms %.2f g/s\n",
+           soma_ref / n_ench / 1000.0, n_resp ? soma_resp / n_resp : 0.0, (unsigned long)n_resp,
+           n_erro ? sqrt(soma_erro2 / n_erro) / 1000.0 : 0.0);
+}
+
+//================================================================================
+// Main
+//================================================================================
+
+int main(int argc, char** argv)
+{
+    char filtro_txt[128] = "MM:8";
+    int mediana = 5;
+    int32_t degrau_mg = 300;
+    float evento_g = 1.0f;
+    float tol_g = STAB_LIMIAR_G;
+    int repeticoes = 20;
+    int verboso = 0;
+    const char* arquivo = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) { mediana = atoi(argv[++i]); }
+        else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) { strncpy(filtro_txt, argv[++i], sizeof(filtro_txt) - 1); }
+        else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) { degrau_mg = atoi(argv[++i]); }
+        else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) { evento_g = strtof(argv[++i], NULL); }
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) { tol_g = strtof(argv[++i], NULL); }
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) { repeticoes = atoi(argv[++i]); }
+        else if (strcmp(argv[i], "-v") == 0) { verboso = 1; }
+        else { arquivo = argv[i]; }
+    }
+    if (arquivo == NULL) {
+        fprintf(stderr, "uso: %s [-m mediana] [-f \"MM:8\"] [-d degrau_mg] [-e evento_g] [-t tol_g] [-r rep] [-v] captura.log\n", argv[0]);
+        return 1;
+    }
+    if (!Carregar_Captura(arquivo)) return 1;
+
+    ScaleFilterStageCfg cfg[SF_CHAIN_MAX_STAGES];
+    char filtro_copia[128];
+    strcpy(filtro_copia, filtro_txt);
+    int n_cfg = Parse_Filtro(filtro_copia, cfg);
+
+    // Calibrao e tara da captura (sem cabealho: tabela de fbrica e tara nas 16 primeiras)
+    ADS1232_Init();
+    if (s_num_cal >= 2 && !ADS1232_SetCalibration(s_cal, s_num_cal)) {
+        fprintf(stderr, "Calibracao da captura invalida; usando a de fabrica.\n");
+    }
+    if (!s_tem_offset) {
+        int64_t soma = 0;
+        uint32_t n = (s_num < 16) ? s_num : 16;
+        for (uint32_t i = 0; i < n; i++) soma += s_am[i].raw;
+        s_offset = (int32_t)(soma / (int64_t)n);
+    }
+    ADS1232_SetOffset(s_offset);
+    for (uint32_t i = 0; i < s_num; i++) {
+        s_am[i].g_bruto = ADS1232_ConvertToGrams(s_am[i].raw);
+    }
+
+    // Custo por amostra: repete o pipeline inteiro e fica com o melhor tempo
+    double melhor_ns = 1e30;
+    for (int r = 0; r < repeticoes; r++) {
+        double t0 = Agora_ns();
+        Rodar_Pipeline((uint8_t)mediana, cfg, n_cfg, degrau_mg, 1);
+        double dt = Agora_ns() - t0;
+        if (dt < melhor_ns) melhor_ns = dt;
+    }
+
+    // --- Localiza os degraus de carga pela mediana mvel do sinal bruto ---
+    static uint32_t inicio_pat[MAX_PATAMARES + 1];
+    uint32_t n_pat = 0;
+    inicio_pat[n_pat++] = 0;
+    float ref = s_am[0].g_bruto;
+    for (uint32_t i = JANELA_EVENTO; i < s_num && n_pat < MAX_PATAMARES; i++) {
+        float jan[JANELA_EVENTO];
+        for (int k = 0; k < JANELA_EVENTO; k++) jan[k] = s_am[i - k].g_bruto;
+        float m = Mediana(jan, JANELA_EVENTO);
+        if (fabsf(m - ref) > evento_g) {
+            uint32_t ultimo = inicio_pat[n_pat - 1];
+            uint32_t evento = i - JANELA_EVENTO / 2;
+            if (s_am[evento].tick - s_am[ultimo].tick < FUSAO_EVENTOS_MS && ultimo != 0) {
+                // ainda na mesma rampa: o patamar comea no primeiro degrau
+            } else {
+                inicio_pat[n_pat++] = evento;
+            }
+            ref = m; // durante uma rampa cada novo salto  fundido ao mesmo patamar
+        }
+    }
+    inicio_pat[n_pat] = s_num;
+
+    // --- Mtricas por patamar ---
+    uint32_t n_eventos = 0, nao_assentou = 0;
+    double soma_assent = 0.0, max_assent = 0.0;
+    uint32_t n_previstos = 0, n_prev_fora = 0;
+    double soma_prev = 0.0, max_prev = 0.0, soma_erro_prev = 0.0;
+    uint64_t n_estaveis = 0, n_falsos = 0;
+    double soma_var_f = 0.0, soma_var_b = 0.0;
+    uint64_t n_var = 0;
+    static float tmp[MAX_AMOSTRAS];
+
+    for (uint32_t p = 0; p < n_pat; p++) {
+        uint32_t a = inicio_pat[p], b = inicio_pat[p + 1];
+        if (b - a < MIN_AMOSTRAS_PAT) continue;
+
+        // Peso "verdadeiro": mediana do ltimo quarto do patamar (bruto)
+        uint32_t q = a + (3u * (b - a)) / 4u;
+        uint32_t nq = 0;
+        for (uint32_t i = q; i < b; i++) tmp[nq++] = s_am[i].g_bruto;
+        float verdade = Mediana(tmp, nq);
+
+        // Assentamento (s para patamares que comeam num degrau)
+        if (p > 0) {
+            n_eventos++;
+            uint32_t i = a;
+            while (i < b && !s_am[i].estavel) i++;
+            if (i < b) {
+                double ms = (double)(s_am[i].tick - s_am[a].tick);
+                soma_assent += ms;
+                if (ms > max_assent) max_assent = ms;
+            } else {
+                nao_assentou++;
+            }
+
+            // Primeira previso convergida do patamar (a do patamar anterior
+            // ainda vale at o degrau chegar  sada da cadeia)
+            i = a;
+            while (i < b && s_am[i].previsto) i++;
+            while (i < b && !s_am[i].previsto) i++;
+            if (i < b) {
+                double ms = (double)(s_am[i].tick - s_am[a].tick);
+                double erro = fabs((double)s_am[i].g_previsto - verdade);
+                n_previstos++;
+                soma_prev += ms;
+                if (ms > max_prev) max_prev = ms;
+                soma_erro_prev += erro;
+                if (erro > s_am[i].incerteza_g + tol_g) n_prev_fora++;
+            }
+        }
+
+        for (uint32_t i = a; i < b; i++) {
+            if (s_am[i].estavel) {
+                n_estaveis++;
+                if (fabsf(s_am[i].g_filtrado - verdade) > tol_g) n_falsos++;
+            }
+        }
+
+        // Rudo na metade final (j assentado)
+        for (uint32_t i = a + (b - a) / 2u; i < b; i++) {
+            double df = s_am[i].g_filtrado - verdade;
+            double db = s_am[i].g_bruto - verdade;
+            soma_var_f += df * df;
+            soma_var_b += db * db;
+            n_var++;
+        }
+    }
+
+    if (verboso) {
+        printf("tick_ms,raw,g_bruto,g_filtrado,estavel,g_previsto,previsto,sigma_g\n");
+        for (uint32_t i = 0; i < s_num; i++) {
+            printf("%lu,%ld,%.4f,%.4f,%u,%.4f,%u,%.5f\n", (unsigned long)s_am[i].tick, (long)s_am[i].raw,
+                   s_am[i].g_bruto, s_am[i].g_filtrado, (unsigned)s_am[i].estavel,
+                   s_am[i].g_previsto, (unsigned)s_am[i].previsto, s_am[i].sigma_g);
+        }
+    }
+
+    printf("Build: %s | mediana %d + filtro \"%s\" (%d estagios) | degrau %ld mg\n",
+           SCALE_FIXED_POINT ? "ponto fixo" : "float", mediana, filtro_txt, n_cfg, (long)degrau_mg);
+    printf("Patamares: %lu, degraus: %lu (limiar %.2f g)\n", (unsigned long)n_pat, (unsigned long)n_eventos, evento_g);
+    if (n_eventos > nao_assentou) {
+        printf("Assentamento ate 'estavel': medio %.0f ms, max %.0f ms (%lu sem assentar)\n",
+               soma_assent / (double)(n_eventos - nao_assentou), max_assent, (unsigned long)nao_assentou);
+    }
+    if (n_previstos > 0) {
+        printf("Assentamento ate 'previsto': medio %.0f ms, max %.0f ms (%lu de %lu degraus)\n",
+               soma_prev / (double)n_previstos, max_prev, (unsigned long)n_previstos, (unsigned long)n_eventos);
+        printf("Erro da previsao: medio %.1f mg, %lu fora da incerteza (tol %.3f g)\n",
+               1000.0 * soma_erro_prev / (double)n_previstos, (unsigned long)n_prev_fora, tol_g);
+    }
+    if (n_var > 0) {
+        printf("Ruido (sigma): bruto %.2f mg, filtrado %.2f mg\n",
+               1000.0 * sqrt(soma_var_b / (double)n_var), 1000.0 * sqrt(soma_var_f / (double)n_var));
+    }
+    printf("Falso-estavel: %llu de %llu amostras estaveis (%.2f%%, tol %.3f g)\n",
+           (unsigned long long)n_falsos, (unsigned long long)n_estaveis,
+           n_estaveis ? 100.0 * (double)n_falsos / (double)n_estaveis : 0.0, tol_g);
+    printf("CPU (PC): %.1f ns/amostra\n", melhor_ns / (double)s_num);
+
+    if (s_tem_fases) {
+        Rodar_Pipeline((uint8_t)mediana, cfg, n_cfg, degrau_mg, 0);
+        Relatorio_Ciclo("reinicia em toda fase", tol_g);
+        Rodar_Pipeline((uint8_t)mediana, cfg, n_cfg, degrau_mg, 1);
+        Relatorio_Ciclo("mantem NIVELANDO->MEDINDO", tol_g);
+        Relatorio_Dosagem();
+    }
+    return 0;
+}